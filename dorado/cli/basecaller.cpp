@@ -1,5 +1,7 @@
 #include "Version.h"
 #include "data_loader/DataLoader.h"
+#include "data_loader/DatasetCatalog.h"
+#include "data_loader/DirectoryWatcher.h"
 #include "decode/CPUDecoder.h"
 #include "nn/CRFModel.h"
 #include "utils/basecaller_utils.h"
@@ -19,11 +21,15 @@
 #include "read_pipeline/HtsReader.h"
 #include "read_pipeline/HtsWriter.h"
 #include "read_pipeline/ModBaseCallerNode.h"
+#include "read_pipeline/Pipeline.h"
 #include "read_pipeline/ProgressTracker.h"
 #include "read_pipeline/ReadFilterNode.h"
+#include "read_pipeline/ReadRouterNode.h"
 #include "read_pipeline/ReadToBamTypeNode.h"
+#include "read_pipeline/ReorderNode.h"
 #include "read_pipeline/ResumeLoaderNode.h"
 #include "read_pipeline/ScalerNode.h"
+#include "utils/MemoryBudget.h"
 #include "utils/bam_utils.h"
 #include "utils/cli_utils.h"
 #include "utils/log_utils.h"
@@ -39,14 +45,99 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <thread>
+#include <tuple>
 
 namespace dorado {
 
 using dorado::utils::default_parameters;
 using namespace std::chrono_literals;
 
+// Creates num_runners runners for the model per chunk size, on each device.  Of each GPU's
+// memory, the model's callers use memory_limit_fraction when choosing a batch size.  On CPU
+// there's a runner per hardware thread, split between the chunk sizes, and each decodes up
+// to num_cpu_decode_threads chunks at once.
+std::vector<Runner> create_basecall_runners(const std::filesystem::path& model_path,
+                                            const CRFModelConfig& model_config,
+                                            const std::string& device,
+                                            const std::vector<size_t>& chunk_sizes,
+                                            size_t batch_size,
+                                            size_t num_runners,
+                                            size_t num_cpu_decode_threads,
+                                            float memory_limit_fraction,
+                                            int& num_devices) {
+    std::vector<Runner> runners;
+    if (device == "cpu") {
+        num_runners = std::max(size_t(std::thread::hardware_concurrency()), chunk_sizes.size());
+        if (batch_size == 0) {
+            batch_size = 128;
+        }
+        spdlog::debug(
+                "- CPU calling: set batch size to {}, num_runners to {}, decode threads to {}",
+                batch_size, num_runners, num_cpu_decode_threads);
+
+        DecoderOptions decoder_options;
+        decoder_options.num_threads = num_cpu_decode_threads;
+        for (size_t chunk_size_index = 0; chunk_size_index < chunk_sizes.size();
+             ++chunk_size_index) {
+            const auto runner_chunk_size = chunk_sizes[chunk_size_index];
+            // Earlier chunk sizes take any remainder.
+            const size_t num_chunk_size_runners =
+                    num_runners / chunk_sizes.size() +
+                    (chunk_size_index < num_runners % chunk_sizes.size() ? 1 : 0);
+            for (size_t i = 0; i < num_chunk_size_runners; i++) {
+                runners.push_back(std::make_shared<ModelRunner<CPUDecoder>>(
+                        model_path, device, runner_chunk_size, batch_size, decoder_options));
+            }
+        }
+    }
+#if DORADO_GPU_BUILD
+#ifdef __APPLE__
+    else if (device == "metal") {
+        for (auto runner_chunk_size : chunk_sizes) {
+            auto caller =
+                    create_metal_caller(model_config, model_path, runner_chunk_size, batch_size);
+            for (size_t i = 0; i < num_runners; i++) {
+                runners.push_back(std::make_shared<MetalModelRunner>(caller));
+            }
+            if (runners.back()->batch_size() != batch_size) {
+                spdlog::debug("- set batch size to {}", runners.back()->batch_size());
+            }
+        }
+    } else {
+        throw std::runtime_error(std::string("Unsupported device: ") + device);
+    }
+#else   // ifdef __APPLE__
+    else {
+        auto devices = utils::parse_cuda_device_string(device);
+        num_devices = devices.size();
+        if (num_devices == 0) {
+            throw std::runtime_error("CUDA device requested but no devices found.");
+        }
+        // Callers for each chunk size share the model's memory when choosing a batch size.
+        memory_limit_fraction /= chunk_sizes.size();
+        for (auto device_string : devices) {
+            for (auto runner_chunk_size : chunk_sizes) {
+                auto caller = create_cuda_caller(model_config, model_path, runner_chunk_size,
+                                                 batch_size, device_string, memory_limit_fraction);
+                for (size_t i = 0; i < num_runners; i++) {
+                    runners.push_back(std::make_shared<CudaModelRunner>(caller));
+                }
+                if (runners.back()->batch_size() != batch_size) {
+                    spdlog::debug("- set batch size for {} to {}", device_string,
+                                  runners.back()->batch_size());
+                }
+            }
+        }
+    }
+#endif  // __APPLE__
+#endif  // DORADO_GPU_BUILD
+
+    return runners;
+}
+
 void setup(std::vector<std::string> args,
            const std::filesystem::path& model_path,
            const std::string& data_path,
@@ -54,9 +145,11 @@ void setup(std::vector<std::string> args,
            const std::string& device,
            const std::string& ref,
            size_t chunk_size,
+           size_t short_chunk_size,
            size_t overlap,
            size_t batch_size,
            size_t num_runners,
+           size_t num_cpu_decode_threads,
            size_t remora_batch_size,
            size_t num_remora_threads,
            float methylation_threshold_pct,
@@ -72,71 +165,38 @@ void setup(std::vector<std::string> args,
            bool skip_model_compatibility_check,
            const std::string& dump_stats_file,
            const std::string& dump_stats_filter,
-           const std::string& resume_from_file) {
+           const std::string& resume_from_file,
+           size_t reorder_window,
+           const std::optional<DirectoryWatcher::Options>& watch_options,
+           const InputShard& shard,
+           const std::filesystem::path& recall_model_path,
+           float recall_min_qscore,
+           float recall_max_qscore) {
     torch::set_num_threads(1);
-    std::vector<Runner> runners;
 
     auto model_config = load_crf_model_config(model_path);
+    const int num_models = recall_model_path.empty() ? 1 : 2;
 
     // Default is 1 device.  CUDA path may alter this.
     int num_devices = 1;
 
-    if (device == "cpu") {
-        num_runners = std::thread::hardware_concurrency();
-        if (batch_size == 0) {
-            batch_size = 128;
-        }
-        spdlog::debug("- CPU calling: set batch size to {}, num_runners to {}", batch_size,
-                      num_runners);
-
-        for (size_t i = 0; i < num_runners; i++) {
-            runners.push_back(std::make_shared<ModelRunner<CPUDecoder>>(model_path, device,
-                                                                        chunk_size, batch_size));
-        }
-    }
-#if DORADO_GPU_BUILD
-#ifdef __APPLE__
-    else if (device == "metal") {
-        auto caller = create_metal_caller(model_config, model_path, chunk_size, batch_size);
-        for (size_t i = 0; i < num_runners; i++) {
-            runners.push_back(std::make_shared<MetalModelRunner>(caller));
-        }
-        if (runners.back()->batch_size() != batch_size) {
-            spdlog::debug("- set batch size to {}", runners.back()->batch_size());
-        }
-    } else {
-        throw std::runtime_error(std::string("Unsupported device: ") + device);
-    }
-#else   // ifdef __APPLE__
-    else {
-        auto devices = utils::parse_cuda_device_string(device);
-        num_devices = devices.size();
-        if (num_devices == 0) {
-            throw std::runtime_error("CUDA device requested but no devices found.");
-        }
-        for (auto device_string : devices) {
-            auto caller = create_cuda_caller(model_config, model_path, chunk_size, batch_size,
-                                             device_string);
-            for (size_t i = 0; i < num_runners; i++) {
-                runners.push_back(std::make_shared<CudaModelRunner>(caller));
-            }
-            if (runners.back()->batch_size() != batch_size) {
-                spdlog::debug("- set batch size for {} to {}", device_string,
-                              runners.back()->batch_size());
-            }
-        }
+    // Reads are called in chunks of whichever size computes the fewest samples for them, so
+    // short reads aren't padded out to full size chunks.
+    std::vector<size_t> chunk_sizes{chunk_size};
+    if (short_chunk_size != 0) {
+        chunk_sizes.push_back(short_chunk_size);
     }
-#endif  // __APPLE__
-#endif  // DORADO_GPU_BUILD
 
-    // verify that all runners are using the same stride, in case we allow multiple models in future
+    auto runners = create_basecall_runners(model_path, model_config, device, chunk_sizes,
+                                           batch_size, num_runners, num_cpu_decode_threads,
+                                           1.f / num_models, num_devices);
+
+    // verify that all of the model's runners are using the same stride
     auto model_stride = runners.front()->model_stride();
-    auto adjusted_chunk_size = runners.front()->chunk_size();
-    assert(std::all_of(runners.begin(), runners.end(), [&](auto runner) {
-        return runner->model_stride() == model_stride &&
-               runner->chunk_size() == adjusted_chunk_size;
-    }));
+    assert(std::all_of(runners.begin(), runners.end(),
+                       [&](auto runner) { return runner->model_stride() == model_stride; }));
 
+    auto adjusted_chunk_size = runners.front()->chunk_size();
     if (chunk_size != adjusted_chunk_size) {
         spdlog::debug("- adjusted chunk size to match model stride: {} -> {}", chunk_size,
                       adjusted_chunk_size);
@@ -164,6 +224,35 @@ void setup(std::vector<std::string> args,
         remora_model_list.push_back(model);
     }
 
+    // Reads the first model calls with a mean qscore in the recall band are called again with
+    // the recall model, e.g. so that sup is only run on the reads where it makes a difference.
+    std::vector<Runner> recall_runners;
+    size_t recall_overlap = 0;
+    if (!recall_model_path.empty()) {
+        const auto recall_model_config = load_crf_model_config(recall_model_path);
+        // Reads are scaled once, before either model calls them.
+        const auto& norm = model_config.signal_norm_params;
+        const auto& recall_norm = recall_model_config.signal_norm_params;
+        if (norm.quantile_a != recall_norm.quantile_a ||
+            norm.quantile_b != recall_norm.quantile_b ||
+            norm.shift_multiplier != recall_norm.shift_multiplier ||
+            norm.scale_multiplier != recall_norm.scale_multiplier) {
+            throw std::runtime_error(
+                    "The recall model must use the same signal normalisation as the model.");
+        }
+        int recall_num_devices = 1;
+        recall_runners = create_basecall_runners(
+                recall_model_path, recall_model_config, device, chunk_sizes, batch_size,
+                num_runners, num_cpu_decode_threads, 1.f / num_models, recall_num_devices);
+        const auto recall_model_stride = recall_runners.front()->model_stride();
+        if (!remora_model_list.empty() && recall_model_stride != model_stride) {
+            throw std::runtime_error(
+                    "Modified base models need the recall model to have the same stride as the "
+                    "model.");
+        }
+        recall_overlap = (overlap / recall_model_stride) * recall_model_stride;
+    }
+
     // generate model callers before nodes or it affects the speed calculations
     std::vector<std::unique_ptr<ModBaseRunner>> remora_runners;
     std::vector<std::string> modbase_devices;
@@ -182,25 +271,52 @@ void setup(std::vector<std::string> args,
         }
     };
 
+    std::unique_ptr<DirectoryWatcher> watcher;
+    if (watch_options) {
+        // Read groups and the sample rate come from the files there are when basecalling
+        // starts, so wait for at least one.
+        watcher = std::make_unique<DirectoryWatcher>(data_path, *watch_options);
+        spdlog::info("> Waiting for POD5 files in {}", data_path);
+        if (!watcher->wait_for_files()) {
+            throw std::runtime_error("No complete POD5 files appeared in " + data_path);
+        }
+    }
+
     std::string model_name = std::filesystem::canonical(model_path).filename().string();
     auto read_groups = DataLoader::load_read_groups(data_path, model_name, recursive_file_loading);
+    std::string recall_model_name;
+    if (!recall_model_path.empty()) {
+        // Recalled reads are in read groups of their own, for the recall model.
+        recall_model_name = std::filesystem::canonical(recall_model_path).filename().string();
+        read_groups.merge(DataLoader::load_read_groups(data_path, recall_model_name,
+                                                       recursive_file_loading));
+    }
 
     auto read_list = utils::load_read_list(read_list_file_path);
 
     // Check sample rate of model vs data.
     auto data_sample_rate = DataLoader::get_sample_rate(data_path, recursive_file_loading);
-    auto model_sample_rate = get_model_sample_rate(model_path);
-    if (!skip_model_compatibility_check &&
-        !sample_rates_compatible(data_sample_rate, model_sample_rate)) {
-        std::stringstream err;
-        err << "Sample rate for model (" << model_sample_rate << ") and data (" << data_sample_rate
-            << ") are not compatible.";
-        throw std::runtime_error(err.str());
+    for (const auto& path : {model_path, recall_model_path}) {
+        if (path.empty()) {
+            continue;
+        }
+        auto model_sample_rate = get_model_sample_rate(path);
+        if (!skip_model_compatibility_check &&
+            !sample_rates_compatible(data_sample_rate, model_sample_rate)) {
+            std::stringstream err;
+            err << "Sample rate for model (" << model_sample_rate << ") and data ("
+                << data_sample_rate << ") are not compatible.";
+            throw std::runtime_error(err.str());
+        }
     }
 
-    size_t num_reads = DataLoader::get_num_reads(
-            data_path, read_list, {} /*reads_already_processed*/, recursive_file_loading);
-    num_reads = max_reads == 0 ? num_reads : std::min(num_reads, max_reads);
+    // When watching, the number of reads isn't known up front.
+    size_t num_reads = 0;
+    if (!watcher) {
+        num_reads = DataLoader::get_num_reads(data_path, read_list, {} /*reads_already_processed*/,
+                                              recursive_file_loading, shard);
+        num_reads = max_reads == 0 ? num_reads : std::min(num_reads, max_reads);
+    }
 
     bool rna = utils::is_rna_model(model_path), duplex = false;
 
@@ -210,24 +326,19 @@ void setup(std::vector<std::string> args,
     std::unique_ptr<sam_hdr_t, void (*)(sam_hdr_t*)> hdr(sam_hdr_init(), sam_hdr_destroy);
     utils::add_pg_hdr(hdr.get(), args);
     utils::add_rg_hdr(hdr.get(), read_groups);
-    std::shared_ptr<HtsWriter> bam_writer;
-    std::shared_ptr<Aligner> aligner;
-    MessageSink* converted_reads_sink = nullptr;
-    if (ref.empty()) {
-        bam_writer = std::make_shared<HtsWriter>("-", output_mode,
-                                                 thread_allocations.writer_threads, num_reads);
-        bam_writer->write_header(hdr.get());
-        converted_reads_sink = bam_writer.get();
-    } else {
-        bam_writer = std::make_shared<HtsWriter>("-", output_mode,
-                                                 thread_allocations.writer_threads, num_reads);
-        aligner =
-                std::make_shared<Aligner>(*bam_writer, ref, kmer_size, window_size,
-                                          mm2_index_batch_size, thread_allocations.aligner_threads);
+    Pipeline pipeline;
+    auto& bam_writer = pipeline.add_node<HtsWriter>("-", output_mode,
+                                                    thread_allocations.writer_threads, num_reads);
+    Aligner* aligner = nullptr;
+    MessageSink* converted_reads_sink = &bam_writer;
+    if (!ref.empty()) {
+        aligner = &pipeline.add_node<Aligner>(bam_writer, ref, kmer_size, window_size,
+                                              mm2_index_batch_size,
+                                              thread_allocations.aligner_threads);
         utils::add_sq_hdr(hdr.get(), aligner->get_sequence_records_for_header());
-        bam_writer->write_header(hdr.get());
-        converted_reads_sink = aligner.get();
+        converted_reads_sink = aligner;
     }
+    bam_writer.write_header(hdr.get());
 
     std::unordered_set<std::string> reads_already_processed;
     if (!resume_from_file.empty()) {
@@ -245,50 +356,81 @@ void setup(std::vector<std::string> args,
                     "Resume only works if the same model is used. Resume model was " +
                     resume_model_name + " and current model is " + model_name);
         }
-        ResumeLoaderNode resume_loader(*bam_writer, resume_from_file);
+        ResumeLoaderNode resume_loader(bam_writer, resume_from_file);
         resume_loader.copy_completed_reads();
         reads_already_processed = resume_loader.get_processed_read_ids();
     }
 
-    ReadToBamType read_converter(*converted_reads_sink, emit_moves, rna,
-                                 thread_allocations.read_converter_threads,
-                                 methylation_threshold_pct);
-    ReadFilterNode read_filter_node(read_converter, min_qscore,
-                                    default_parameters.min_seqeuence_length, {},
-                                    thread_allocations.read_filter_threads);
+    auto& read_converter = pipeline.add_node<ReadToBamType>(
+            *converted_reads_sink, emit_moves, rna, thread_allocations.read_converter_threads,
+            methylation_threshold_pct);
+    // Everything downstream of the reorder node keeps reads in the order it receives them,
+    // provided the filter runs on one thread.
+    auto& read_filter_node = pipeline.add_node<ReadFilterNode>(
+            read_converter, min_qscore, default_parameters.min_seqeuence_length,
+            std::unordered_set<std::string>{},
+            reorder_window > 0 ? 1 : thread_allocations.read_filter_threads);
+    MessageSink* called_reads_sink = &read_filter_node;
+    ReorderNode* reorder_node = nullptr;
+    if (reorder_window > 0) {
+        reorder_node = &pipeline.add_node<ReorderNode>(read_filter_node, reorder_window);
+        called_reads_sink = reorder_node;
+    }
 
-    std::unique_ptr<ModBaseCallerNode> mod_base_caller_node;
-    MessageSink* basecaller_node_sink = static_cast<MessageSink*>(&read_filter_node);
+    ModBaseCallerNode* mod_base_caller_node = nullptr;
+    MessageSink* basecaller_node_sink = called_reads_sink;
     if (!remora_model_list.empty()) {
-        mod_base_caller_node = std::make_unique<ModBaseCallerNode>(
-                read_filter_node, std::move(remora_runners),
+        mod_base_caller_node = &pipeline.add_node<ModBaseCallerNode>(
+                *called_reads_sink, std::move(remora_runners),
                 thread_allocations.remora_threads * num_devices, model_stride, remora_batch_size);
-        basecaller_node_sink = static_cast<MessageSink*>(mod_base_caller_node.get());
+        basecaller_node_sink = mod_base_caller_node;
     }
     const int kBatchTimeoutMS = 100;
-    BasecallerNode basecaller_node(*basecaller_node_sink, std::move(runners), overlap,
-                                   kBatchTimeoutMS, model_name, 1000);
-    ScalerNode scaler_node(basecaller_node, model_config.signal_norm_params,
-                           thread_allocations.scaler_node_threads);
+    BasecallerNode* recall_basecaller_node = nullptr;
+    ReadRouterNode* recall_router_node = nullptr;
+    if (!recall_runners.empty()) {
+        recall_basecaller_node = &pipeline.add_node<BasecallerNode>(
+                *basecaller_node_sink, std::move(recall_runners), recall_overlap, kBatchTimeoutMS,
+                recall_model_name, 1000, "RecallBasecallerNode");
+        recall_router_node = &pipeline.add_node<ReadRouterNode>(
+                *basecaller_node_sink, *recall_basecaller_node,
+                ReadRouterNode::qscore_band(recall_min_qscore, recall_max_qscore));
+        basecaller_node_sink = recall_router_node;
+    }
+    auto& basecaller_node =
+            pipeline.add_node<BasecallerNode>(*basecaller_node_sink, std::move(runners), overlap,
+                                              kBatchTimeoutMS, model_name, 1000);
+    auto& scaler_node = pipeline.add_node<ScalerNode>(
+            basecaller_node, model_config.signal_norm_params,
+            thread_allocations.scaler_node_threads);
 
     DataLoader loader(scaler_node, "cpu", thread_allocations.loader_threads, max_reads, read_list,
                       reads_already_processed);
+    loader.set_shard(shard);
 
     // Setup stats counting
     std::unique_ptr<dorado::stats::StatsSampler> stats_sampler;
     std::vector<dorado::stats::StatsReporter> stats_reporters;
     using dorado::stats::make_stats_reporter;
     stats_reporters.push_back(make_stats_reporter(basecaller_node));
+    if (recall_basecaller_node) {
+        stats_reporters.push_back(make_stats_reporter(*recall_basecaller_node));
+        stats_reporters.push_back(make_stats_reporter(*recall_router_node));
+    }
     if (mod_base_caller_node) {
         stats_reporters.push_back(make_stats_reporter(*mod_base_caller_node));
     }
     if (aligner) {
         stats_reporters.push_back(make_stats_reporter(*aligner));
     }
-    stats_reporters.push_back(make_stats_reporter(*bam_writer));
+    stats_reporters.push_back(make_stats_reporter(bam_writer));
     stats_reporters.push_back(make_stats_reporter(loader));
     stats_reporters.push_back(make_stats_reporter(scaler_node));
     stats_reporters.push_back(make_stats_reporter(read_filter_node));
+    if (reorder_node) {
+        stats_reporters.push_back(make_stats_reporter(*reorder_node));
+    }
+    stats_reporters.push_back(make_stats_reporter(utils::MemoryBudget::global()));
 
     std::vector<dorado::stats::StatsCallable> stats_callables;
     ProgressTracker tracker(num_reads, duplex);
@@ -301,9 +443,13 @@ void setup(std::vector<std::string> args,
     // End stats counting setup.
 
     // Run pipeline.
-    loader.load_reads(data_path, recursive_file_loading);
+    if (watcher) {
+        loader.load_reads(*watcher);
+    } else {
+        loader.load_reads(data_path, recursive_file_loading);
+    }
 
-    bam_writer->join();
+    bam_writer.join();
     // End pipeline
 
     stats_sampler->terminate();
@@ -357,6 +503,29 @@ int basecaller(int argc, char* argv[]) {
             .default_value(default_parameters.chunksize)
             .scan<'i', int>();
 
+    parser.add_argument("--short-chunksize")
+            .default_value(0)
+            .scan<'i', int>()
+            .help("also call with chunks of this many samples, e.g. 3000 for short read "
+                  "libraries, using them for reads which fit them better than full size chunks. "
+                  "0 to only use --chunksize.");
+
+    parser.add_argument("--cpu-decode-threads")
+            .default_value(default_parameters.cpu_decode_threads)
+            .scan<'i', int>()
+            .help("with -x cpu, how many chunks of a batch each runner decodes at once. Decoding "
+                  "shares one pool of threads between all runners.");
+
+    parser.add_argument("--recall-model")
+            .help("a second basecaller model, e.g. sup, to call again the reads which the model "
+                  "calls with a mean qscore from --recall-min-qscore up to --recall-max-qscore. "
+                  "Recalled reads are in read groups for the recall model.")
+            .default_value(std::string(""));
+
+    parser.add_argument("--recall-min-qscore").default_value(0.f).scan<'f', float>();
+
+    parser.add_argument("--recall-max-qscore").default_value(10.f).scan<'f', float>();
+
     parser.add_argument("-o", "--overlap")
             .default_value(default_parameters.overlap)
             .scan<'i', int>();
@@ -366,6 +535,33 @@ int basecaller(int argc, char* argv[]) {
             .implicit_value(true)
             .help("Recursively scan through directories to load FAST5 and POD5 files");
 
+    parser.add_argument("--dataset-index")
+            .default_value(false)
+            .implicit_value(true)
+            .help("Save an index of POD5 metadata in the input directory, and reuse it on later "
+                  "runs to speed up startup");
+
+    parser.add_argument("--shard")
+            .help("Basecall shard i of N, given as i/N with i from 0 to N-1, so that a dataset can "
+                  "be split between several hosts. Each read is in exactly one shard.")
+            .default_value(std::string(""));
+
+    parser.add_argument("--watch")
+            .default_value(false)
+            .implicit_value(true)
+            .help("Keep watching the data directory, and basecall POD5 files as they are "
+                  "completed, e.g. during a run");
+
+    parser.add_argument("--watch-idle-timeout")
+            .help("with --watch, stop after waiting this many seconds without any files "
+                  "changing. 0 to watch until the stop file appears.")
+            .default_value(600)
+            .scan<'i', int>();
+
+    parser.add_argument("--watch-stop-file")
+            .help("with --watch, stop once a file of this name appears in the data directory.")
+            .default_value(std::string(""));
+
     parser.add_argument("--modified-bases")
             .nargs(argparse::nargs_pattern::at_least_one)
             .action([](const std::string& value) {
@@ -416,6 +612,22 @@ int basecaller(int argc, char* argv[]) {
             .scan<'i', int>();
     parser.add_argument("-I").help("minimap2 index batch size.").default_value(std::string("16G"));
 
+    parser.add_argument("--preserve-order")
+            .help("emit reads in the order they were loaded from the input files.")
+            .default_value(false)
+            .implicit_value(true);
+
+    parser.add_argument("--reorder-window")
+            .help("with --preserve-order, how many reads may be held waiting for earlier "
+                  "reads to finish. Reads later than this are emitted out of order.")
+            .default_value(1000)
+            .scan<'i', int>();
+
+    parser.add_argument("--max-inflight-memory")
+            .help("limit on the signal and call data held by reads in flight, e.g. 32G. Loading "
+                  "pauses while it is exceeded. 0 for no limit.")
+            .default_value(std::string("0"));
+
     argparse::ArgumentParser internal_parser;
 
     try {
@@ -458,6 +670,43 @@ int basecaller(int argc, char* argv[]) {
         std::exit(EXIT_FAILURE);
     }
 
+    if (parser.get<int>("--reorder-window") < 1) {
+        spdlog::error("--reorder-window must be at least 1.");
+        std::exit(EXIT_FAILURE);
+    }
+
+    if (parser.get<int>("--cpu-decode-threads") < 1) {
+        spdlog::error("--cpu-decode-threads must be at least 1.");
+        std::exit(EXIT_FAILURE);
+    }
+
+    InputShard shard;
+    if (!parser.get<std::string>("--shard").empty()) {
+        try {
+            std::tie(shard.index, shard.count) =
+                    utils::parse_shard(parser.get<std::string>("--shard"));
+        } catch (const std::exception& e) {
+            spdlog::error("{}", e.what());
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    std::optional<DirectoryWatcher::Options> watch_options;
+    if (parser.get<bool>("--watch")) {
+        if (shard.is_sharded()) {
+            spdlog::error("--shard can't be used with --watch.");
+            std::exit(EXIT_FAILURE);
+        }
+        if (parser.get<int>("--watch-idle-timeout") < 0) {
+            spdlog::error("--watch-idle-timeout must not be negative.");
+            std::exit(EXIT_FAILURE);
+        }
+        watch_options.emplace();
+        watch_options->recursive = parser.get<bool>("--recursive");
+        watch_options->idle_timeout = std::chrono::seconds(parser.get<int>("--watch-idle-timeout"));
+        watch_options->stop_file = parser.get<std::string>("--watch-stop-file");
+    }
+
     auto output_mode = HtsWriter::OutputMode::BAM;
 
     auto emit_fastq = parser.get<bool>("--emit-fastq");
@@ -478,19 +727,27 @@ int basecaller(int argc, char* argv[]) {
     spdlog::info("> Creating basecall pipeline");
 
     try {
+        utils::MemoryBudget::global().set_limit(
+                utils::parse_string_to_size(parser.get<std::string>("--max-inflight-memory")));
+        DatasetCatalog::set_use_index(parser.get<bool>("--dataset-index"));
         setup(args, model, parser.get<std::string>("data"), mod_bases_models,
               parser.get<std::string>("-x"), parser.get<std::string>("--reference"),
-              parser.get<int>("-c"), parser.get<int>("-o"), parser.get<int>("-b"),
-              default_parameters.num_runners, default_parameters.remora_batchsize,
-              default_parameters.remora_threads, methylation_threshold, output_mode,
-              parser.get<bool>("--emit-moves"), parser.get<int>("--max-reads"),
-              parser.get<int>("--min-qscore"), parser.get<std::string>("--read-ids"),
-              parser.get<bool>("--recursive"), parser.get<int>("k"), parser.get<int>("w"),
+              parser.get<int>("-c"), parser.get<int>("--short-chunksize"), parser.get<int>("-o"),
+              parser.get<int>("-b"), default_parameters.num_runners,
+              parser.get<int>("--cpu-decode-threads"), default_parameters.remora_batchsize,
+              default_parameters.remora_threads,
+              methylation_threshold, output_mode, parser.get<bool>("--emit-moves"),
+              parser.get<int>("--max-reads"), parser.get<int>("--min-qscore"),
+              parser.get<std::string>("--read-ids"), parser.get<bool>("--recursive"),
+              parser.get<int>("k"), parser.get<int>("w"),
               utils::parse_string_to_size(parser.get<std::string>("I")),
               internal_parser.get<bool>("--skip-model-compatibility-check"),
               internal_parser.get<std::string>("--dump_stats_file"),
               internal_parser.get<std::string>("--dump_stats_filter"),
-              parser.get<std::string>("--resume-from"));
+              parser.get<std::string>("--resume-from"),
+              parser.get<bool>("--preserve-order") ? parser.get<int>("--reorder-window") : 0,
+              watch_options, shard, parser.get<std::string>("--recall-model"),
+              parser.get<float>("--recall-min-qscore"), parser.get<float>("--recall-max-qscore"));
     } catch (const std::exception& e) {
         spdlog::error("{}", e.what());
         return 1;
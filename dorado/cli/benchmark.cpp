@@ -1,25 +1,30 @@
 #include "../utils/tensor_utils.h"
 #include "Version.h"
+#include "decode/crf_scan.h"
+#include "read_pipeline/ReadPipeline.h"
+#include "utils/AsyncQueue.h"
+#include "utils/quantile_utils.h"
+#include "utils/RingBufferQueue.h"
+#include "utils/trim.h"
 
 #include <argparse.hpp>
 #include <torch/torch.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace dorado {
 
-int benchmark(int argc, char* argv[]) {
-    argparse::ArgumentParser parser("dorado", DORADO_VERSION, argparse::default_arguments::help);
-
-    try {
-        parser.parse_args(argc, argv);
-    } catch (const std::exception& e) {
-        std::cerr << e.what() << std::endl;
-        std::cerr << parser;
-        std::exit(1);
-    }
+namespace {
 
+void benchmark_quantiles() {
     std::vector<size_t> sizes{1000, 1000, 2000, 3000, 4000, 10000, 100000, 1000000, 10000000};
 
     for (auto n : sizes) {
@@ -61,9 +66,272 @@ int benchmark(int argc, char* argv[]) {
 
         std::cerr << "counting     "
                   << " q20=" << res[0].item<int>() << " q90=" << res[1].item<int>() << " "
-                  << duration << "us" << std::endl
+                  << duration << "us" << std::endl;
+
+        // float16 histogram, as for normalised signal
+        const auto x_f16 = (x.to(torch::kFloat) / 256).to(torch::kFloat16);
+        const float quantiles[] = {0.2f, 0.9f};
+        float q_f16[2];
+        start = std::chrono::system_clock::now();
+        utils::quantiles(x_f16.data_ptr<c10::Half>(), n, quantiles, 2, q_f16);
+        end = std::chrono::system_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+        std::cerr << "f16 counting "
+                  << " q20=" << q_f16[0] * 256 << " q90=" << q_f16[1] * 256 << " " << duration
+                  << "us" << std::endl
+                  << std::endl;
+    }
+}
+
+// Normalises and trims reads the way ScalerNode used to, with torch ops, and with the fused
+// raw pointer kernels it uses now.
+void benchmark_normalisation() {
+    using torch::indexing::Slice;
+    const float kQuantileA = 0.2f, kQuantileB = 0.9f;
+    const int kRepeats = 10;
+
+    for (int64_t n : {4000, 20000, 100000, 1000000}) {
+        std::cerr << "samples : " << n << std::endl;
+        const auto raw_data = torch::randint(0, 2047, n, torch::kInt16);
+        const int max_samples = std::min(8000, static_cast<int>(n / 2));
+
+        auto start = std::chrono::system_clock::now();
+        int64_t checksum = 0;
+        for (int i = 0; i < kRepeats; ++i) {
+            auto q = utils::quantile_counting(raw_data, torch::tensor({kQuantileA, kQuantileB}));
+            const float shift = q[0].item<float>() + q[1].item<float>();
+            const float scale = std::max(1.0f, q[1].item<float>() - q[0].item<float>());
+            auto scaled = ((raw_data.to(torch::kFloat) - shift) / scale).to(torch::kFloat16);
+            checksum += utils::trim(scaled.index({Slice(torch::indexing::None, max_samples)}));
+        }
+        auto end = std::chrono::system_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        std::cerr << "torch ops    " << duration / kRepeats << "us/read" << std::endl;
+
+        start = std::chrono::system_clock::now();
+        for (int i = 0; i < kRepeats; ++i) {
+            const float quantiles[] = {kQuantileA, kQuantileB};
+            float q[2];
+            utils::quantiles(raw_data.data_ptr<int16_t>(), n, quantiles, 2, q);
+            const float shift = q[0] + q[1];
+            const float scale = std::max(1.0f, q[1] - q[0]);
+            auto scaled = torch::empty({n}, torch::kFloat16);
+            utils::normalise_i16_to_f16(scaled.data_ptr<c10::Half>(),
+                                        raw_data.data_ptr<int16_t>(), n, shift, scale);
+            checksum -= utils::trim(scaled.data_ptr<c10::Half>(), max_samples);
+        }
+        end = std::chrono::system_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        // The checksum is zero if both paths trimmed the same samples.
+        std::cerr << "fused        " << duration / kRepeats << "us/read"
+                  << " checksum=" << checksum << std::endl
                   << std::endl;
     }
+}
+
+// Stages chunks of a read into a batch input tensor the way BasecallerNode used to, slicing
+// and padding with torch ops before index_put_, and with copy_signal_rows, which runners'
+// stage_chunk uses.  Inputs are float16, as on GPUs, or float32, as for the CPU runner.
+void benchmark_staging() {
+    using torch::indexing::Ellipsis;
+    using torch::indexing::Slice;
+    const int64_t kChunkSize = 10000;
+    const int64_t kOverlap = 500;
+    const int64_t kBatchSize = 128;
+    const int64_t kReadLen = 200000;
+    const int kRepeats = 5;
+
+    for (int64_t num_rows : {1, 13}) {
+        // Stereo encodings have a row per feature.
+        std::cerr << "rows : " << num_rows << std::endl;
+        const auto raw_data = torch::rand({num_rows, kReadLen}).to(torch::kFloat16);
+        // Full chunks, then a short one at the end of the read to be padded.
+        std::vector<int64_t> offsets;
+        for (int64_t offset = 0; offset < kReadLen; offset += kChunkSize - kOverlap) {
+            offsets.push_back(offset);
+        }
+
+        for (auto dtype : {torch::kFloat16, torch::kFloat32}) {
+            auto input = torch::zeros({kBatchSize, num_rows, kChunkSize}, dtype);
+            const std::string dtype_name = dtype == torch::kFloat16 ? "f16" : "f32";
+
+            auto start = std::chrono::system_clock::now();
+            size_t num_chunks = 0;
+            for (int i = 0; i < kRepeats; ++i) {
+                for (auto offset : offsets) {
+                    auto slice = raw_data.index({Ellipsis, Slice(offset, offset + kChunkSize)});
+                    const int64_t slice_size = slice.size(-1);
+                    if (slice_size != kChunkSize) {
+                        auto [n, overhang] = std::div(kChunkSize, slice_size);
+                        slice = torch::concat(
+                                {slice.repeat({1, n}), slice.index({Ellipsis, Slice(0, overhang)})},
+                                1);
+                    }
+                    input.index_put_({static_cast<int64_t>(num_chunks % kBatchSize), Ellipsis},
+                                     slice);
+                    ++num_chunks;
+                }
+            }
+            auto end = std::chrono::system_clock::now();
+            auto duration = std::chrono::duration<double>(end - start).count();
+            std::cerr << "torch ops " << dtype_name << "   " << num_chunks / duration
+                      << " chunks/s" << std::endl;
+
+            start = std::chrono::system_clock::now();
+            num_chunks = 0;
+            for (int i = 0; i < kRepeats; ++i) {
+                for (auto offset : offsets) {
+                    const auto len = std::min(kChunkSize, kReadLen - offset);
+                    utils::copy_signal_rows(input, (num_chunks % kBatchSize) * input.stride(0),
+                                            kChunkSize, raw_data.data_ptr<c10::Half>() + offset,
+                                            num_rows, kReadLen, len, true);
+                    ++num_chunks;
+                }
+            }
+            end = std::chrono::system_clock::now();
+            duration = std::chrono::duration<double>(end - start).count();
+            std::cerr << "staged " << dtype_name << "      " << num_chunks / duration
+                      << " chunks/s" << std::endl;
+        }
+        std::cerr << std::endl;
+    }
+}
+
+// Scans a batch of chunks' CRF scores forward the way CPUDecoder used to, with torch ops per
+// timestep, and with crf_forward_scan.  Fast models have 64 states, and HAC models 256.
+void benchmark_decode() {
+    using torch::indexing::Slice;
+    const int64_t kNumTimesteps = 2000;
+    const int64_t kNumChunks = 16;
+    const float kStayScore = 2.f;
+
+    for (int64_t num_states : {64, 256}) {
+        std::cerr << "states : " << num_states << std::endl;
+        const auto scores = torch::randn({kNumTimesteps, kNumChunks, num_states * 4});
+
+        auto start = std::chrono::system_clock::now();
+        const auto Ms = scores.reshape({kNumTimesteps, kNumChunks, -1, 4});
+        const auto idx = torch::arange(num_states)
+                                 .repeat_interleave(4)
+                                 .reshape({4, -1})
+                                 .t()
+                                 .contiguous();
+        auto alpha = Ms.new_zeros({kNumTimesteps + 1, kNumChunks, num_states});
+        for (int64_t t = 0; t < kNumTimesteps; t++) {
+            auto scored_steps = torch::add(alpha.index({t, Slice(), idx}), Ms[t]);
+            auto scored_stay = torch::add(alpha[t], kStayScore).unsqueeze(-1);
+            alpha[t + 1] = torch::logsumexp(torch::cat({scored_stay, scored_steps}, -1), -1);
+        }
+        auto end = std::chrono::system_clock::now();
+        auto duration = std::chrono::duration<double>(end - start).count();
+        std::cerr << "torch ops    " << kNumChunks / duration << " chunks/s" << std::endl;
+
+        auto fwd = torch::empty({kNumChunks, kNumTimesteps + 1, num_states});
+        start = std::chrono::system_clock::now();
+        crf_forward_scan(scores.data_ptr<float>(), kNumTimesteps, scores.stride(0), kNumChunks,
+                         num_states, kStayScore, fwd.data_ptr<float>());
+        end = std::chrono::system_clock::now();
+        duration = std::chrono::duration<double>(end - start).count();
+        // The final scores should agree closely.
+        const auto max_diff = (fwd.index({Slice(), kNumTimesteps}) - alpha[kNumTimesteps])
+                                      .abs()
+                                      .max()
+                                      .item<float>();
+        std::cerr << "native scan  " << kNumChunks / duration << " chunks/s"
+                  << " max_diff=" << max_diff << std::endl
+                  << std::endl;
+    }
+}
+
+// Pushes messages through the queue from num_threads producers to num_threads
+// consumers, returning the throughput in messages per second.
+double time_queue(AsyncQueueBase<Message>& queue, int num_threads, size_t num_messages) {
+    const size_t messages_per_producer = num_messages / num_threads;
+
+    auto start = std::chrono::system_clock::now();
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < num_threads; ++i) {
+        consumers.emplace_back([&queue] {
+            Message message;
+            while (queue.try_pop(message)) {
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int i = 0; i < num_threads; ++i) {
+        producers.emplace_back([&queue, messages_per_producer] {
+            for (size_t j = 0; j < messages_per_producer; ++j) {
+                queue.try_push(std::make_shared<Read>());
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    queue.terminate();
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+    auto end = std::chrono::system_clock::now();
+
+    const auto duration = std::chrono::duration<double>(end - start).count();
+    return (messages_per_producer * num_threads) / duration;
+}
+
+void benchmark_queues() {
+    // Matches the default capacity of most pipeline nodes.
+    const size_t kQueueCapacity = 1000;
+    const size_t kNumMessages = 1000000;
+
+    for (int num_threads : {1, 4, 16}) {
+        std::cerr << "producers/consumers : " << num_threads << std::endl;
+
+        AsyncQueue<Message> mutex_queue(kQueueCapacity);
+        std::cerr << "mutex        " << time_queue(mutex_queue, num_threads, kNumMessages)
+                  << " msgs/s" << std::endl;
+
+        RingBufferQueue<Message> ring_buffer_queue(kQueueCapacity);
+        std::cerr << "ring buffer  " << time_queue(ring_buffer_queue, num_threads, kNumMessages)
+                  << " msgs/s" << std::endl
+                  << std::endl;
+    }
+}
+
+}  // namespace
+
+int benchmark(int argc, char* argv[]) {
+    argparse::ArgumentParser parser("dorado", DORADO_VERSION, argparse::default_arguments::help);
+
+    parser.add_argument("suite")
+            .help("which benchmarks to run: all, quantiles, normalisation, staging, decode or "
+                  "queues.")
+            .default_value(std::string("all"));
+
+    try {
+        parser.parse_args(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        std::cerr << parser;
+        std::exit(1);
+    }
+
+    const auto suite = parser.get<std::string>("suite");
+    if (suite == "all" || suite == "quantiles") {
+        benchmark_quantiles();
+    }
+    if (suite == "all" || suite == "normalisation") {
+        benchmark_normalisation();
+    }
+    if (suite == "all" || suite == "staging") {
+        benchmark_staging();
+    }
+    if (suite == "all" || suite == "decode") {
+        benchmark_decode();
+    }
+    if (suite == "all" || suite == "queues") {
+        benchmark_queues();
+    }
 
     return 0;
 }
@@ -5,5 +5,7 @@ int duplex(int argc, char *argv[]);
 int download(int argc, char *argv[]);
 int aligner(int argc, char *argv[]);
 int summary(int argc, char *argv[]);
+int merge(int argc, char *argv[]);
+int benchmark(int argc, char *argv[]);
 
 }  // namespace dorado
@@ -1,5 +1,6 @@
 #include "Version.h"
 #include "data_loader/DataLoader.h"
+#include "data_loader/DatasetCatalog.h"
 #include "decode/CPUDecoder.h"
 #include "nn/CRFModel.h"
 #include "read_pipeline/AlignerNode.h"
@@ -8,11 +9,13 @@
 #include "read_pipeline/DuplexSplitNode.h"
 #include "read_pipeline/HtsWriter.h"
 #include "read_pipeline/PairingNode.h"
+#include "read_pipeline/Pipeline.h"
 #include "read_pipeline/ProgressTracker.h"
 #include "read_pipeline/ReadFilterNode.h"
 #include "read_pipeline/ReadToBamTypeNode.h"
 #include "read_pipeline/ScalerNode.h"
 #include "read_pipeline/StereoDuplexEncoderNode.h"
+#include "utils/MemoryBudget.h"
 #include "utils/bam_utils.h"
 #include "utils/cli_utils.h"
 #include "utils/duplex_utils.h"
@@ -36,6 +39,7 @@
 
 #include <memory>
 #include <thread>
+#include <tuple>
 #include <unordered_set>
 
 namespace dorado {
@@ -84,6 +88,18 @@ int duplex(int argc, char* argv[]) {
             .implicit_value(true)
             .help("Recursively scan through directories to load FAST5 and POD5 files");
 
+    parser.add_argument("--dataset-index")
+            .default_value(false)
+            .implicit_value(true)
+            .help("Save an index of POD5 metadata in the input directory, and reuse it on later "
+                  "runs to speed up startup");
+
+    parser.add_argument("--shard")
+            .help("Basecall shard i of N, given as i/N with i from 0 to N-1, so that a dataset can "
+                  "be split between several hosts. Reads are sharded by channel, so pairs stay "
+                  "together.")
+            .default_value(std::string(""));
+
     parser.add_argument("-l", "--read-ids")
             .help("A file with a newline-delimited list of reads to basecall. If not provided, all "
                   "reads will be basecalled")
@@ -108,6 +124,11 @@ int duplex(int argc, char* argv[]) {
 
     parser.add_argument("-I").help("minimap2 index batch size.").default_value(std::string("16G"));
 
+    parser.add_argument("--max-inflight-memory")
+            .help("limit on the signal and call data held by reads in flight, e.g. 32G. Loading "
+                  "pauses while it is exceeded. 0 for no limit.")
+            .default_value(std::string("0"));
+
     parser.add_argument("--guard-gpus")
             .default_value(false)
             .implicit_value(true)
@@ -132,6 +153,8 @@ int duplex(int argc, char* argv[]) {
         auto min_qscore(parser.get<int>("--min-qscore"));
         auto ref = parser.get<std::string>("--reference");
         bool guard_gpus = parser.get<bool>("--guard-gpus");
+        utils::MemoryBudget::global().set_limit(
+                utils::parse_string_to_size(parser.get<std::string>("--max-inflight-memory")));
         const bool basespace_duplex = (model.compare("basespace") == 0);
         std::vector<std::string> args(argv, argv + argc);
         if (parser.get<bool>("--verbose")) {
@@ -172,34 +195,46 @@ int duplex(int argc, char* argv[]) {
         }
 
         bool recursive_file_loading = parser.get<bool>("--recursive");
+        DatasetCatalog::set_use_index(parser.get<bool>("--dataset-index"));
+
+        // Template and complement reads come from the same channel, so sharding by channel
+        // keeps pairs within a shard.
+        InputShard shard;
+        shard.by_channel = true;
+        if (!parser.get<std::string>("--shard").empty()) {
+            std::tie(shard.index, shard.count) =
+                    utils::parse_shard(parser.get<std::string>("--shard"));
+            if (basespace_duplex) {
+                throw std::runtime_error("--shard can't be used with basespace duplex.");
+            }
+        }
 
         size_t num_reads = (basespace_duplex ? read_list_from_pairs.size()
                                              : DataLoader::get_num_reads(reads, read_list, {},
-                                                                         recursive_file_loading));
+                                                                         recursive_file_loading,
+                                                                         shard));
         spdlog::debug("> Reads to process: {}", num_reads);
 
         std::unique_ptr<sam_hdr_t, void (*)(sam_hdr_t*)> hdr(sam_hdr_init(), sam_hdr_destroy);
         utils::add_pg_hdr(hdr.get(), args);
-        std::shared_ptr<HtsWriter> bam_writer;
-        std::shared_ptr<Aligner> aligner;
-        MessageSink* converted_reads_sink = nullptr;
-
-        if (ref.empty()) {
-            bam_writer = std::make_shared<HtsWriter>("-", output_mode, 4, num_reads);
-            converted_reads_sink = bam_writer.get();
-        } else {
-            bam_writer = std::make_shared<HtsWriter>("-", output_mode, 4, num_reads);
-            aligner = std::make_shared<Aligner>(
-                    *bam_writer, ref, parser.get<int>("k"), parser.get<int>("w"),
+        Pipeline pipeline;
+        auto& bam_writer = pipeline.add_node<HtsWriter>("-", output_mode, 4, num_reads);
+        Aligner* aligner = nullptr;
+        MessageSink* converted_reads_sink = &bam_writer;
+        if (!ref.empty()) {
+            aligner = &pipeline.add_node<Aligner>(
+                    bam_writer, ref, parser.get<int>("k"), parser.get<int>("w"),
                     utils::parse_string_to_size(parser.get<std::string>("I")),
                     std::thread::hardware_concurrency());
             utils::add_sq_hdr(hdr.get(), aligner->get_sequence_records_for_header());
-            converted_reads_sink = aligner.get();
+            converted_reads_sink = aligner;
         }
-        ReadToBamType read_converter(*converted_reads_sink, emit_moves, rna, 2);
+        auto& read_converter =
+                pipeline.add_node<ReadToBamType>(*converted_reads_sink, emit_moves, rna, 2);
         // The minimum sequence length is set to 5 to avoid issues with duplex node printing very short sequences for mismatched pairs.
-        ReadFilterNode read_filter_node(read_converter, min_qscore,
-                                        default_parameters.min_seqeuence_length, {}, 5);
+        auto& read_filter_node = pipeline.add_node<ReadFilterNode>(
+                read_converter, min_qscore, default_parameters.min_seqeuence_length,
+                std::unordered_set<std::string>{}, 5);
 
         torch::set_num_threads(1);
 
@@ -209,7 +244,7 @@ int duplex(int argc, char* argv[]) {
         if (aligner) {
             stats_reporters.push_back(make_stats_reporter(*aligner));
         }
-        stats_reporters.push_back(make_stats_reporter(*bam_writer));
+        stats_reporters.push_back(make_stats_reporter(bam_writer));
         stats_reporters.push_back(make_stats_reporter(read_filter_node));
 
         std::vector<dorado::stats::StatsCallable> stats_callables;
@@ -223,7 +258,7 @@ int duplex(int argc, char* argv[]) {
                 return 1;  // Exit with an error code
             }
             // Write header as no read group info is needed.
-            bam_writer->write_header(hdr.get());
+            bam_writer.write_header(hdr.get());
 
             spdlog::info("> Loading reads");
             auto read_map = read_bam(reads, read_list_from_pairs);
@@ -236,9 +271,10 @@ int duplex(int argc, char* argv[]) {
                     kStatsPeriod, stats_reporters, stats_callables);
             // End stats counting setup.
 
-            BaseSpaceDuplexCallerNode duplex_caller_node(read_filter_node, template_complement_map,
-                                                         read_map, threads);
-            bam_writer->join();  // Explicitly wait for all output rows to be written.
+            pipeline.add_node<BaseSpaceDuplexCallerNode>(read_filter_node,
+                                                         template_complement_map, read_map,
+                                                         threads);
+            bam_writer.join();  // Explicitly wait for all output rows to be written.
             stats_sampler->terminate();
         } else {  // Execute a Stereo Duplex pipeline.
 
@@ -272,7 +308,7 @@ int duplex(int argc, char* argv[]) {
             read_groups.merge(
                     DataLoader::load_read_groups(reads, duplex_rg_name, recursive_file_loading));
             utils::add_rg_hdr(hdr.get(), read_groups);
-            bam_writer->write_header(hdr.get());
+            bam_writer.write_header(hdr.get());
 
             std::vector<Runner> runners;
             std::vector<Runner> stereo_runners;
@@ -361,18 +397,24 @@ int duplex(int argc, char* argv[]) {
             auto adjusted_stereo_overlap = (overlap / stereo_model_stride) * stereo_model_stride;
 
             const int kStereoBatchTimeoutMS = 5000;
-            auto stereo_basecaller_node = std::make_unique<BasecallerNode>(
+            auto& stereo_basecaller_node = pipeline.add_node<BasecallerNode>(
                     read_filter_node, std::move(stereo_runners), adjusted_stereo_overlap,
                     kStereoBatchTimeoutMS, duplex_rg_name, 1000, "StereoBasecallerNode", true);
             auto simplex_model_stride = runners.front()->model_stride();
 
-            StereoDuplexEncoderNode stereo_node =
-                    StereoDuplexEncoderNode(*stereo_basecaller_node, simplex_model_stride);
+            // Only stereo encoded reads need basecalling.  Simplex reads, which have already
+            // been called, and rejected candidate pairs go straight to the read filter.
+            auto& stereo_node = pipeline.add_node<StereoDuplexEncoderNode>(read_filter_node,
+                                                                           simplex_model_stride);
+            stereo_node.add_output(stereo_basecaller_node, [](const Message& message) {
+                const auto* read = std::get_if<std::shared_ptr<Read>>(&message);
+                return read && (*read)->seq.empty();
+            });
 
-            PairingNode pairing_node(stereo_node,
-                                     template_complement_map.empty()
-                                             ? std::optional<std::map<std::string, std::string>>{}
-                                             : template_complement_map);
+            auto& pairing_node = pipeline.add_node<PairingNode>(
+                    stereo_node, template_complement_map.empty()
+                                         ? std::optional<std::map<std::string, std::string>>{}
+                                         : template_complement_map);
 
             // Initialize duplex split settings and create a duplex split node
             // with the given settings and number of devices. If
@@ -380,29 +422,32 @@ int duplex(int argc, char* argv[]) {
             // act as a passthrough, meaning it won't perform any splitting
             // operations and will just pass data through.
             DuplexSplitSettings splitter_settings;
-            DuplexSplitNode splitter_node(pairing_node, splitter_settings, num_devices);
+            auto& splitter_node = pipeline.add_node<DuplexSplitNode>(
+                    pairing_node, splitter_settings, num_devices);
 
             auto adjusted_simplex_overlap = (overlap / simplex_model_stride) * simplex_model_stride;
 
             const int kSimplexBatchTimeoutMS = 100;
-            auto basecaller_node = std::make_unique<BasecallerNode>(
+            auto& basecaller_node = pipeline.add_node<BasecallerNode>(
                     splitter_node, std::move(runners), adjusted_simplex_overlap,
                     kSimplexBatchTimeoutMS, model, 1000, "BasecallerNode", true);
 
-            ScalerNode scaler_node(*basecaller_node, model_config.signal_norm_params,
-                                   num_devices * 2);
+            auto& scaler_node = pipeline.add_node<ScalerNode>(
+                    basecaller_node, model_config.signal_norm_params, num_devices * 2);
 
             DataLoader loader(scaler_node, "cpu", num_devices, 0, std::move(read_list));
+            loader.set_shard(shard);
 
             // Setup stats counting
             using dorado::stats::make_stats_reporter;
-            stats_reporters.push_back(make_stats_reporter(*stereo_basecaller_node));
+            stats_reporters.push_back(make_stats_reporter(stereo_basecaller_node));
             stats_reporters.push_back(make_stats_reporter(stereo_node));
             stats_reporters.push_back(make_stats_reporter(pairing_node));
             stats_reporters.push_back(make_stats_reporter(splitter_node));
-            stats_reporters.push_back(make_stats_reporter(*basecaller_node));
+            stats_reporters.push_back(make_stats_reporter(basecaller_node));
             stats_reporters.push_back(make_stats_reporter(loader));
             stats_reporters.push_back(make_stats_reporter(scaler_node));
+            stats_reporters.push_back(make_stats_reporter(utils::MemoryBudget::global()));
 
             constexpr auto kStatsPeriod = 100ms;
             auto stats_sampler = std::make_unique<dorado::stats::StatsSampler>(
@@ -410,7 +455,7 @@ int duplex(int argc, char* argv[]) {
             // End stats counting setup.
 
             loader.load_reads(reads, parser.get<bool>("--recursive"), DataLoader::BY_CHANNEL);
-            bam_writer->join();  // Explicitly wait for all output rows to be written.
+            bam_writer.join();  // Explicitly wait for all output rows to be written.
             stats_sampler->terminate();
         }
         tracker.summarize();
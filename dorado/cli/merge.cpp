@@ -0,0 +1,65 @@
+#include "Version.h"
+#include "utils/bam_merge.h"
+#include "utils/log_utils.h"
+
+#include <argparse.hpp>
+#include <spdlog/spdlog.h>
+
+#include <exception>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dorado {
+
+int merge(int argc, char *argv[]) {
+    utils::InitLogging();
+
+    argparse::ArgumentParser parser("dorado", DORADO_VERSION, argparse::default_arguments::help);
+    parser.add_description(
+            "Merge SAM/BAM files, e.g. from sharded or resumed runs, into one BAM.\n"
+            "Coordinate sorted inputs are merged into coordinate order, other inputs are "
+            "concatenated in the order given.");
+    parser.add_argument("inputs")
+            .help("SAM/BAM files to merge.")
+            .nargs(argparse::nargs_pattern::at_least_one);
+    parser.add_argument("-o", "--output")
+            .help("output BAM file, or - for stdout.")
+            .default_value(std::string("-"));
+    parser.add_argument("-t", "--threads")
+            .help("number of threads for BAM compression when records are decoded.")
+            .default_value(0)
+            .scan<'i', int>();
+    parser.add_argument("-v", "--verbose").default_value(false).implicit_value(true);
+
+    try {
+        parser.parse_args(argc, argv);
+    } catch (const std::exception &e) {
+        std::ostringstream parser_stream;
+        parser_stream << parser;
+        spdlog::error("{}\n{}", e.what(), parser_stream.str());
+        std::exit(1);
+    }
+
+    if (parser.get<bool>("--verbose")) {
+        utils::SetDebugLogging();
+    }
+
+    auto inputs(parser.get<std::vector<std::string>>("inputs"));
+    auto output(parser.get<std::string>("output"));
+    auto threads(parser.get<int>("threads"));
+    threads = threads == 0 ? std::thread::hardware_concurrency() : threads;
+
+    try {
+        const auto mode = utils::merge_bams(inputs, output, threads,
+                                            std::vector<std::string>(argv, argv + argc));
+        spdlog::debug("> merged {} files, mode: {}", inputs.size(), static_cast<int>(mode));
+    } catch (const std::exception &e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace dorado
@@ -2,6 +2,9 @@
 
 #include "../utils/compat_utils.h"
 #include "../utils/types.h"
+#include "DatasetCatalog.h"
+#include "DatasetShard.h"
+#include "DirectoryWatcher.h"
 #include "cxxpool.h"
 #include "pod5_format/c_api.h"
 #include "read_pipeline/ReadPipeline.h"
@@ -14,10 +17,23 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
+#include <cstring>
 #include <ctime>
+#include <deque>
 #include <filesystem>
+#include <fstream>
+#include <future>
 #include <mutex>
+#include <numeric>
 #include <optional>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <system_error>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 
 namespace {
 
@@ -51,6 +67,122 @@ void string_reader(HighFive::Attribute& attribute, std::string& target_str) {
         target_str.resize(eol_pos);
     }
 };
+
+template <typename T>
+void write_value(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T read_value(std::istream& in) {
+    T value{};
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+}
+
+void write_string(std::ostream& out, const std::string& str) {
+    write_value<uint64_t>(out, str.size());
+    out.write(str.data(), str.size());
+}
+
+std::string read_string(std::istream& in) {
+    std::string str(read_value<uint64_t>(in), '\0');
+    in.read(str.data(), str.size());
+    return str;
+}
+
+// Temporary file holding POD5 reads which have been decoded ahead of when they're needed.
+// Only the fields set by process_pod5_read are kept.  The file is deleted when this is
+// destroyed.
+class ReadSpillFile {
+public:
+    ReadSpillFile() : m_path(unique_path()) {
+        m_file.open(m_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!m_file) {
+            throw std::runtime_error("Failed to create read spill file " + m_path.string());
+        }
+    }
+    ~ReadSpillFile() {
+        m_file.close();
+        std::error_code error;
+        std::filesystem::remove(m_path, error);
+    }
+
+    // Returns where the read was written, to pass to read().
+    std::streamoff write(const dorado::Read& read) {
+        m_file.seekp(0, std::ios::end);
+        const std::streamoff offset = m_file.tellp();
+        write_string(m_file, read.read_id);
+        write_value(m_file, read.sample_rate);
+        write_value(m_file, read.run_acquisition_start_time_ms);
+        write_value(m_file, read.start_time_ms);
+        write_value(m_file, read.scaling);
+        write_value(m_file, read.offset);
+        write_value(m_file, read.attributes.read_number);
+        write_string(m_file, read.attributes.fast5_filename);
+        write_value(m_file, read.attributes.mux);
+        write_value(m_file, read.attributes.num_samples);
+        write_value(m_file, read.attributes.channel_number);
+        write_string(m_file, read.attributes.start_time);
+        write_string(m_file, read.run_id);
+        write_value(m_file, read.start_sample);
+        write_value(m_file, read.end_sample);
+        write_string(m_file, read.flowcell_id);
+        const uint64_t num_samples = read.raw_data.numel();
+        write_value(m_file, num_samples);
+        m_file.write(reinterpret_cast<const char*>(read.raw_data.data_ptr<int16_t>()),
+                     num_samples * sizeof(int16_t));
+        if (!m_file) {
+            throw std::runtime_error("Failed to write to read spill file " + m_path.string());
+        }
+        return offset;
+    }
+
+    std::shared_ptr<dorado::Read> read(std::streamoff offset) {
+        m_file.seekg(offset);
+        auto read = std::make_shared<dorado::Read>();
+        read->read_id = read_string(m_file);
+        read->sample_rate = read_value<decltype(read->sample_rate)>(m_file);
+        read->run_acquisition_start_time_ms =
+                read_value<decltype(read->run_acquisition_start_time_ms)>(m_file);
+        read->start_time_ms = read_value<decltype(read->start_time_ms)>(m_file);
+        read->scaling = read_value<decltype(read->scaling)>(m_file);
+        read->offset = read_value<decltype(read->offset)>(m_file);
+        read->num_trimmed_samples = 0;
+        read->attributes.read_number = read_value<decltype(read->attributes.read_number)>(m_file);
+        read->attributes.fast5_filename = read_string(m_file);
+        read->attributes.mux = read_value<decltype(read->attributes.mux)>(m_file);
+        read->attributes.num_samples = read_value<decltype(read->attributes.num_samples)>(m_file);
+        read->attributes.channel_number =
+                read_value<decltype(read->attributes.channel_number)>(m_file);
+        read->attributes.start_time = read_string(m_file);
+        read->run_id = read_string(m_file);
+        read->start_sample = read_value<decltype(read->start_sample)>(m_file);
+        read->end_sample = read_value<decltype(read->end_sample)>(m_file);
+        read->flowcell_id = read_string(m_file);
+        read->is_duplex = false;
+        const auto num_samples = read_value<uint64_t>(m_file);
+        read->raw_data = torch::empty(num_samples, torch::TensorOptions().dtype(torch::kInt16));
+        m_file.read(reinterpret_cast<char*>(read->raw_data.data_ptr<int16_t>()),
+                    num_samples * sizeof(int16_t));
+        if (!m_file) {
+            throw std::runtime_error("Failed to read from read spill file " + m_path.string());
+        }
+        return read;
+    }
+
+private:
+    static std::filesystem::path unique_path() {
+        const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+        return std::filesystem::temp_directory_path() /
+               ("dorado_read_spill_" + std::to_string(std::random_device()()) + "_" +
+                std::to_string(now));
+    }
+
+    const std::filesystem::path m_path;
+    std::fstream m_file;
+};
+
 }  // namespace
 
 namespace dorado {
@@ -121,6 +253,44 @@ std::shared_ptr<dorado::Read> process_pod5_read(size_t row,
 
 void Pod5Destructor::operator()(Pod5FileReader_t* pod5) { pod5_close_and_free_reader(pod5); }
 
+size_t ReadIDHash::operator()(const ReadID& read_id) const {
+    // Read ids are random UUIDs, so any of their bytes hash well.
+    uint64_t low, high;
+    std::memcpy(&low, read_id.data(), sizeof(low));
+    std::memcpy(&high, read_id.data() + sizeof(low), sizeof(high));
+    return std::hash<uint64_t>()(low ^ high);
+}
+
+std::optional<ReadID> parse_read_id(const std::string& read_id) {
+    // 32 hex digits, with a dash after the 8th, 12th, 16th and 20th.
+    if (read_id.size() != 36) {
+        return std::nullopt;
+    }
+    auto hex_value = [](char c) -> int {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+    };
+    ReadID parsed;
+    size_t pos = 0;
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        if (pos == 8 || pos == 13 || pos == 18 || pos == 23) {
+            if (read_id[pos++] != '-') {
+                return std::nullopt;
+            }
+        }
+        const int high = hex_value(read_id[pos++]);
+        const int low = hex_value(read_id[pos++]);
+        if (high < 0 || low < 0) {
+            return std::nullopt;
+        }
+        parsed[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return parsed;
+}
+
 void DataLoader::load_reads(const std::string& path,
                             bool recursive_file_loading,
                             ReadOrder traversal_order) {
@@ -135,44 +305,73 @@ void DataLoader::load_reads(const std::string& path,
         return;
     }
 
+    m_load_start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count();
+
+    if (m_shard.is_sharded()) {
+        auto shard = m_shard;
+        shard.by_channel |= traversal_order == BY_CHANNEL;
+        m_dataset_shard = std::make_unique<DatasetShard>(
+                *DatasetCatalog::get(path, recursive_file_loading), shard);
+    }
+
     auto iterate_directory = [&](const auto& iterator_fn) {
         switch (traversal_order) {
-        case BY_CHANNEL:
-            // If traversal in channel order is required, the following algorithm
-            // is used -
-            // 1. iterate through all the read metadata to collect channel information
-            // across all pod5 files
-            // 2. store the read list sorted by channel number
-            spdlog::info("> Reading read channel info");
-            load_read_channels(path, recursive_file_loading);
-            spdlog::info("> Processed read channel info");
-            // 3. for each channel, iterate through all files and in each iteration
-            // only load the reads that correspond to that channel.
-            for (int channel = 0; channel <= m_max_channel; channel++) {
-                for (const auto& entry : iterator_fn(path)) {
-                    if (m_loaded_read_count == m_max_reads) {
-                        break;
+        case BY_CHANNEL: {
+            // Reads are loaded in order of channel, then start time, across the whole
+            // dataset, going by the catalog's listing of every read.
+            const auto catalog = DatasetCatalog::get(path, recursive_file_loading);
+            std::vector<const CatalogFile*> files;
+            for (const auto& file : catalog->files()) {
+                if (!file.is_pod5) {
+                    throw std::runtime_error(
+                            "Traversing reads by channel is only availabls for POD5. "
+                            "Encountered FAST5 at " +
+                            file.path);
+                }
+                if (m_dataset_shard && !m_dataset_shard->contains_file(file.path)) {
+                    continue;
+                }
+                files.push_back(&file);
+            }
+            load_pod5_reads_by_channel(files);
+            break;
+        }
+        case UNRESTRICTED: {
+            // Files are loaded in directory order.  Consecutive POD5 files are loaded
+            // together, so that the loader can read ahead across their boundaries.
+            std::vector<Pod5FileReads> pod5_files;
+            std::unordered_map<std::string, const CatalogFile*> catalog_files;
+            std::shared_ptr<const DatasetCatalog> catalog;
+            auto load_pod5_files = [&] {
+                if (filters_reads() && !pod5_files.empty()) {
+                    // Resolve the read lists and shard against each file's reads up front,
+                    // so that files and batches without any wanted reads are never read.
+                    if (!catalog) {
+                        catalog = DatasetCatalog::get(path, recursive_file_loading);
+                        for (const auto& file : catalog->files()) {
+                            catalog_files.emplace(file.path, &file);
+                        }
                     }
-                    auto path = std::filesystem::path(entry);
-                    std::string ext = path.extension().string();
-                    std::transform(ext.begin(), ext.end(), ext.begin(),
-                                   [](unsigned char c) { return std::tolower(c); });
-                    if (ext == ".fast5") {
-                        throw std::runtime_error(
-                                "Traversing reads by channel is only availabls for POD5. "
-                                "Encountered FAST5 at " +
-                                path.string());
-                    } else if (ext == ".pod5") {
-                        auto& channel_to_read_ids = m_file_channel_read_order_map.at(path.string());
-                        auto& read_ids = channel_to_read_ids[channel];
-                        if (!read_ids.empty()) {
-                            load_pod5_reads_from_file_by_read_ids(path.string(), read_ids);
+                    std::vector<Pod5FileReads> selected_files;
+                    for (auto& file : pod5_files) {
+                        auto it = catalog_files.find(file.path);
+                        if (it != catalog_files.end()) {
+                            file.read_ids = select_pod5_reads(*it->second);
+                        }
+                        if (file.read_ids && file.read_ids->empty()) {
+                            ++m_num_files_skipped;
+                            continue;
                         }
+                        selected_files.push_back(std::move(file));
                     }
+                    pod5_files = std::move(selected_files);
                 }
-            }
-            break;
-        case UNRESTRICTED:
+                load_pod5_reads_from_files(pod5_files);
+                pod5_files.clear();
+            };
+
             for (const auto& entry : iterator_fn(path)) {
                 if (m_loaded_read_count == m_max_reads) {
                     break;
@@ -180,13 +379,19 @@ void DataLoader::load_reads(const std::string& path,
                 std::string ext = std::filesystem::path(entry).extension().string();
                 std::transform(ext.begin(), ext.end(), ext.begin(),
                                [](unsigned char c) { return std::tolower(c); });
+                if (m_dataset_shard && !m_dataset_shard->contains_file(entry.path().string())) {
+                    continue;
+                }
                 if (ext == ".fast5") {
+                    load_pod5_files();
                     load_fast5_reads_from_file(entry.path().string());
                 } else if (ext == ".pod5") {
-                    load_pod5_reads_from_file(entry.path().string());
+                    pod5_files.push_back({entry.path().string(), std::nullopt});
                 }
             }
+            load_pod5_files();
             break;
+        }
         default:
             throw std::runtime_error("Unsupported traversal order detected " +
                                      std::to_string(traversal_order));
@@ -205,46 +410,41 @@ void DataLoader::load_reads(const std::string& path,
     m_read_sink.terminate();
 }
 
+void DataLoader::load_reads(DirectoryWatcher& watcher) {
+    if (m_shard.is_sharded()) {
+        // Shards are decided from the whole dataset, which isn't known until the watch ends.
+        throw std::runtime_error("Sharding isn't supported when watching for input files.");
+    }
+    m_load_start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count();
+
+    // Files are loaded as they're found, without waiting for the watch to end, so reads are
+    // basecalled while the run is still being acquired.  They aren't in the dataset catalog,
+    // so any read lists are checked row by row.
+    while (m_loaded_read_count < m_max_reads) {
+        const auto paths = watcher.next_files();
+        if (paths.empty()) {
+            break;
+        }
+        std::vector<Pod5FileReads> files;
+        for (const auto& path : paths) {
+            files.push_back({path, std::nullopt});
+        }
+        load_pod5_reads_from_files(files);
+    }
+
+    m_read_sink.terminate();
+}
+
 int DataLoader::get_num_reads(std::string data_path,
                               std::optional<std::unordered_set<std::string>> read_list,
                               const std::unordered_set<std::string>& ignore_read_list,
-                              bool recursive_file_loading) {
-    size_t num_reads = 0;
-
-    auto iterate_directory = [&](const auto& iterator_fn) {
-        for (const auto& entry : iterator_fn(data_path)) {
-            std::string ext = std::filesystem::path(entry).extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            if (ext == ".pod5") {
-                pod5_init();
-
-                // Open the file ready for walking:
-                Pod5FileReader_t* file = pod5_open_file(entry.path().string().c_str());
-
-                size_t read_count;
-                pod5_get_read_count(file, &read_count);
-                if (!file) {
-                    spdlog::error("Failed to open file {}: {}", entry.path().string().c_str(),
-                                  pod5_get_error_string());
-                }
-
-                num_reads += read_count;
-                if (pod5_close_and_free_reader(file) != POD5_OK) {
-                    spdlog::error("Failed to close and free POD5 reader");
-                }
-            }
-        }
-    };
-
-    if (recursive_file_loading) {
-        iterate_directory([](const auto& path) {
-            return std::filesystem::recursive_directory_iterator(path);
-        });
-    } else {
-        iterate_directory(
-                [](const auto& path) { return std::filesystem::directory_iterator(path); });
-    }
+                              bool recursive_file_loading,
+                              const InputShard& shard) {
+    const auto catalog = DatasetCatalog::get(data_path, recursive_file_loading);
+    size_t num_reads = shard.is_sharded() ? DatasetShard(*catalog, shard).num_pod5_reads(*catalog)
+                                          : catalog->num_pod5_reads();
 
     // Remove the reads in the ignore list from the total dataset read count.
     num_reads -= ignore_read_list.size();
@@ -262,151 +462,24 @@ int DataLoader::get_num_reads(std::string data_path,
     return num_reads;
 }
 
-void DataLoader::load_read_channels(std::string data_path, bool recursive_file_loading) {
-    auto iterate_directory = [&](const auto& iterator_fn) {
-        for (const auto& entry : iterator_fn(data_path)) {
-            auto file_path = std::filesystem::path(entry);
-            std::string ext = file_path.extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            if (ext != ".pod5") {
-                continue;
-            }
-            pod5_init();
-
-            // Use a std::map to store by sorted channel order.
-            m_file_channel_read_order_map.emplace(file_path.string(), channel_to_read_id_t());
-            auto& channel_to_read_id = m_file_channel_read_order_map[file_path.string()];
-
-            // Open the file ready for walking:
-            Pod5FileReader_t* file = pod5_open_file(file_path.string().c_str());
-
-            if (!file) {
-                spdlog::error("Failed to open file {}: {}", file_path.string().c_str(),
-                              pod5_get_error_string());
-                continue;
-            }
-            std::size_t batch_count = 0;
-            if (pod5_get_read_batch_count(&batch_count, file) != POD5_OK) {
-                spdlog::error("Failed to query batch count: {}", pod5_get_error_string());
-            }
-
-            for (std::size_t batch_index = 0; batch_index < batch_count; ++batch_index) {
-                Pod5ReadRecordBatch_t* batch = nullptr;
-                if (pod5_get_read_batch(&batch, file, batch_index) != POD5_OK) {
-                    spdlog::error("Failed to get batch: {}", pod5_get_error_string());
-                    continue;
-                }
-
-                std::size_t batch_row_count = 0;
-                if (pod5_get_read_batch_row_count(&batch_row_count, batch) != POD5_OK) {
-                    spdlog::error("Failed to get batch row count");
-                    continue;
-                }
-
-                for (std::size_t row = 0; row < batch_row_count; ++row) {
-                    uint16_t read_table_version = 0;
-                    ReadBatchRowInfo_t read_data;
-                    if (pod5_get_read_batch_row_info_data(batch, row, READ_BATCH_ROW_INFO_VERSION,
-                                                          &read_data,
-                                                          &read_table_version) != POD5_OK) {
-                        spdlog::error("Failed to get read {}", row);
-                        continue;
-                    }
-
-                    int channel = read_data.channel;
-
-                    // Update maximum number of channels encountered.
-                    m_max_channel = std::max(m_max_channel, channel);
-
-                    // Store the read_id in the channel's list.
-                    ReadID read_id;
-                    std::memcpy(read_id.data(), read_data.read_id, POD5_READ_ID_SIZE);
-                    channel_to_read_id[channel].push_back(std::move(read_id));
-                }
-
-                if (pod5_free_read_batch(batch) != POD5_OK) {
-                    spdlog::error("Failed to release batch");
-                }
-            }
-            if (pod5_close_and_free_reader(file) != POD5_OK) {
-                spdlog::error("Failed to close and free POD5 reader");
-            }
-        }
-    };
-
-    if (recursive_file_loading) {
-        iterate_directory([](const auto& path) {
-            return std::filesystem::recursive_directory_iterator(path);
-        });
-    } else {
-        iterate_directory(
-                [](const auto& path) { return std::filesystem::directory_iterator(path); });
-    }
-}
-
 std::unordered_map<std::string, ReadGroup> DataLoader::load_read_groups(
         std::string data_path,
         std::string model_path,
         bool recursive_file_loading) {
     std::unordered_map<std::string, ReadGroup> read_groups;
 
-    auto iterate_directory = [&](const auto& iterator_fn) {
-        for (const auto& entry : iterator_fn(data_path)) {
-            std::string ext = std::filesystem::path(entry).extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            if (ext == ".pod5") {
-                pod5_init();
-
-                // Open the file ready for walking:
-                Pod5FileReader_t* file = pod5_open_file(entry.path().string().c_str());
-
-                if (!file) {
-                    spdlog::error("Failed to open file {}: {}", entry.path().string().c_str(),
-                                  pod5_get_error_string());
-                } else {
-                    // First get the run info count
-                    run_info_index_t run_info_count;
-                    pod5_get_file_run_info_count(file, &run_info_count);
-                    for (run_info_index_t idx = 0; idx < run_info_count; idx++) {
-                        RunInfoDictData_t* run_info_data;
-                        pod5_get_file_run_info(file, idx, &run_info_data);
-
-                        auto exp_start_time_ms = run_info_data->acquisition_start_time_ms;
-                        std::string flowcell_id = run_info_data->flow_cell_id;
-                        std::string device_id = run_info_data->system_name;
-                        std::string run_id = run_info_data->acquisition_id;
-                        std::string sample_id = run_info_data->sample_id;
-
-                        if (pod5_free_run_info(run_info_data) != POD5_OK) {
-                            spdlog::error("Failed to free run info");
-                        }
-
-                        std::string id = run_id + "_" + model_path;
-                        read_groups[id] = ReadGroup{
-                                run_id,
-                                model_path,
-                                flowcell_id,
-                                device_id,
-                                utils::get_string_timestamp_from_unix_time(exp_start_time_ms),
-                                sample_id};
-                    }
-                    if (pod5_close_and_free_reader(file) != POD5_OK) {
-                        spdlog::error("Failed to close and free POD5 reader");
-                    }
-                }
-            }
+    const auto catalog = DatasetCatalog::get(data_path, recursive_file_loading);
+    for (const auto& file : catalog->files()) {
+        for (const auto& run_info : file.run_infos) {
+            std::string id = run_info.run_id + "_" + model_path;
+            read_groups[id] = ReadGroup{
+                    run_info.run_id,
+                    model_path,
+                    run_info.flowcell_id,
+                    run_info.device_id,
+                    utils::get_string_timestamp_from_unix_time(run_info.acquisition_start_time_ms),
+                    run_info.sample_id};
         }
-    };
-
-    if (recursive_file_loading) {
-        iterate_directory([](const auto& path) {
-            return std::filesystem::recursive_directory_iterator(path);
-        });
-    } else {
-        iterate_directory(
-                [](const auto& path) { return std::filesystem::directory_iterator(path); });
     }
 
     return read_groups;
@@ -415,85 +488,36 @@ std::unordered_map<std::string, ReadGroup> DataLoader::load_read_groups(
 uint16_t DataLoader::get_sample_rate(std::string data_path, bool recursive_file_loading) {
     std::optional<uint16_t> sample_rate = std::nullopt;
 
-    auto iterate_directory = [&](const auto& iterator_fn) {
-        for (const auto& entry : iterator_fn((data_path))) {
-            std::string ext = std::filesystem::path(entry).extension().string();
-            std::transform(ext.begin(), ext.end(), ext.begin(),
-                           [](unsigned char c) { return std::tolower(c); });
-            auto file_path = entry.path().string();
-            if (ext == ".pod5") {
-                pod5_init();
-
-                // Open the file ready for walking:
-                Pod5FileReader_t* file = pod5_open_file(file_path.c_str());
-
-                if (!file) {
-                    spdlog::error("Failed to open file {}: {}", file_path.c_str(),
-                                  pod5_get_error_string());
-                } else {
-                    // First get the run info count
-                    run_info_index_t run_info_count;
-                    if (pod5_get_file_run_info_count(file, &run_info_count) != POD5_OK) {
-                        spdlog::error("Failed to fetch POD5 run info count for file {} : {}",
-                                      file_path.c_str(), pod5_get_error_string());
-                        continue;
-                    }
-                    if (run_info_count > static_cast<run_info_index_t>(0)) {
-                        RunInfoDictData_t* run_info_data;
-                        if (pod5_get_file_run_info(file, 0, &run_info_data) != POD5_OK) {
-                            spdlog::error(
-                                    "Failed to fetch POD5 run info dict for file {} and run info "
-                                    "index 0: {}",
-                                    file_path.c_str(), pod5_get_error_string());
-                            continue;
-                        }
-                        sample_rate = run_info_data->sample_rate;
-
-                        if (pod5_free_run_info(run_info_data) != POD5_OK) {
-                            spdlog::error(
-                                    "Failed to free POD5 run info for file {} and run info index 0",
-                                    file_path.c_str());
-                        }
-                    }
-                }
-
-                if (pod5_close_and_free_reader(file) != POD5_OK) {
-                    spdlog::error("Failed to close and free POD5 reader for file {}",
-                                  file_path.c_str());
-                }
-            } else if (ext == ".fast5") {
-                H5Easy::File file(entry.path().string(), H5Easy::File::ReadOnly);
-                HighFive::Group reads = file.getGroup("/");
-                int num_reads = reads.getNumberObjects();
-
-                if (num_reads > 0) {
-                    auto read_id = reads.getObjectName(0);
-                    HighFive::Group read = reads.getGroup(read_id);
-
-                    HighFive::Group channel_id_group = read.getGroup("channel_id");
-                    HighFive::Attribute sampling_rate_attr =
-                            channel_id_group.getAttribute("sampling_rate");
-
-                    float sampling_rate;
-                    sampling_rate_attr.read(sampling_rate);
-                    sample_rate = static_cast<uint16_t>(sampling_rate);
-                }
+    const auto catalog = DatasetCatalog::get(data_path, recursive_file_loading);
+    for (const auto& file : catalog->files()) {
+        if (file.is_pod5) {
+            if (!file.run_infos.empty()) {
+                sample_rate = file.run_infos.front().sample_rate;
             }
-
-            // Break out of loop if sample rate is found.
-            if (sample_rate) {
-                break;
+        } else {
+            // FAST5 files aren't catalogued, but only the first needs opening.
+            H5Easy::File fast5_file(file.path, H5Easy::File::ReadOnly);
+            HighFive::Group reads = fast5_file.getGroup("/");
+            int num_reads = reads.getNumberObjects();
+
+            if (num_reads > 0) {
+                auto read_id = reads.getObjectName(0);
+                HighFive::Group read = reads.getGroup(read_id);
+
+                HighFive::Group channel_id_group = read.getGroup("channel_id");
+                HighFive::Attribute sampling_rate_attr =
+                        channel_id_group.getAttribute("sampling_rate");
+
+                float sampling_rate;
+                sampling_rate_attr.read(sampling_rate);
+                sample_rate = static_cast<uint16_t>(sampling_rate);
             }
         }
-    };
 
-    if (recursive_file_loading) {
-        iterate_directory([](const auto& path) {
-            return std::filesystem::recursive_directory_iterator(path);
-        });
-    } else {
-        iterate_directory(
-                [](const auto& path) { return std::filesystem::directory_iterator(path); });
+        // Break out of loop if sample rate is found.
+        if (sample_rate) {
+            break;
+        }
     }
 
     if (sample_rate) {
@@ -503,176 +527,381 @@ uint16_t DataLoader::get_sample_rate(std::string data_path, bool recursive_file_
     }
 }
 
-void DataLoader::load_pod5_reads_from_file_by_read_ids(const std::string& path,
-                                                       const std::vector<ReadID>& read_ids) {
-    pod5_init();
-
-    // Open the file ready for walking:
-    // TODO: The earlier implementation was caching the pod5 readers into a
-    // map and re-using it during each iteration. However, we found a leak
-    // in the pod5 traversal API which persists unless the reader is opened
-    // and closed everytime. So the caching logic was reverted until the
-    // leak is fixed in pod5 API.
+Pod5FilePtr DataLoader::open_pod5_file(const std::string& path) {
     Pod5FileReader_t* file = pod5_open_file(path.c_str());
-
     if (!file) {
         spdlog::error("Failed to open file {}: {}", path, pod5_get_error_string());
-        return;
+        return nullptr;
     }
+    ++m_num_files_opened;
+    return Pod5FilePtr(file, Pod5Destructor());
+}
 
-    std::vector<uint8_t> read_id_array(POD5_READ_ID_SIZE * read_ids.size());
-    for (int i = 0; i < read_ids.size(); i++) {
-        std::memcpy(read_id_array.data() + POD5_READ_ID_SIZE * i, read_ids[i].data(),
-                    POD5_READ_ID_SIZE);
+Pod5BatchPtr DataLoader::fetch_pod5_batch(const Pod5FilePtr& file, std::size_t batch_index) {
+    Pod5ReadRecordBatch_t* batch = nullptr;
+    if (pod5_get_read_batch(&batch, file.get(), batch_index) != POD5_OK) {
+        spdlog::error("Failed to get batch: {}", pod5_get_error_string());
+        return nullptr;
     }
+    ++m_num_batches_fetched;
+    // The batch is released once the last read decompressed from it is done with it.
+    return Pod5BatchPtr(batch, [](Pod5ReadRecordBatch_t* batch) {
+        if (pod5_free_read_batch(batch) != POD5_OK) {
+            spdlog::error("Failed to release batch");
+        }
+    });
+}
 
+bool DataLoader::filters_reads() const {
+    return has_read_lists() || (m_dataset_shard && m_dataset_shard->splits_files());
+}
+
+bool DataLoader::is_read_wanted(const ReadID& read_id, uint16_t channel) const {
+    return m_ignored_pod5_read_ids.find(read_id) == m_ignored_pod5_read_ids.end() &&
+           (!m_allowed_pod5_read_ids ||
+            m_allowed_pod5_read_ids->find(read_id) != m_allowed_pod5_read_ids->end()) &&
+           (!m_dataset_shard || m_dataset_shard->contains_read(read_id, channel));
+}
+
+std::optional<std::vector<ReadID>> DataLoader::select_pod5_reads(const CatalogFile& file) const {
+    if (!filters_reads() || !file.scanned) {
+        return std::nullopt;
+    }
+    std::vector<ReadID> read_ids;
+    for (size_t i = 0; i < file.read_ids.size(); ++i) {
+        if (is_read_wanted(file.read_ids[i], file.channels[i])) {
+            read_ids.push_back(file.read_ids[i]);
+        }
+    }
+    return read_ids;
+}
+
+std::vector<DataLoader::Pod5BatchRows> DataLoader::plan_pod5_batches(
+        const Pod5FilePtr& file,
+        const std::optional<std::vector<ReadID>>& read_ids) {
     std::size_t batch_count = 0;
-    if (pod5_get_read_batch_count(&batch_count, file) != POD5_OK) {
+    if (pod5_get_read_batch_count(&batch_count, file.get()) != POD5_OK) {
         spdlog::error("Failed to query batch count: {}", pod5_get_error_string());
     }
 
-    std::vector<std::uint32_t> traversal_batch_counts(batch_count);
-    std::vector<std::uint32_t> traversal_batch_rows(read_ids.size());
-    size_t find_success_count;
-    pod5_error_t err = pod5_plan_traversal(file, read_id_array.data(), read_ids.size(),
-                                           traversal_batch_counts.data(),
-                                           traversal_batch_rows.data(), &find_success_count);
-    if (err != POD5_OK) {
-        spdlog::error("Couldn't create plan for {} with reads {}", path, read_ids.size());
-        return;
+    std::vector<Pod5BatchRows> plan;
+    if (read_ids) {
+        std::vector<uint32_t> batch_counts(batch_count);
+        std::vector<uint32_t> batch_rows(read_ids->size());
+        std::size_t find_success_count = 0;
+        if (pod5_plan_traversal(file.get(), reinterpret_cast<const uint8_t*>(read_ids->data()),
+                                read_ids->size(), batch_counts.data(), batch_rows.data(),
+                                &find_success_count) == POD5_OK) {
+            if (find_success_count != read_ids->size()) {
+                spdlog::warn("Found {} of {} listed reads in a POD5 file", find_success_count,
+                             read_ids->size());
+            }
+            // Rows are listed batch by batch.  They're sorted within each batch so that reads
+            // come out in file order, as they would without a read list.
+            std::size_t rows_start = 0;
+            for (std::size_t batch_index = 0; batch_index < batch_count; ++batch_index) {
+                const std::size_t rows_end = rows_start + batch_counts[batch_index];
+                if (rows_end > rows_start) {
+                    std::vector<uint32_t> rows(batch_rows.begin() + rows_start,
+                                               batch_rows.begin() + rows_end);
+                    std::sort(rows.begin(), rows.end());
+                    plan.push_back({batch_index, std::move(rows)});
+                }
+                rows_start = rows_end;
+            }
+            return plan;
+        }
+        // Every batch is read instead, and its rows checked against the read lists.
+        spdlog::error("Failed to plan traversal of file: {}", pod5_get_error_string());
     }
-
-    if (find_success_count != read_ids.size()) {
-        spdlog::error("Reads found by plan {}, reads in input {}", find_success_count,
-                      read_ids.size());
-        throw std::runtime_error("Plan traveral didn't yield correct number of reads");
+    for (std::size_t batch_index = 0; batch_index < batch_count; ++batch_index) {
+        plan.push_back({batch_index, std::nullopt});
     }
+    return plan;
+}
 
-    cxxpool::thread_pool pool{m_num_worker_threads};
+void DataLoader::load_pod5_reads_by_channel(const std::vector<const CatalogFile*>& files) {
+    pod5_init();
 
-    uint32_t row_offset = 0;
-    for (std::size_t batch_index = 0; batch_index < batch_count; ++batch_index) {
-        if (m_loaded_read_count == m_max_reads) {
-            break;
-        }
-        Pod5ReadRecordBatch_t* batch = nullptr;
-        if (pod5_get_read_batch(&batch, file, batch_index) != POD5_OK) {
-            spdlog::error("Failed to get batch: {}", pod5_get_error_string());
+    // Where a read is, and the key it is sorted on.
+    struct PlannedRead {
+        uint16_t channel;
+        uint64_t start_sample;
+        uint32_t file_index;
+        uint32_t batch_index;
+        uint32_t row;
+    };
+
+    // The catalog has every read's channel, start and position in its file, so the whole
+    // dataset is sorted once, without opening any files.
+    std::vector<PlannedRead> plan;
+    for (uint32_t file_index = 0; file_index < files.size(); ++file_index) {
+        const CatalogFile& file = *files[file_index];
+        if (!file.scanned) {
+            spdlog::error("Skipping POD5 file {}, whose reads couldn't be listed", file.path);
             continue;
         }
-
-        std::vector<std::future<std::shared_ptr<Read>>> futures;
-        for (std::size_t row_idx = 0; row_idx < traversal_batch_counts[batch_index]; row_idx++) {
-            uint32_t row = traversal_batch_rows[row_idx + row_offset];
-
-            uint16_t read_table_version = 0;
-            ReadBatchRowInfo_t read_data;
-            if (pod5_get_read_batch_row_info_data(batch, row, READ_BATCH_ROW_INFO_VERSION,
-                                                  &read_data, &read_table_version) != POD5_OK) {
-                spdlog::error("Failed to get read {}", row);
-                continue;
+        const std::size_t plan_size = plan.size();
+        std::size_t read_index = 0;
+        for (uint32_t batch_index = 0; batch_index < file.batch_num_rows.size(); ++batch_index) {
+            for (uint32_t row = 0; row < file.batch_num_rows[batch_index]; ++row, ++read_index) {
+                if (!filters_reads() ||
+                    is_read_wanted(file.read_ids[read_index], file.channels[read_index])) {
+                    plan.push_back(PlannedRead{file.channels[read_index],
+                                               file.start_samples[read_index], file_index,
+                                               batch_index, row});
+                }
             }
-
-            char read_id_tmp[37];
-            pod5_error_t err = pod5_format_read_id(read_data.read_id, read_id_tmp);
-            std::string read_id_str(read_id_tmp);
-            bool read_in_ignore_list =
-                    m_ignored_read_ids.find(read_id_str) != m_ignored_read_ids.end();
-            bool read_in_read_list =
-                    !m_allowed_read_ids ||
-                    (m_allowed_read_ids->find(read_id_str) != m_allowed_read_ids->end());
-            if (!read_in_ignore_list && read_in_read_list) {
-                futures.push_back(pool.push(process_pod5_read, row, batch, file, path, m_device));
+        }
+        if (filters_reads() && plan.size() == plan_size) {
+            ++m_num_files_skipped;
+        }
+    }
+    // Stable, so reads with the same key stay in file order.
+    std::stable_sort(plan.begin(), plan.end(), [](const PlannedRead& a, const PlannedRead& b) {
+        return std::tie(a.channel, a.start_sample) < std::tie(b.channel, b.start_sample);
+    });
+    // Only the reads that will be sent on are loaded.
+    plan.resize(std::min<std::size_t>(
+            plan.size(), m_max_reads - std::min<std::size_t>(m_loaded_read_count, m_max_reads)));
+
+    // Reads are decoded in file order, so that each file is opened and each batch fetched just
+    // once, however the channels are spread between them.  Each is then sent on once it's the
+    // next in the plan, and until then waits in memory, or in a spill file if more than
+    // m_max_buffered_bytes are waiting.  Reads needed furthest ahead are spilled first.
+    std::vector<std::size_t> load_order(plan.size());
+    std::iota(load_order.begin(), load_order.end(), std::size_t(0));
+    std::sort(load_order.begin(), load_order.end(), [&plan](std::size_t a, std::size_t b) {
+        return std::tie(plan[a].file_index, plan[a].batch_index, plan[a].row) <
+               std::tie(plan[b].file_index, plan[b].batch_index, plan[b].row);
+    });
+
+    auto signal_bytes = [](const Read& read) {
+        return static_cast<uint64_t>(read.raw_data.numel() * read.raw_data.element_size());
+    };
+    enum class ReadState : uint8_t { PENDING, BUFFERED, SPILLED, SKIPPED };
+    std::vector<ReadState> read_states(plan.size(), ReadState::PENDING);
+    std::vector<std::shared_ptr<Read>> buffered_reads(plan.size());
+    std::set<std::size_t> buffered_positions;
+    uint64_t buffered_bytes = 0;
+    std::unordered_map<std::size_t, std::streamoff> spill_offsets;
+    std::optional<ReadSpillFile> spill_file;
+    std::size_t next_to_send = 0;
+
+    auto send_ready_reads = [&] {
+        for (; next_to_send < plan.size() && read_states[next_to_send] != ReadState::PENDING;
+             ++next_to_send) {
+            if (read_states[next_to_send] == ReadState::BUFFERED) {
+                auto read = std::move(buffered_reads[next_to_send]);
+                buffered_positions.erase(next_to_send);
+                buffered_bytes -= signal_bytes(*read);
+                push_read(std::move(read));
+            } else if (read_states[next_to_send] == ReadState::SPILLED) {
+                auto offset = spill_offsets.find(next_to_send);
+                push_read(spill_file->read(offset->second));
+                spill_offsets.erase(offset);
+            }
+        }
+    };
+    // Takes the read at position in the plan, which is null if it couldn't be loaded.
+    auto add_read = [&](std::size_t position, std::shared_ptr<Read> read) {
+        if (!read) {
+            read_states[position] = ReadState::SKIPPED;
+        } else {
+            buffered_bytes += signal_bytes(*read);
+            buffered_reads[position] = std::move(read);
+            buffered_positions.insert(position);
+            read_states[position] = ReadState::BUFFERED;
+        }
+        send_ready_reads();
+        while (buffered_bytes > m_max_buffered_bytes && !buffered_positions.empty()) {
+            const auto furthest = std::prev(buffered_positions.end());
+            auto& spilled_read = buffered_reads[*furthest];
+            if (!spill_file) {
+                spill_file.emplace();
             }
+            spill_offsets.emplace(*furthest, spill_file->write(*spilled_read));
+            buffered_bytes -= signal_bytes(*spilled_read);
+            spilled_read.reset();
+            read_states[*furthest] = ReadState::SPILLED;
+            buffered_positions.erase(furthest);
+            ++m_num_reads_spilled;
         }
+    };
 
-        for (auto& v : futures) {
-            auto read = v.get();
-            m_read_sink.push_message(std::move(read));
-            m_loaded_read_count++;
+    cxxpool::thread_pool decode_pool{m_num_worker_threads};
+    const std::size_t max_reads_in_progress = 4 * m_num_worker_threads;
+    std::deque<std::pair<std::size_t, std::future<std::shared_ptr<Read>>>> reads_in_progress;
+    auto add_completed_reads = [&](std::size_t max_remaining) {
+        while (reads_in_progress.size() > max_remaining) {
+            auto [position, read] = std::move(reads_in_progress.front());
+            reads_in_progress.pop_front();
+            m_num_reads_in_progress = reads_in_progress.size();
+            add_read(position, read.get());
         }
+    };
 
-        if (pod5_free_read_batch(batch) != POD5_OK) {
-            spdlog::error("Failed to release batch");
+    std::optional<uint32_t> file_index;
+    Pod5FilePtr file;
+    std::optional<uint32_t> batch_index;
+    Pod5BatchPtr batch;
+    for (const std::size_t position : load_order) {
+        const auto& planned_read = plan[position];
+        // A file or batch that fails is left null, so it isn't retried for each read.
+        if (planned_read.file_index != file_index) {
+            file_index = planned_read.file_index;
+            file = open_pod5_file(files[planned_read.file_index]->path);
+            batch_index.reset();
+        }
+        if (file && planned_read.batch_index != batch_index) {
+            batch_index = planned_read.batch_index;
+            batch = fetch_pod5_batch(file, planned_read.batch_index);
+        }
+        if (!file || !batch) {
+            add_read(position, nullptr);
+            continue;
         }
 
-        row_offset += traversal_batch_counts[batch_index];
-    }
-    if (pod5_close_and_free_reader(file) != POD5_OK) {
-        spdlog::error("Failed to close and free POD5 reader");
+        // The task holds on to the batch and file until the read is decompressed.
+        const std::string& path = files[planned_read.file_index]->path;
+        reads_in_progress.emplace_back(
+                position, decode_pool.push([this, row = planned_read.row, batch, file, &path] {
+                    return process_pod5_read(row, batch.get(), file.get(), path, m_device);
+                }));
+        m_num_reads_in_progress = reads_in_progress.size();
+        add_completed_reads(max_reads_in_progress);
     }
+    add_completed_reads(0);
+    m_num_reads_in_progress = 0;
 }
 
-void DataLoader::load_pod5_reads_from_file(const std::string& path) {
-    pod5_init();
-
-    // Open the file ready for walking:
-    Pod5FileReader_t* file = pod5_open_file(path.c_str());
-
-    if (!file) {
-        spdlog::error("Failed to open file {}: {}", path, pod5_get_error_string());
-    }
-
-    std::size_t batch_count = 0;
-    if (pod5_get_read_batch_count(&batch_count, file) != POD5_OK) {
-        spdlog::error("Failed to query batch count: {}", pod5_get_error_string());
+void DataLoader::load_pod5_reads_from_files(const std::vector<Pod5FileReads>& files) {
+    if (files.empty()) {
+        return;
     }
+    pod5_init();
 
-    cxxpool::thread_pool pool{m_num_worker_threads};
-
-    for (std::size_t batch_index = 0; batch_index < batch_count; ++batch_index) {
-        if (m_loaded_read_count == m_max_reads) {
-            break;
-        }
-        Pod5ReadRecordBatch_t* batch = nullptr;
-        if (pod5_get_read_batch(&batch, file, batch_index) != POD5_OK) {
-            spdlog::error("Failed to get batch: {}", pod5_get_error_string());
+    // Opening files and fetching batches mostly wait on storage, so they get their own
+    // threads, and the decompression threads are kept busy meanwhile.  Everything is
+    // consumed in submission order, so reads still come out in file order.
+    cxxpool::thread_pool io_pool{m_prefetch_files + m_prefetch_batches};
+    cxxpool::thread_pool decode_pool{m_num_worker_threads};
+
+    // Each file is opened and its traversal planned ahead.
+    using PlannedFile = std::pair<Pod5FilePtr, std::vector<Pod5BatchRows>>;
+    std::deque<std::pair<std::string, std::future<PlannedFile>>> files_ahead;
+    std::size_t next_file = 0;
+    auto top_up_files = [&] {
+        while (next_file < files.size() && files_ahead.size() < m_prefetch_files) {
+            const auto& file_reads = files[next_file++];
+            auto file = io_pool.push([this, &file_reads] {
+                PlannedFile planned_file{open_pod5_file(file_reads.path), {}};
+                if (planned_file.first) {
+                    planned_file.second =
+                            plan_pod5_batches(planned_file.first, file_reads.read_ids);
+                }
+                return planned_file;
+            });
+            files_ahead.emplace_back(file_reads.path, std::move(file));
         }
+        m_num_files_ahead = files_ahead.size();
+    };
 
-        std::size_t batch_row_count = 0;
-        if (pod5_get_read_batch_row_count(&batch_row_count, batch) != POD5_OK) {
-            spdlog::error("Failed to get batch row count");
+    // Enough reads in progress to keep every decompression thread busy while the oldest
+    // is waiting to be pushed on.
+    const std::size_t max_reads_in_progress = 4 * m_num_worker_threads;
+    std::deque<std::future<std::shared_ptr<Read>>> reads_in_progress;
+    auto push_completed_reads = [&](std::size_t max_remaining) {
+        while (reads_in_progress.size() > max_remaining) {
+            auto read = reads_in_progress.front().get();
+            reads_in_progress.pop_front();
+            m_num_reads_in_progress = reads_in_progress.size();
+            push_read(std::move(read));
         }
-        batch_row_count = std::min(batch_row_count, m_max_reads - m_loaded_read_count);
-
-        std::vector<std::future<std::shared_ptr<Read>>> futures;
+    };
 
-        for (std::size_t row = 0; row < batch_row_count; ++row) {
-            // TODO - check the read ID here, for each one, only send the row if it is in the list of ones we care about
+    std::size_t num_submitted_reads = m_loaded_read_count;
+    top_up_files();
+    while (!files_ahead.empty() && num_submitted_reads < m_max_reads) {
+        const std::string path = std::move(files_ahead.front().first);
+        const PlannedFile planned_file = files_ahead.front().second.get();
+        const Pod5FilePtr& file = planned_file.first;
+        const std::vector<Pod5BatchRows>& batch_plan = planned_file.second;
+        files_ahead.pop_front();
+        top_up_files();
+        if (!file) {
+            continue;
+        }
 
-            uint16_t read_table_version = 0;
-            ReadBatchRowInfo_t read_data;
-            if (pod5_get_read_batch_row_info_data(batch, row, READ_BATCH_ROW_INFO_VERSION,
-                                                  &read_data, &read_table_version) != POD5_OK) {
-                spdlog::error("Failed to get read {}", row);
+        // Only batches with wanted reads are fetched.
+        std::deque<std::pair<const Pod5BatchRows*, std::future<Pod5BatchPtr>>> batches_ahead;
+        std::size_t next_batch = 0;
+        auto top_up_batches = [&] {
+            while (next_batch < batch_plan.size() && batches_ahead.size() < m_prefetch_batches) {
+                const auto& batch_rows = batch_plan[next_batch++];
+                batches_ahead.emplace_back(
+                        &batch_rows, io_pool.push([this, file, index = batch_rows.batch_index] {
+                            return fetch_pod5_batch(file, index);
+                        }));
             }
-
-            char read_id_tmp[37];
-            pod5_error_t err = pod5_format_read_id(read_data.read_id, read_id_tmp);
-            std::string read_id_str(read_id_tmp);
-            bool read_in_ignore_list =
-                    m_ignored_read_ids.find(read_id_str) != m_ignored_read_ids.end();
-            bool read_in_read_list =
-                    !m_allowed_read_ids ||
-                    (m_allowed_read_ids->find(read_id_str) != m_allowed_read_ids->end());
-            if (!read_in_ignore_list && read_in_read_list) {
-                futures.push_back(pool.push(process_pod5_read, row, batch, file, path, m_device));
+            m_num_batches_ahead = batches_ahead.size();
+        };
+
+        top_up_batches();
+        while (!batches_ahead.empty() && num_submitted_reads < m_max_reads) {
+            const Pod5BatchRows& batch_rows = *batches_ahead.front().first;
+            const Pod5BatchPtr batch = batches_ahead.front().second.get();
+            batches_ahead.pop_front();
+            top_up_batches();
+            if (!batch) {
+                continue;
             }
-        }
 
-        for (auto& v : futures) {
-            auto read = v.get();
-            m_read_sink.push_message(read);
-            m_loaded_read_count++;
-        }
+            std::vector<uint32_t> rows;
+            if (batch_rows.rows) {
+                rows = *batch_rows.rows;
+            } else {
+                std::size_t batch_row_count = 0;
+                if (pod5_get_read_batch_row_count(&batch_row_count, batch.get()) != POD5_OK) {
+                    spdlog::error("Failed to get batch row count");
+                }
+                for (std::size_t row = 0; row < batch_row_count; ++row) {
+                    if (filters_reads()) {
+                        // Reads to filter without a plan, e.g. for a file the catalog
+                        // couldn't read, so each row is checked.
+                        uint16_t read_table_version = 0;
+                        ReadBatchRowInfo_t read_data;
+                        if (pod5_get_read_batch_row_info_data(batch.get(), row,
+                                                              READ_BATCH_ROW_INFO_VERSION,
+                                                              &read_data,
+                                                              &read_table_version) != POD5_OK) {
+                            spdlog::error("Failed to get read {}", row);
+                            continue;
+                        }
+                        if (!is_read_wanted(*reinterpret_cast<const ReadID*>(read_data.read_id),
+                                            read_data.channel)) {
+                            continue;
+                        }
+                    }
+                    rows.push_back(static_cast<uint32_t>(row));
+                }
+            }
 
-        if (pod5_free_read_batch(batch) != POD5_OK) {
-            spdlog::error("Failed to release batch");
+            for (std::size_t i = 0; i < rows.size() && num_submitted_reads < m_max_reads; ++i) {
+                const std::size_t row = rows[i];
+                // The task holds on to the batch and file until the read is decompressed.
+                reads_in_progress.push_back(decode_pool.push([this, row, batch, file, path] {
+                    return process_pod5_read(row, batch.get(), file.get(), path, m_device);
+                }));
+                ++num_submitted_reads;
+                m_num_reads_in_progress = reads_in_progress.size();
+                push_completed_reads(max_reads_in_progress);
+            }
         }
     }
-    if (pod5_close_and_free_reader(file) != POD5_OK) {
-        spdlog::error("Failed to close and free POD5 reader");
-    }
+    push_completed_reads(0);
+    m_num_files_ahead = 0;
+    m_num_batches_ahead = 0;
 }
 
 void DataLoader::load_fast5_reads_from_file(const std::string& path) {
@@ -762,12 +991,23 @@ void DataLoader::load_fast5_reads_from_file(const std::string& path) {
 
         if (!m_allowed_read_ids ||
             (m_allowed_read_ids->find(new_read->read_id) != m_allowed_read_ids->end())) {
-            m_read_sink.push_message(new_read);
-            m_loaded_read_count++;
+            push_read(std::move(new_read));
         }
     }
 }
 
+void DataLoader::push_read(std::shared_ptr<Read> read) {
+    // Blocks while too much is in flight.  The charge goes with the read, so is released
+    // wherever it finishes up.
+    const auto raw_bytes = read->raw_data.numel() * read->raw_data.element_size();
+    read->memory_charge = utils::MemoryBudget::global().acquire(raw_bytes);
+    m_loaded_bytes += raw_bytes;
+    // Reads are pushed from a single thread, so this numbers them in input file order.
+    read->sequence_number = m_loaded_read_count;
+    m_read_sink.push_message(std::move(read));
+    m_loaded_read_count++;
+}
+
 DataLoader::DataLoader(MessageSink& read_sink,
                        const std::string& device,
                        size_t num_worker_threads,
@@ -781,11 +1021,56 @@ DataLoader::DataLoader(MessageSink& read_sink,
           m_ignored_read_ids(std::move(read_ignore_list)) {
     m_max_reads = max_reads == 0 ? std::numeric_limits<decltype(m_max_reads)>::max() : max_reads;
     assert(m_num_worker_threads > 0);
+    if (m_allowed_read_ids) {
+        m_allowed_pod5_read_ids.emplace();
+        for (const auto& read_id : *m_allowed_read_ids) {
+            if (auto parsed = parse_read_id(read_id)) {
+                m_allowed_pod5_read_ids->insert(*parsed);
+            }
+        }
+    }
+    for (const auto& read_id : m_ignored_read_ids) {
+        if (auto parsed = parse_read_id(read_id)) {
+            m_ignored_pod5_read_ids.insert(*parsed);
+        }
+    }
     static std::once_flag vbz_init_flag;
     std::call_once(vbz_init_flag, vbz_register);
 }
 
+DataLoader::~DataLoader() = default;
+
+void DataLoader::set_prefetch_depth(size_t max_files_ahead, size_t max_batches_ahead) {
+    m_prefetch_files = std::max<size_t>(max_files_ahead, 1);
+    m_prefetch_batches = std::max<size_t>(max_batches_ahead, 1);
+}
+
+void DataLoader::set_max_buffered_bytes(uint64_t max_buffered_bytes) {
+    m_max_buffered_bytes = max_buffered_bytes;
+}
+
 stats::NamedStats DataLoader::sample_stats() const {
-    return stats::NamedStats{{"loaded_read_count", static_cast<double>(m_loaded_read_count)}};
+    stats::NamedStats stats;
+    stats["loaded_read_count"] = static_cast<double>(m_loaded_read_count);
+    stats["files_ahead"] = static_cast<double>(m_num_files_ahead);
+    stats["batches_ahead"] = static_cast<double>(m_num_batches_ahead);
+    stats["reads_in_progress"] = static_cast<double>(m_num_reads_in_progress);
+    const auto loaded_bytes = m_loaded_bytes.load();
+    stats["loaded_bytes"] = static_cast<double>(loaded_bytes);
+    stats["pod5_files_opened"] = static_cast<double>(m_num_files_opened);
+    stats["pod5_batches_fetched"] = static_cast<double>(m_num_batches_fetched);
+    stats["pod5_files_skipped"] = static_cast<double>(m_num_files_skipped);
+    stats["pod5_reads_spilled"] = static_cast<double>(m_num_reads_spilled);
+    const auto load_start_ns = m_load_start_ns.load();
+    if (load_start_ns != 0) {
+        const auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now().time_since_epoch())
+                                    .count();
+        if (now_ns > load_start_ns) {
+            stats["loaded_bytes_per_s"] =
+                    static_cast<double>(loaded_bytes) / ((now_ns - load_start_ns) / 1e9);
+        }
+    }
+    return stats;
 }
 }  // namespace dorado
@@ -2,7 +2,8 @@
 #include "utils/stats.h"
 
 #include <array>
-#include <map>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -11,20 +12,45 @@
 #include <vector>
 
 struct Pod5FileReader;
+struct Pod5ReadRecordBatch;
 
 namespace dorado {
 
+class DatasetShard;
+class DirectoryWatcher;
 class MessageSink;
+class Read;
+struct CatalogFile;
 struct ReadGroup;
 
 constexpr size_t POD5_READ_ID_SIZE = 16;
 using ReadID = std::array<uint8_t, POD5_READ_ID_SIZE>;
-typedef std::map<int, std::vector<ReadID>> channel_to_read_id_t;
+
+struct ReadIDHash {
+    size_t operator()(const ReadID& read_id) const;
+};
+using ReadIDSet = std::unordered_set<ReadID, ReadIDHash>;
+
+// Parses a read id in its usual UUID string form, returning nothing if it isn't one.
+std::optional<ReadID> parse_read_id(const std::string& read_id);
 
 struct Pod5Destructor {
     void operator()(Pod5FileReader*);
 };
 using Pod5Ptr = std::unique_ptr<Pod5FileReader, Pod5Destructor>;
+using Pod5FilePtr = std::shared_ptr<Pod5FileReader>;
+using Pod5BatchPtr = std::shared_ptr<Pod5ReadRecordBatch>;
+
+// Which part of a dataset to load, when it is split between several processes, e.g. one
+// per host.  Shards are numbered from 0.
+struct InputShard {
+    size_t index{0};
+    size_t count{1};
+    // Split by channel, so that reads from the same channel, e.g. duplex pairs, stay together.
+    bool by_channel{false};
+
+    bool is_sharded() const { return count > 1; }
+};
 
 class DataLoader {
 public:
@@ -39,10 +65,12 @@ public:
                size_t max_reads = 0,
                std::optional<std::unordered_set<std::string>> read_list = std::nullopt,
                std::unordered_set<std::string> read_ignore_list = {});
-    ~DataLoader() = default;
+    ~DataLoader();
     void load_reads(const std::string& path,
                     bool recursive_file_loading = false,
                     ReadOrder traversal_order = UNRESTRICTED);
+    // Loads POD5 files as the watcher finds them, until it stops.
+    void load_reads(DirectoryWatcher& watcher);
 
     static std::unordered_map<std::string, ReadGroup> load_read_groups(
             std::string data_path,
@@ -53,19 +81,60 @@ public:
             std::string data_path,
             std::optional<std::unordered_set<std::string>> read_list = std::nullopt,
             const std::unordered_set<std::string>& ignore_read_list = {},
-            bool recursive_file_loading = false);
+            bool recursive_file_loading = false,
+            const InputShard& shard = {});
 
     static uint16_t get_sample_rate(std::string data_path, bool recursive_file_loading = false);
 
+    // How far ahead the POD5 loader reads: the number of files opened ahead of the one being
+    // loaded, and of record batches fetched ahead of the one being decompressed.
+    void set_prefetch_depth(size_t max_files_ahead, size_t max_batches_ahead);
+    // How many bytes of signal loading by channel holds in memory for reads decoded ahead
+    // of their turn to be sent on.  Reads beyond this wait in a temporary spill file.
+    void set_max_buffered_bytes(uint64_t max_buffered_bytes);
+    // Loads only one shard of the dataset.  Loading by channel always shards by channel.
+    void set_shard(const InputShard& shard) { m_shard = shard; }
+
     std::string get_name() const { return "Dataloader"; }
     stats::NamedStats sample_stats() const;
 
 private:
+    // A POD5 file to load, and the reads to load from it if not all of them.
+    struct Pod5FileReads {
+        std::string path;
+        std::optional<std::vector<ReadID>> read_ids;
+    };
+    // The rows to load from a record batch, or every row if rows is unset.
+    struct Pod5BatchRows {
+        size_t batch_index;
+        std::optional<std::vector<uint32_t>> rows;
+    };
+
     void load_fast5_reads_from_file(const std::string& path);
-    void load_pod5_reads_from_file(const std::string& path);
-    void load_pod5_reads_from_file_by_read_ids(const std::string& path,
-                                               const std::vector<ReadID>& read_ids);
-    void load_read_channels(std::string data_path, bool recursive_file_loading = false);
+    // Loads the files in order, opening files and fetching batches ahead while earlier reads
+    // are decompressed.
+    void load_pod5_reads_from_files(const std::vector<Pod5FileReads>& files);
+    // Loads the reads of the catalogued files in order of channel, then start time.
+    void load_pod5_reads_by_channel(const std::vector<const CatalogFile*>& files);
+    // Return null on failure, having logged why.
+    Pod5FilePtr open_pod5_file(const std::string& path);
+    Pod5BatchPtr fetch_pod5_batch(const Pod5FilePtr& file, size_t batch_index);
+    // Which batches of the file to fetch, and which of their rows to load.
+    std::vector<Pod5BatchRows> plan_pod5_batches(
+            const Pod5FilePtr& file,
+            const std::optional<std::vector<ReadID>>& read_ids);
+    // The reads of a catalogued file that the read lists and shard allow, or nothing if
+    // every read is wanted or the file's reads aren't known.
+    std::optional<std::vector<ReadID>> select_pod5_reads(const CatalogFile& file) const;
+    bool has_read_lists() const {
+        return m_allowed_pod5_read_ids || !m_ignored_pod5_read_ids.empty();
+    }
+    // Whether some reads of a file may not be wanted.
+    bool filters_reads() const;
+    // Whether the read lists and shard allow the read to be loaded.
+    bool is_read_wanted(const ReadID& read_id, uint16_t channel) const;
+    // Charges the read to the in-flight memory budget and sends it on.
+    void push_read(std::shared_ptr<Read> read);
     MessageSink& m_read_sink;  // Where should the loaded reads go?
     std::atomic<size_t> m_loaded_read_count{0};
     std::string m_device;
@@ -73,9 +142,27 @@ private:
     size_t m_max_reads{0};
     std::optional<std::unordered_set<std::string>> m_allowed_read_ids;
     std::unordered_set<std::string> m_ignored_read_ids;
+    // The read lists in binary form, so POD5 read ids can be checked without formatting them.
+    // Entries which aren't valid read ids can't match any POD5 read, so are left out.
+    std::optional<ReadIDSet> m_allowed_pod5_read_ids;
+    ReadIDSet m_ignored_pod5_read_ids;
+    InputShard m_shard;
+    std::unique_ptr<DatasetShard> m_dataset_shard;  // Set while loading a sharded dataset.
+
+    size_t m_prefetch_files{2};
+    size_t m_prefetch_batches{2};
+    uint64_t m_max_buffered_bytes{uint64_t(1) << 30};
 
-    std::unordered_map<std::string, channel_to_read_id_t> m_file_channel_read_order_map;
-    int m_max_channel{0};
+    // Loader queue depths and throughput, for stats.
+    std::atomic<size_t> m_num_files_ahead{0};
+    std::atomic<size_t> m_num_batches_ahead{0};
+    std::atomic<size_t> m_num_reads_in_progress{0};
+    std::atomic<uint64_t> m_loaded_bytes{0};
+    std::atomic<size_t> m_num_files_opened{0};
+    std::atomic<size_t> m_num_batches_fetched{0};
+    std::atomic<size_t> m_num_files_skipped{0};  // Files with none of the listed reads.
+    std::atomic<size_t> m_num_reads_spilled{0};
+    std::atomic<int64_t> m_load_start_ns{0};  // steady_clock, 0 until loading starts.
 };
 
 }  // namespace dorado
@@ -0,0 +1,426 @@
+#include "DatasetCatalog.h"
+
+#include "cxxpool.h"
+#include "pod5_format/c_api.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+constexpr char kPod5Signature[8] = {'\x8b', 'P', 'O', 'D', '\r', '\n', '\x1a', '\n'};
+constexpr char kIndexMagic[8] = {'D', 'O', 'R', 'A', 'D', 'O', 'D', 'I'};
+constexpr uint32_t kIndexVersion = 2;
+constexpr uint32_t kMaxIndexStringSize = 1 << 16;
+// The fewest bytes an index can use for a file entry and for a run info, with empty strings.
+constexpr uint64_t kMinIndexEntrySize = 4 + 8 + 8 + 4 + 8 + 4;
+constexpr uint64_t kMinIndexRunInfoSize = 4 * 4 + 8 + 2;
+// Scanning is mostly waiting on storage, so use plenty of threads, but not so many that a
+// network filesystem is swamped.
+constexpr size_t kMaxScanThreads = 16;
+
+std::atomic<bool> s_use_index{false};
+
+std::string lower_case_extension(const std::filesystem::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return ext;
+}
+
+template <typename T>
+void write_value(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T read_value(std::istream& in) {
+    T value{};
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+}
+
+void write_string(std::ostream& out, const std::string& str) {
+    write_value<uint32_t>(out, static_cast<uint32_t>(str.size()));
+    out.write(str.data(), str.size());
+}
+
+std::string read_string(std::istream& in) {
+    const auto size = read_value<uint32_t>(in);
+    if (size > kMaxIndexStringSize) {
+        // Corrupt, and not worth allocating for.
+        in.setstate(std::ios::failbit);
+        return {};
+    }
+    std::string str(size, '\0');
+    in.read(str.data(), str.size());
+    return str;
+}
+
+// Reads a count of items taking at least item_size bytes each, failing the stream if there
+// aren't that many bytes left in an index of index_size bytes.
+template <typename T>
+uint64_t read_count(std::istream& in, uint64_t index_size, uint64_t item_size) {
+    const uint64_t count = read_value<T>(in);
+    const auto position = in.tellg();
+    if (!in || position < 0 || static_cast<uint64_t>(position) > index_size ||
+        count > (index_size - static_cast<uint64_t>(position)) / item_size) {
+        in.setstate(std::ios::failbit);
+        return 0;
+    }
+    return count;
+}
+
+// Fills in the POD5 metadata of file, setting scanned if it could all be read.
+void scan_pod5_file(dorado::CatalogFile& file) {
+    if (!dorado::is_complete_pod5_file(file.path)) {
+        // Most likely still being written, so it will be scanned when it's next needed.
+        spdlog::debug("Skipping incomplete POD5 file {}", file.path);
+        return;
+    }
+    Pod5FileReader_t* reader = pod5_open_file(file.path.c_str());
+    if (!reader) {
+        spdlog::error("Failed to open file {}: {}", file.path, pod5_get_error_string());
+        return;
+    }
+
+    bool ok = true;
+    run_info_index_t run_info_count = 0;
+    if (pod5_get_file_run_info_count(reader, &run_info_count) != POD5_OK) {
+        spdlog::error("Failed to fetch POD5 run info count for file {} : {}", file.path,
+                      pod5_get_error_string());
+        ok = false;
+    }
+    for (run_info_index_t idx = 0; idx < run_info_count; idx++) {
+        RunInfoDictData_t* run_info_data;
+        if (pod5_get_file_run_info(reader, idx, &run_info_data) != POD5_OK) {
+            spdlog::error("Failed to fetch POD5 run info dict for file {} and run info index {}: "
+                          "{}",
+                          file.path, idx, pod5_get_error_string());
+            ok = false;
+            continue;
+        }
+        file.run_infos.push_back(dorado::CatalogRunInfo{
+                run_info_data->acquisition_id, run_info_data->flow_cell_id,
+                run_info_data->system_name, run_info_data->sample_id,
+                run_info_data->acquisition_start_time_ms, run_info_data->sample_rate});
+        if (pod5_free_run_info(run_info_data) != POD5_OK) {
+            spdlog::error("Failed to free run info");
+        }
+    }
+
+    std::size_t batch_count = 0;
+    if (pod5_get_read_batch_count(&batch_count, reader) != POD5_OK) {
+        spdlog::error("Failed to query batch count: {}", pod5_get_error_string());
+        ok = false;
+    }
+    for (std::size_t batch_index = 0; batch_index < batch_count; ++batch_index) {
+        Pod5ReadRecordBatch_t* batch = nullptr;
+        if (pod5_get_read_batch(&batch, reader, batch_index) != POD5_OK) {
+            spdlog::error("Failed to get batch: {}", pod5_get_error_string());
+            ok = false;
+            continue;
+        }
+
+        std::size_t batch_row_count = 0;
+        if (pod5_get_read_batch_row_count(&batch_row_count, batch) != POD5_OK) {
+            spdlog::error("Failed to get batch row count");
+            ok = false;
+        }
+        file.batch_num_rows.push_back(static_cast<uint32_t>(batch_row_count));
+        for (std::size_t row = 0; row < batch_row_count; ++row) {
+            uint16_t read_table_version = 0;
+            ReadBatchRowInfo_t read_data;
+            if (pod5_get_read_batch_row_info_data(batch, row, READ_BATCH_ROW_INFO_VERSION,
+                                                  &read_data, &read_table_version) != POD5_OK) {
+                spdlog::error("Failed to get read {}", row);
+                ok = false;
+                continue;
+            }
+            dorado::ReadID read_id;
+            std::memcpy(read_id.data(), read_data.read_id, dorado::POD5_READ_ID_SIZE);
+            file.read_ids.push_back(read_id);
+            file.channels.push_back(read_data.channel);
+            file.start_samples.push_back(read_data.start_sample);
+        }
+
+        if (pod5_free_read_batch(batch) != POD5_OK) {
+            spdlog::error("Failed to release batch");
+        }
+    }
+
+    if (pod5_close_and_free_reader(reader) != POD5_OK) {
+        spdlog::error("Failed to close and free POD5 reader");
+    }
+    file.scanned = ok;
+}
+
+}  // namespace
+
+namespace dorado {
+
+DatasetCatalog::DatasetCatalog(const std::string& data_path,
+                               bool recursive_file_loading,
+                               bool use_index)
+        : m_data_path(data_path) {
+    auto iterate_directory = [&](const auto& iterator_fn) {
+        for (const auto& entry : iterator_fn(data_path)) {
+            const auto ext = lower_case_extension(entry.path());
+            if (ext != ".pod5" && ext != ".fast5") {
+                continue;
+            }
+            CatalogFile file;
+            file.path = entry.path().string();
+            file.relative_path = entry.path().lexically_relative(data_path).generic_string();
+            file.is_pod5 = ext == ".pod5";
+            std::error_code ec;
+            file.size = std::filesystem::file_size(entry.path(), ec);
+            file.mtime = std::filesystem::last_write_time(entry.path(), ec)
+                                 .time_since_epoch()
+                                 .count();
+            m_files.push_back(std::move(file));
+        }
+    };
+
+    if (recursive_file_loading) {
+        iterate_directory([](const auto& path) {
+            return std::filesystem::recursive_directory_iterator(path);
+        });
+    } else {
+        iterate_directory(
+                [](const auto& path) { return std::filesystem::directory_iterator(path); });
+    }
+
+    std::optional<std::vector<CatalogFile>> index;
+    if (use_index) {
+        index = load_index();
+    }
+    if (index) {
+        std::unordered_map<std::string, CatalogFile*> index_entries;
+        for (auto& entry : *index) {
+            index_entries.emplace(entry.relative_path, &entry);
+        }
+        for (auto& file : m_files) {
+            auto it = index_entries.find(file.relative_path);
+            if (!file.is_pod5 || it == index_entries.end() || it->second->size != file.size ||
+                it->second->mtime != file.mtime) {
+                continue;
+            }
+            file.run_infos = std::move(it->second->run_infos);
+            file.read_ids = std::move(it->second->read_ids);
+            file.channels = std::move(it->second->channels);
+            file.start_samples = std::move(it->second->start_samples);
+            file.batch_num_rows = std::move(it->second->batch_num_rows);
+            file.scanned = true;
+            ++m_num_reused_entries;
+        }
+    }
+
+    std::vector<CatalogFile*> files_to_scan;
+    for (auto& file : m_files) {
+        if (file.is_pod5 && !file.scanned) {
+            files_to_scan.push_back(&file);
+        }
+    }
+    if (!files_to_scan.empty()) {
+        pod5_init();
+        const size_t num_threads = std::min(
+                {kMaxScanThreads, files_to_scan.size(),
+                 static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1u))});
+        cxxpool::thread_pool pool{num_threads};
+        std::vector<std::future<void>> futures;
+        for (auto file : files_to_scan) {
+            futures.push_back(pool.push([file] { scan_pod5_file(*file); }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+    }
+
+    const bool index_stale = !index || !files_to_scan.empty() ||
+                             m_num_reused_entries != index->size();
+    if (use_index && index_stale && !save_index()) {
+        spdlog::debug("Couldn't write dataset index to {}", m_data_path);
+    }
+}
+
+bool is_complete_pod5_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char signature[sizeof(kPod5Signature)];
+    if (!in.read(signature, sizeof(signature)) ||
+        std::memcmp(signature, kPod5Signature, sizeof(signature)) != 0) {
+        return false;
+    }
+    if (!in.seekg(-static_cast<std::streamoff>(sizeof(signature)), std::ios::end) ||
+        in.tellg() < static_cast<std::streamoff>(sizeof(signature)) ||
+        !in.read(signature, sizeof(signature))) {
+        return false;
+    }
+    return std::memcmp(signature, kPod5Signature, sizeof(signature)) == 0;
+}
+
+std::shared_ptr<const DatasetCatalog> DatasetCatalog::get(const std::string& data_path,
+                                                          bool recursive_file_loading) {
+    static std::mutex catalogs_mutex;
+    static std::map<std::pair<std::string, bool>, std::shared_ptr<const DatasetCatalog>>
+            catalogs;
+
+    std::lock_guard lock(catalogs_mutex);
+    auto& catalog = catalogs[{data_path, recursive_file_loading}];
+    if (!catalog) {
+        catalog = std::make_shared<const DatasetCatalog>(data_path, recursive_file_loading,
+                                                         s_use_index.load());
+    }
+    return catalog;
+}
+
+void DatasetCatalog::set_use_index(bool use_index) { s_use_index = use_index; }
+
+size_t DatasetCatalog::num_pod5_reads() const {
+    size_t num_reads = 0;
+    for (const auto& file : m_files) {
+        num_reads += file.num_reads();
+    }
+    return num_reads;
+}
+
+bool DatasetCatalog::save_index() const {
+    const auto index_path = std::filesystem::path(m_data_path) / kIndexFileName;
+    // Written alongside and renamed into place, so a concurrent run never sees half an index.
+    auto temp_path = index_path;
+    temp_path += ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(kIndexMagic, sizeof(kIndexMagic));
+        write_value(out, kIndexVersion);
+
+        const auto num_entries = std::count_if(m_files.begin(), m_files.end(),
+                                               [](auto& file) { return file.scanned; });
+        write_value<uint64_t>(out, num_entries);
+        for (const auto& file : m_files) {
+            if (!file.scanned) {
+                continue;
+            }
+            write_string(out, file.relative_path);
+            write_value(out, file.size);
+            write_value(out, file.mtime);
+            write_value<uint32_t>(out, static_cast<uint32_t>(file.run_infos.size()));
+            for (const auto& run_info : file.run_infos) {
+                write_string(out, run_info.run_id);
+                write_string(out, run_info.flowcell_id);
+                write_string(out, run_info.device_id);
+                write_string(out, run_info.sample_id);
+                write_value(out, run_info.acquisition_start_time_ms);
+                write_value(out, run_info.sample_rate);
+            }
+            write_value<uint64_t>(out, file.read_ids.size());
+            out.write(reinterpret_cast<const char*>(file.read_ids.data()),
+                      file.read_ids.size() * sizeof(ReadID));
+            out.write(reinterpret_cast<const char*>(file.channels.data()),
+                      file.channels.size() * sizeof(uint16_t));
+            out.write(reinterpret_cast<const char*>(file.start_samples.data()),
+                      file.start_samples.size() * sizeof(uint64_t));
+            write_value<uint32_t>(out, static_cast<uint32_t>(file.batch_num_rows.size()));
+            out.write(reinterpret_cast<const char*>(file.batch_num_rows.data()),
+                      file.batch_num_rows.size() * sizeof(uint32_t));
+        }
+        if (!out) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, index_path, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::vector<CatalogFile>> DatasetCatalog::load_index() const {
+    const auto index_path = std::filesystem::path(m_data_path) / kIndexFileName;
+    std::ifstream in(index_path, std::ios::binary);
+    if (!in) {
+        return std::nullopt;
+    }
+
+    char magic[sizeof(kIndexMagic)];
+    in.read(magic, sizeof(magic));
+    if (!in || std::memcmp(magic, kIndexMagic, sizeof(magic)) != 0 ||
+        read_value<uint32_t>(in) != kIndexVersion) {
+        spdlog::debug("Ignoring unrecognised dataset index {}", index_path.string());
+        return std::nullopt;
+    }
+
+    // Counts are checked against the bytes left in the index before anything is allocated
+    // for them, so a corrupt index is ignored rather than exhausting memory.
+    std::error_code ec;
+    const auto index_size = std::filesystem::file_size(index_path, ec);
+    const auto num_entries = read_count<uint64_t>(in, index_size, kMinIndexEntrySize);
+    if (!in || ec) {
+        spdlog::debug("Ignoring truncated dataset index {}", index_path.string());
+        return std::nullopt;
+    }
+    std::vector<CatalogFile> entries(num_entries);
+    for (auto& entry : entries) {
+        if (!in) {
+            break;
+        }
+        entry.relative_path = read_string(in);
+        entry.size = read_value<uint64_t>(in);
+        entry.mtime = read_value<int64_t>(in);
+        entry.is_pod5 = true;
+        entry.run_infos.resize(read_count<uint32_t>(in, index_size, kMinIndexRunInfoSize));
+        for (auto& run_info : entry.run_infos) {
+            run_info.run_id = read_string(in);
+            run_info.flowcell_id = read_string(in);
+            run_info.device_id = read_string(in);
+            run_info.sample_id = read_string(in);
+            run_info.acquisition_start_time_ms = read_value<int64_t>(in);
+            run_info.sample_rate = read_value<uint16_t>(in);
+        }
+        const auto num_reads = read_count<uint64_t>(
+                in, index_size, sizeof(ReadID) + sizeof(uint16_t) + sizeof(uint64_t));
+        if (!in) {
+            break;
+        }
+        entry.read_ids.resize(num_reads);
+        entry.channels.resize(num_reads);
+        entry.start_samples.resize(num_reads);
+        in.read(reinterpret_cast<char*>(entry.read_ids.data()), num_reads * sizeof(ReadID));
+        in.read(reinterpret_cast<char*>(entry.channels.data()), num_reads * sizeof(uint16_t));
+        in.read(reinterpret_cast<char*>(entry.start_samples.data()),
+                num_reads * sizeof(uint64_t));
+        entry.batch_num_rows.resize(read_count<uint32_t>(in, index_size, sizeof(uint32_t)));
+        in.read(reinterpret_cast<char*>(entry.batch_num_rows.data()),
+                entry.batch_num_rows.size() * sizeof(uint32_t));
+        if (std::accumulate(entry.batch_num_rows.begin(), entry.batch_num_rows.end(),
+                            uint64_t(0)) != num_reads) {
+            in.setstate(std::ios::failbit);
+        }
+    }
+    if (!in) {
+        spdlog::debug("Ignoring truncated dataset index {}", index_path.string());
+        return std::nullopt;
+    }
+    return entries;
+}
+
+}  // namespace dorado
@@ -0,0 +1,90 @@
+#pragma once
+#include "DataLoader.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dorado {
+
+// Run info from a POD5 file, as needed for read groups and sample rate checks.
+struct CatalogRunInfo {
+    std::string run_id;
+    std::string flowcell_id;
+    std::string device_id;
+    std::string sample_id;
+    int64_t acquisition_start_time_ms{0};
+    uint16_t sample_rate{0};
+};
+
+// What the catalog knows about one input file.  FAST5 files are listed, so that the
+// order of files is kept, but aren't opened.
+struct CatalogFile {
+    std::string path;           // As found by walking the data directory.
+    std::string relative_path;  // Relative to the data directory, the key in the index.
+    uint64_t size{0};
+    int64_t mtime{0};
+    bool is_pod5{false};
+    // False if the file couldn't be read, so it will be scanned again next time.
+    bool scanned{false};
+
+    // POD5 only.
+    std::vector<CatalogRunInfo> run_infos;
+    std::vector<ReadID> read_ids;
+    std::vector<uint16_t> channels;  // Channel of each read in read_ids.
+    std::vector<uint64_t> start_samples;  // Start sample of each read in read_ids.
+    // Number of rows in each record batch.  Reads are listed in file order, so the batch
+    // and row of each read follow from these.
+    std::vector<uint32_t> batch_num_rows;
+
+    size_t num_reads() const { return read_ids.size(); }
+};
+
+// Whether path is a POD5 file which has been completely written, going by the signature at
+// the start of the file being repeated at the end, as the last part of the footer.
+bool is_complete_pod5_file(const std::string& path);
+
+// Metadata for every POD5 file in a dataset, gathered in a single parallel pass so that
+// startup doesn't open every file once for each thing it needs to know.
+// The catalog can be saved in the data directory as a sidecar index, and entries from the
+// index are reused for files whose size and modification time haven't changed.
+class DatasetCatalog {
+public:
+    // Name of the sidecar index, in the top level of the data directory.
+    static constexpr const char* kIndexFileName = ".dorado_dataset_index";
+
+    // Walks data_path and scans its POD5 files.  If use_index is set, entries from the index
+    // are reused where still valid, and the index is rewritten if anything had to be scanned.
+    DatasetCatalog(const std::string& data_path, bool recursive_file_loading, bool use_index);
+
+    // The catalog of data_path, built on first use and shared thereafter, so that the
+    // directory is only walked once per process.
+    static std::shared_ptr<const DatasetCatalog> get(const std::string& data_path,
+                                                     bool recursive_file_loading);
+
+    // Whether get() reads and writes the sidecar index.  Off by default, so that
+    // library users don't find files appearing in their data directories.
+    static void set_use_index(bool use_index);
+
+    // Files in directory walk order.
+    const std::vector<CatalogFile>& files() const { return m_files; }
+    size_t num_pod5_reads() const;
+    // Number of files whose entries came from the index rather than a scan.
+    size_t num_reused_entries() const { return m_num_reused_entries; }
+
+    // Writes the index, returning false if it couldn't be written.
+    bool save_index() const;
+
+private:
+    // Reads entries from the index, keyed by relative path.  Returns nothing if there is no
+    // usable index.
+    std::optional<std::vector<CatalogFile>> load_index() const;
+
+    std::string m_data_path;
+    std::vector<CatalogFile> m_files;
+    size_t m_num_reused_entries{0};
+};
+
+}  // namespace dorado
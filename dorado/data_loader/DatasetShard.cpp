@@ -0,0 +1,91 @@
+#include "DatasetShard.h"
+
+#include "DatasetCatalog.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// FNV-1a, rather than std::hash, so that every platform puts a read in the same shard.
+uint64_t stable_hash(const dorado::ReadID& read_id) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const uint8_t byte : read_id) {
+        hash = (hash ^ byte) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+}  // namespace
+
+namespace dorado {
+
+DatasetShard::DatasetShard(const DatasetCatalog& catalog, const InputShard& shard)
+        : m_shard(shard) {
+    if (m_shard.count == 0 || m_shard.index >= m_shard.count) {
+        throw std::runtime_error("Invalid shard " + std::to_string(m_shard.index) + "/" +
+                                 std::to_string(m_shard.count));
+    }
+
+    // Files are dealt out in order of their path within the dataset, so that where the
+    // dataset is mounted, and the order the directory is walked in, don't matter.
+    std::vector<const CatalogFile*> pod5_files, fast5_files;
+    for (const auto& file : catalog.files()) {
+        (file.is_pod5 ? pod5_files : fast5_files).push_back(&file);
+    }
+
+    if (m_shard.by_channel) {
+        m_mode = Mode::CHANNELS;
+    } else if (pod5_files.size() >= kMinFilesPerShard * m_shard.count) {
+        m_mode = Mode::FILES;
+    } else {
+        m_mode = Mode::READ_IDS;
+    }
+
+    auto deal_files = [this](std::vector<const CatalogFile*>& files) {
+        std::sort(files.begin(), files.end(), [](const CatalogFile* a, const CatalogFile* b) {
+            return a->relative_path < b->relative_path;
+        });
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (i % m_shard.count != m_shard.index) {
+                m_excluded_files.insert(files[i]->path);
+            }
+        }
+    };
+    if (m_mode == Mode::FILES) {
+        deal_files(pod5_files);
+    }
+    deal_files(fast5_files);
+}
+
+bool DatasetShard::contains_read(const ReadID& read_id, uint16_t channel) const {
+    switch (m_mode) {
+    case Mode::CHANNELS:
+        return channel % m_shard.count == m_shard.index;
+    case Mode::READ_IDS:
+        return stable_hash(read_id) % m_shard.count == m_shard.index;
+    default:
+        return true;
+    }
+}
+
+size_t DatasetShard::num_pod5_reads(const DatasetCatalog& catalog) const {
+    size_t num_reads = 0;
+    for (const auto& file : catalog.files()) {
+        if (!file.is_pod5 || !contains_file(file.path)) {
+            continue;
+        }
+        if (!splits_files()) {
+            num_reads += file.num_reads();
+            continue;
+        }
+        for (size_t i = 0; i < file.read_ids.size(); ++i) {
+            num_reads += contains_read(file.read_ids[i], file.channels[i]) ? 1 : 0;
+        }
+    }
+    return num_reads;
+}
+
+}  // namespace dorado
@@ -0,0 +1,48 @@
+#pragma once
+#include "DataLoader.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+
+namespace dorado {
+
+class DatasetCatalog;
+
+// An InputShard resolved against the files of a dataset.  It only depends on what is in the
+// dataset, so processes sharing a dataset agree on the shards, which don't overlap and
+// between them cover every read.
+class DatasetShard {
+public:
+    enum class Mode {
+        FILES,     // Each file is in one shard.
+        READ_IDS,  // Each read is in the shard given by a hash of its id.
+        CHANNELS,  // Each read is in the shard given by its channel.
+    };
+
+    // Whole files are sharded if there are at least this many POD5 files per shard, so
+    // that shards are a similar size.
+    static constexpr size_t kMinFilesPerShard = 8;
+
+    DatasetShard(const DatasetCatalog& catalog, const InputShard& shard);
+
+    Mode mode() const { return m_mode; }
+    // Whether reads from within a file are split between shards.
+    bool splits_files() const { return m_mode != Mode::FILES; }
+    // Whether the shard may contain reads from the file.  FAST5 files are always sharded
+    // whole, as the catalog doesn't list their reads.
+    bool contains_file(const std::string& path) const {
+        return m_excluded_files.count(path) == 0;
+    }
+    // Whether a read from a file the shard contains is in the shard.
+    bool contains_read(const ReadID& read_id, uint16_t channel) const;
+    // The number of catalogued POD5 reads in the shard.
+    size_t num_pod5_reads(const DatasetCatalog& catalog) const;
+
+private:
+    InputShard m_shard;
+    Mode m_mode;
+    std::unordered_set<std::string> m_excluded_files;
+};
+
+}  // namespace dorado
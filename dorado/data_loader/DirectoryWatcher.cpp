@@ -0,0 +1,192 @@
+#include "DirectoryWatcher.h"
+
+#include "DatasetCatalog.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif  // __linux__
+
+namespace {
+
+bool is_pod5_path(const std::filesystem::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return ext == ".pod5";
+}
+
+}  // namespace
+
+namespace dorado {
+
+DirectoryWatcher::DirectoryWatcher(std::string path, Options options)
+        : m_path(std::move(path)), m_options(std::move(options)) {
+#ifdef __linux__
+    m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify_fd < 0) {
+        spdlog::debug("inotify unavailable, polling {} for new files", m_path);
+    }
+#endif  // __linux__
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+#ifdef __linux__
+    if (m_inotify_fd >= 0) {
+        close(m_inotify_fd);
+    }
+#endif  // __linux__
+}
+
+bool DirectoryWatcher::wait_for_files() {
+    scan();
+    while (m_ready_files.empty() && !m_stopped) {
+        const auto wait_start = std::chrono::steady_clock::now();
+        wait_for_change();
+        m_idle_time += std::chrono::steady_clock::now() - wait_start;
+        scan();
+    }
+    return !m_ready_files.empty();
+}
+
+std::vector<std::string> DirectoryWatcher::next_files() {
+    wait_for_files();
+    return std::exchange(m_ready_files, {});
+}
+
+void DirectoryWatcher::watch_directory(const std::string& path) {
+#ifdef __linux__
+    if (m_inotify_fd < 0 || !m_watched_directories.insert(path).second) {
+        return;
+    }
+    // Files are usually complete when closed after writing, or when moved into place.
+    // Creation is only of interest for new subdirectories, which need watches of their own.
+    if (inotify_add_watch(m_inotify_fd, path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) <
+        0) {
+        spdlog::debug("Couldn't watch {}, relying on polling", path);
+    }
+#endif  // __linux__
+}
+
+void DirectoryWatcher::scan() {
+    if (m_stopped) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    std::error_code ec;
+    // Decided before the walk, so that every file written before the stop file is picked up.
+    const bool stopping =
+            m_stop_requested ||
+            (!m_options.stop_file.empty() &&
+             std::filesystem::exists(std::filesystem::path(m_path) / m_options.stop_file, ec));
+    bool changed = false;
+
+    watch_directory(m_path);
+    std::vector<std::string> completed_files;
+    auto check_entry = [&](const std::filesystem::directory_entry& entry) {
+        std::error_code entry_ec;
+        if (entry.is_directory(entry_ec)) {
+            watch_directory(entry.path().string());
+            return;
+        }
+        const auto path = entry.path().string();
+        if (!is_pod5_path(entry.path()) || m_returned_files.count(path) > 0) {
+            return;
+        }
+        const auto size = entry.file_size(entry_ec);
+        if (entry_ec) {
+            return;
+        }
+        auto [it, inserted] = m_pending_files.try_emplace(path, PendingFile{size, now});
+        if (inserted || it->second.size != size) {
+            it->second = PendingFile{size, now};
+            changed = true;
+        }
+        // Once stopping, nothing more is expected to be written, so there's no need to wait
+        // for sizes to settle.
+        if ((stopping || now - it->second.since >= m_options.settle_time) &&
+            is_complete_pod5_file(path)) {
+            completed_files.push_back(path);
+            m_returned_files.insert(path);
+            m_pending_files.erase(it);
+        }
+    };
+
+    // Files can vanish or be renamed during the walk, so errors are skipped over rather than
+    // ending the walk.
+    const auto walk_options = std::filesystem::directory_options::skip_permission_denied;
+    if (m_options.recursive) {
+        for (std::filesystem::recursive_directory_iterator it(m_path, walk_options, ec), end;
+             !ec && it != end; it.increment(ec)) {
+            check_entry(*it);
+        }
+    } else {
+        for (std::filesystem::directory_iterator it(m_path, walk_options, ec), end;
+             !ec && it != end; it.increment(ec)) {
+            check_entry(*it);
+        }
+    }
+    if (ec) {
+        spdlog::debug("Error scanning {}: {}", m_path, ec.message());
+    }
+
+    if (!completed_files.empty()) {
+        std::sort(completed_files.begin(), completed_files.end());
+        m_ready_files.insert(m_ready_files.end(), completed_files.begin(), completed_files.end());
+        changed = true;
+    }
+
+    // Idleness is decided after the walk, from whether it found anything new, so that time
+    // the caller spends loading files between scans never counts as idle.
+    if (changed) {
+        m_idle_time = {};
+    }
+    const bool idle = m_options.idle_timeout.count() > 0 && m_idle_time >= m_options.idle_timeout;
+
+    if (stopping || idle) {
+        for (const auto& [path, pending_file] : m_pending_files) {
+            spdlog::warn("Not loading incomplete POD5 file {}", path);
+        }
+        m_pending_files.clear();
+        m_stopped = true;
+    }
+}
+
+void DirectoryWatcher::wait_for_change() {
+    // Files waiting to settle are checked again once they may have done so.
+    auto timeout = m_pending_files.empty() ? m_options.poll_interval
+                                           : std::min(m_options.poll_interval,
+                                                      m_options.settle_time);
+    if (m_options.idle_timeout.count() > 0) {
+        const auto until_idle = std::chrono::ceil<std::chrono::milliseconds>(
+                m_options.idle_timeout - m_idle_time);
+        timeout = std::max(std::min(timeout, until_idle), std::chrono::milliseconds(0));
+    }
+
+#ifdef __linux__
+    if (m_inotify_fd >= 0) {
+        pollfd fd{m_inotify_fd, POLLIN, 0};
+        if (poll(&fd, 1, static_cast<int>(timeout.count())) > 0) {
+            // The events themselves aren't needed, as the directory is rescanned.
+            alignas(inotify_event) char buffer[4096];
+            while (read(m_inotify_fd, buffer, sizeof(buffer)) > 0) {
+            }
+        }
+        return;
+    }
+#endif  // __linux__
+    std::this_thread::sleep_for(timeout);
+}
+
+}  // namespace dorado
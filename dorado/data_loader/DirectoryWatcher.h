@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dorado {
+
+// Finds POD5 files in a directory as they are completed, e.g. while a run is still being
+// acquired.  A file is complete once it has a valid POD5 footer and its size has settled.
+// On Linux the watcher is woken by inotify as files are written, elsewhere it polls.
+class DirectoryWatcher {
+public:
+    struct Options {
+        bool recursive{false};
+        // How long a file's size must stay the same before it is loaded.
+        std::chrono::milliseconds settle_time{1000};
+        // How often the directory is rescanned when there's nothing else to wake for.
+        std::chrono::milliseconds poll_interval{5000};
+        // Watching stops once the watcher has waited this long without anything changing.
+        // Time between calls, e.g. spent loading the files returned, doesn't count.
+        // 0 to watch indefinitely.
+        std::chrono::milliseconds idle_timeout{std::chrono::minutes(10)};
+        // Watching stops once a file of this name appears in the top level of the directory.
+        // Empty for no stop file.
+        std::string stop_file;
+    };
+
+    DirectoryWatcher(std::string path, Options options);
+    ~DirectoryWatcher();
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    // Blocks until there are completed files which haven't been returned yet.  Returns false
+    // if watching stopped before any were found.
+    bool wait_for_files();
+    // Blocks until there are completed files which haven't been returned yet, and returns
+    // them.  Returns an empty list once watching has stopped and every file has been
+    // returned.
+    std::vector<std::string> next_files();
+    // Stops watching.  Files which are already complete are still returned.  Thread safe.
+    void stop() { m_stop_requested = true; }
+
+private:
+    // Walks the directory, moving files which have completed to m_ready_files.
+    void scan();
+    // Sleeps until the directory may have changed.
+    void wait_for_change();
+    void watch_directory(const std::string& path);
+
+    const std::string m_path;
+    const Options m_options;
+    std::atomic<bool> m_stop_requested{false};
+    bool m_stopped{false};
+
+    // Files found but not yet complete, with their size and when it last changed.
+    struct PendingFile {
+        uintmax_t size;
+        std::chrono::steady_clock::time_point since;
+    };
+    std::unordered_map<std::string, PendingFile> m_pending_files;
+    std::unordered_set<std::string> m_returned_files;
+    std::vector<std::string> m_ready_files;
+    // Time spent waiting for changes since a scan last found something new.
+    std::chrono::steady_clock::duration m_idle_time{};
+
+    int m_inotify_fd{-1};  // -1 when polling.
+    std::unordered_set<std::string> m_watched_directories;
+};
+
+}  // namespace dorado
@@ -1,149 +1,65 @@
 #include "CPUDecoder.h"
 
 #include "beam_search.h"
+#include "crf_scan.h"
+#include "utils/WorkStealingExecutor.h"
 
-#include <math.h>
 #include <spdlog/spdlog.h>
 #include <torch/torch.h>
 
+#include <algorithm>
 #include <vector>
 
-namespace {
-
-at::Tensor scan(const torch::Tensor& Ms,
-                const float fixed_stay_score,
-                const torch::Tensor& idx,
-                const torch::Tensor& v0) {
-    const int T = Ms.size(0);
-    const int N = Ms.size(1);
-    const int C = Ms.size(2);
-
-    torch::Tensor alpha = Ms.new_full({T + 1, N, C}, -1E38);
-    alpha[0] = v0;
-
-    for (int t = 0; t < T; t++) {
-        auto scored_steps = torch::add(alpha.index({t, torch::indexing::Slice(), idx}), Ms[t]);
-        auto scored_stay = torch::add(alpha.index({t, torch::indexing::Slice()}), fixed_stay_score)
-                                   .unsqueeze(-1);
-        auto scored_transitions = torch::cat({scored_stay, scored_steps}, -1);
-
-        alpha[t + 1] = torch::logsumexp(scored_transitions, -1);
-    }
-
-    return alpha;
-}
-
-torch::Tensor forward_scores(const torch::Tensor& scores, const float fixed_stay_score) {
-    const int T = scores.size(0);  // Signal len
-    const int N = scores.size(1);  // Num batches
-    const int C = scores.size(2);  // 4^state_len * 4 = 4^(state_len + 1)
-
-    const int n_base = 4;
-    const int state_len = std::log(C) / std::log(n_base) - 1;
-
-    // Transition scores reshaped so that the 4 scores for each predecessor state are arranged along the
-    // innermost dimension.
-    const torch::Tensor Ms = scores.reshape({T, N, -1, n_base});
-
-    // Number of states per timestep.
-    const int num_states = pow(n_base, state_len);
-
-    // Guide values at first timestep.
-    const auto v0 = Ms.new_full({{N, num_states}}, 0.0f);
-
-    // For each state, the indices of the 4 states that could precede it via a step transition.
-    const auto idx = torch::arange(num_states)
-                             .repeat_interleave(n_base)
-                             .reshape({n_base, -1})
-                             .t()
-                             .contiguous();
-
-    return scan(Ms, fixed_stay_score, idx, v0);
-}
-
-torch::Tensor backward_scores(const torch::Tensor& scores, const float fixed_stay_score) {
-    const int N = scores.size(1);  // Num batches
-    const int C = scores.size(2);  // 4^state_len * 4 = 4^(state_len + 1)
-
-    const int n_base = 4;
-
-    const int state_len = std::log(C) / std::log(n_base) - 1;
-
-    // Number of states per timestep.
-    const int num_states = pow(n_base, state_len);
-
-    // Guide values at last timestep.
-    const torch::Tensor vT = scores.new_full({N, num_states}, 0.0f);
-
-    const auto idx = torch::arange(num_states)
-                             .repeat_interleave(n_base)
-                             .reshape({n_base, -1})
-                             .t()
-                             .contiguous();
-    auto idx_T = idx.flatten().argsort().reshape(idx.sizes());
-
-    const auto Ms_T = scores.index({torch::indexing::Slice(), torch::indexing::Slice(), idx_T});
-
-    // For each state, the indices of the 4 states that could succeed it via a step transition.
-    idx_T = torch::bitwise_right_shift(idx_T, 2);
-
-    return scan(Ms_T.flip(0), fixed_stay_score, idx_T.to(torch::kInt64), vT).flip(0);
-}
-
-}  // namespace
-
 namespace dorado {
 
 std::vector<DecodedChunk> CPUDecoder::beam_search(const torch::Tensor& scores,
                                                   const int num_chunks,
                                                   const DecoderOptions& options) {
-    const auto scores_cpu = scores.to(torch::kCPU);
-    int num_threads = std::min(num_chunks, 4);
-    int chunks_per_thread = num_chunks / num_threads;
-    int num_threads_with_one_more_chunk = num_chunks % num_threads;
-
+    // The scans read the scores by raw pointer, with the chunks of each timestep contiguous.
+    const auto scores_cpu = scores.to(torch::kCPU, torch::kFloat).contiguous();
+    const auto num_timesteps = scores_cpu.size(0);
+    const auto num_transitions = scores_cpu.size(2);
+    const auto num_states = num_transitions / 4;
+
+    // The scans write each chunk's scores in turn, as beam search reads them.
+    auto fwd = torch::empty({num_chunks, num_timesteps + 1, num_states}, scores_cpu.options());
+    auto bwd = torch::empty_like(fwd);
+    const float* const scores_ptr = scores_cpu.data_ptr<float>();
+    float* const fwd_ptr = fwd.data_ptr<float>();
+    float* const bwd_ptr = bwd.data_ptr<float>();
+    const size_t chunk_scan_size = (num_timesteps + 1) * num_states;
+
+    // Every CPU runner's batches are decoded on the same pool of workers, rather than on
+    // threads of their own, with at most options.num_threads tasks per batch at once.
+    auto& executor = utils::WorkStealingExecutor::global();
+    const size_t max_concurrency = std::max<size_t>(options.num_threads, 1);
+
+    const size_t num_blocks = (num_chunks + kCRFScanBlockSize - 1) / kCRFScanBlockSize;
+    executor.parallel_for(num_blocks, max_concurrency, [&](size_t, size_t block) {
+        const size_t first_chunk = block * kCRFScanBlockSize;
+        const size_t block_chunks = std::min(kCRFScanBlockSize, num_chunks - first_chunk);
+        crf_forward_scan(scores_ptr + first_chunk * num_transitions, num_timesteps,
+                         scores_cpu.stride(0), block_chunks, num_states, options.blank_score,
+                         fwd_ptr + first_chunk * chunk_scan_size);
+        crf_backward_scan(scores_ptr + first_chunk * num_transitions, num_timesteps,
+                          scores_cpu.stride(0), block_chunks, num_states, options.blank_score,
+                          bwd_ptr + first_chunk * chunk_scan_size);
+    });
+
+    const auto chunk_scores = scores_cpu.transpose(0, 1);
     std::vector<DecodedChunk> chunk_results(num_chunks);
-
-    std::vector<std::unique_ptr<std::thread>> threads;
-    threads.reserve(num_threads);
-    for (int i = 0; i < num_threads; ++i) {
-        threads.emplace_back(new std::thread(
-                [&](int i) {
-                    int t_first_chunk =
-                            i * chunks_per_thread + std::min(i, num_threads_with_one_more_chunk);
-                    int t_num_chunks = chunks_per_thread + int(i < num_threads_with_one_more_chunk);
-
-                    using Slice = torch::indexing::Slice;
-                    auto t_scores = scores_cpu.index(
-                            {Slice(), Slice(t_first_chunk, t_first_chunk + t_num_chunks)});
-
-                    torch::Tensor fwd = forward_scores(t_scores, options.blank_score);
-                    torch::Tensor bwd = backward_scores(t_scores, options.blank_score);
-
-                    torch::Tensor posts = torch::softmax(fwd + bwd, -1);
-
-                    t_scores = t_scores.transpose(0, 1);
-                    bwd = bwd.transpose(0, 1).contiguous();
-                    posts = posts.transpose(0, 1).contiguous();
-
-                    for (int i = 0; i < t_num_chunks; i++) {
-                        auto decode_result = beam_search_decode(
-                                t_scores[i], bwd[i], posts[i], options.beam_width, options.beam_cut,
-                                options.blank_score, options.q_shift, options.q_scale,
-                                options.temperature, 1.0f);
-                        chunk_results[t_first_chunk + i] = DecodedChunk{
-                                std::get<0>(decode_result),
-                                std::get<1>(decode_result),
-                                std::get<2>(decode_result),
-                        };
-                    }
-                },
-                i));
-    }
-
-    for (auto& thread : threads) {
-        thread->join();
-    }
+    executor.parallel_for(num_chunks, max_concurrency, [&](size_t, size_t i) {
+        const auto chunk = static_cast<int64_t>(i);
+        const auto posts = torch::softmax(fwd[chunk] + bwd[chunk], -1);
+        auto decode_result = beam_search_decode(
+                chunk_scores[chunk], bwd[chunk], posts, options.beam_width, options.beam_cut,
+                options.blank_score, options.q_shift, options.q_scale, options.temperature, 1.0f);
+        chunk_results[i] = DecodedChunk{
+                std::get<0>(decode_result),
+                std::get<1>(decode_result),
+                std::get<2>(decode_result),
+        };
+    });
 
     return chunk_results;
 }
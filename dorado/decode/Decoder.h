@@ -21,6 +21,8 @@ struct DecoderOptions {
     float q_scale = 1.0;
     float temperature = 1.0;
     bool move_pad = false;
+    // Most chunks of a batch a CPU decoder decodes at once, on the shared worker pool.
+    size_t num_threads = 4;
 };
 
 class Decoder {
@@ -0,0 +1,240 @@
+#include "crf_scan.h"
+
+#include "utils/simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// A lane of an AVX2 register per chunk.
+constexpr size_t kBlockSize = dorado::kCRFScanBlockSize;
+
+// Buffers reused by each thread's scans, holding a block's transition scores for one timestep,
+// and its state scores either side of that timestep, with the block's chunks innermost.
+struct ScanScratch {
+    std::vector<float> scores;
+    std::vector<float> prev;
+    std::vector<float> next;
+};
+
+ScanScratch& get_scratch() {
+    thread_local ScanScratch scratch;
+    return scratch;
+}
+
+// The state that state s is reached from by its k'th step, and the index of that step's
+// transition score.  Forward scans reach s from its predecessors, backward scans from its
+// successors.
+inline std::pair<size_t, size_t> step_into(size_t s, size_t k, size_t num_states, bool backward) {
+    const size_t quarter = num_states / 4;
+    if (!backward) {
+        return {s / 4 + k * quarter, s * 4 + k};
+    }
+    const size_t successor = (s % quarter) * 4 + k;
+    return {successor, successor * 4 + s / quarter};
+}
+
+// Computes the state scores after one timestep from those before it, for a block of chunks.
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+void scan_step_impl(const float* const scores,
+                    const float* const prev,
+                    float* const next,
+                    size_t num_states,
+                    float fixed_stay_score,
+                    bool backward) {
+    for (size_t s = 0; s < num_states; ++s) {
+        float terms[5][kBlockSize];
+        for (size_t lane = 0; lane < kBlockSize; ++lane) {
+            terms[0][lane] = prev[s * kBlockSize + lane] + fixed_stay_score;
+        }
+        for (size_t k = 0; k < 4; ++k) {
+            const auto [other, score_idx] = step_into(s, k, num_states, backward);
+            for (size_t lane = 0; lane < kBlockSize; ++lane) {
+                terms[k + 1][lane] =
+                        prev[other * kBlockSize + lane] + scores[score_idx * kBlockSize + lane];
+            }
+        }
+        for (size_t lane = 0; lane < kBlockSize; ++lane) {
+            float max_term = terms[0][lane];
+            for (size_t i = 1; i < 5; ++i) {
+                max_term = std::max(max_term, terms[i][lane]);
+            }
+            float sum = 0.f;
+            for (size_t i = 0; i < 5; ++i) {
+                sum += std::exp(terms[i][lane] - max_term);
+            }
+            next[s * kBlockSize + lane] = max_term + std::log(sum);
+        }
+    }
+}
+
+#if ENABLE_AVX2_IMPL
+// exp(x) for x <= 0, by the Cephes expf polynomial.  x is clamped to keep the result normal,
+// which leaves it far below the precision of the sums it's added to.
+__attribute__((target("avx2,fma"))) inline __m256 exp_ps(__m256 x) {
+    x = _mm256_max_ps(x, _mm256_set1_ps(-87.3f));
+    // x = n * ln(2) + r, with ln(2) split in two for precision.
+    const __m256 n = _mm256_floor_ps(
+            _mm256_fmadd_ps(x, _mm256_set1_ps(1.44269504088896341f), _mm256_set1_ps(0.5f)));
+    x = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+    x = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), x);
+
+    __m256 y = _mm256_set1_ps(1.9875691500e-4f);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.3981999507e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(8.3334519073e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(4.1665795894e-2f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.6666665459e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(5.0000001201e-1f));
+    y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), x);
+    y = _mm256_add_ps(y, _mm256_set1_ps(1.f));
+
+    // Scale by 2^n by building its float bits.
+    const __m256i pow2n = _mm256_slli_epi32(
+            _mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(0x7f)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(pow2n));
+}
+
+// log(x) for positive, normal x, by the Cephes logf polynomial.
+__attribute__((target("avx2,fma"))) inline __m256 log_ps(__m256 x) {
+    const __m256 one = _mm256_set1_ps(1.f);
+    // x = m * 2^e, with m in [0.5, 1).
+    const __m256i bits = _mm256_castps_si256(x);
+    __m256 e = _mm256_cvtepi32_ps(
+            _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(126)));
+    x = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)),
+                                            _mm256_set1_epi32(0x3f000000)));
+    // Take m in [sqrt(0.5), sqrt(2)) instead, and approximate log(1 + (m - 1)).
+    const __m256 small = _mm256_cmp_ps(x, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OQ);
+    e = _mm256_sub_ps(e, _mm256_and_ps(one, small));
+    x = _mm256_add_ps(_mm256_sub_ps(x, one), _mm256_and_ps(x, small));
+    const __m256 z = _mm256_mul_ps(x, x);
+
+    __m256 y = _mm256_set1_ps(7.0376836292e-2f);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-1.1514610310e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.1676998740e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-1.2420140846e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.4249322787e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-1.6668057665e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(2.0000714765e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(-2.4999993993e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(3.3333331174e-1f));
+    y = _mm256_mul_ps(_mm256_mul_ps(y, x), z);
+
+    y = _mm256_fmadd_ps(e, _mm256_set1_ps(-2.12194440e-4f), y);
+    y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+    x = _mm256_add_ps(x, y);
+    return _mm256_fmadd_ps(e, _mm256_set1_ps(0.693359375f), x);
+}
+
+// The block's chunks are processed 8 at a time, so each state's terms are log-sum-exp'd with
+// a handful of vector ops.
+__attribute__((target("avx2,fma"))) void scan_step_impl(const float* const scores,
+                                                        const float* const prev,
+                                                        float* const next,
+                                                        size_t num_states,
+                                                        float fixed_stay_score,
+                                                        bool backward) {
+    static_assert(kBlockSize == 8);
+    const __m256 stay_score = _mm256_set1_ps(fixed_stay_score);
+    for (size_t s = 0; s < num_states; ++s) {
+        const __m256 stay = _mm256_add_ps(_mm256_loadu_ps(prev + s * kBlockSize), stay_score);
+        __m256 steps[4];
+        __m256 max_term = stay;
+        for (size_t k = 0; k < 4; ++k) {
+            const auto [other, score_idx] = step_into(s, k, num_states, backward);
+            steps[k] = _mm256_add_ps(_mm256_loadu_ps(prev + other * kBlockSize),
+                                     _mm256_loadu_ps(scores + score_idx * kBlockSize));
+            max_term = _mm256_max_ps(max_term, steps[k]);
+        }
+        __m256 sum = exp_ps(_mm256_sub_ps(stay, max_term));
+        for (size_t k = 0; k < 4; ++k) {
+            sum = _mm256_add_ps(sum, exp_ps(_mm256_sub_ps(steps[k], max_term)));
+        }
+        _mm256_storeu_ps(next + s * kBlockSize, _mm256_add_ps(max_term, log_ps(sum)));
+    }
+}
+#endif
+
+void scan(const float* const scores,
+          size_t num_timesteps,
+          size_t time_stride,
+          size_t num_chunks,
+          size_t num_states,
+          float fixed_stay_score,
+          bool backward,
+          float* const out) {
+    const size_t num_transitions = num_states * 4;
+    const size_t chunk_out_size = (num_timesteps + 1) * num_states;
+    auto& scratch = get_scratch();
+
+    for (size_t first_chunk = 0; first_chunk < num_chunks; first_chunk += kBlockSize) {
+        const size_t block_chunks = std::min(kBlockSize, num_chunks - first_chunk);
+        // Lanes past the last chunk scan zero scores, and their results are discarded.
+        scratch.scores.assign(num_transitions * kBlockSize, 0.f);
+        scratch.prev.assign(num_states * kBlockSize, 0.f);
+        scratch.next.resize(num_states * kBlockSize);
+
+        const size_t guide_t = backward ? num_timesteps : 0;
+        for (size_t lane = 0; lane < block_chunks; ++lane) {
+            std::fill_n(out + (first_chunk + lane) * chunk_out_size + guide_t * num_states,
+                        num_states, 0.f);
+        }
+
+        for (size_t i = 0; i < num_timesteps; ++i) {
+            const size_t t = backward ? num_timesteps - 1 - i : i;
+            const float* const step_scores =
+                    scores + t * time_stride + first_chunk * num_transitions;
+            for (size_t lane = 0; lane < block_chunks; ++lane) {
+                for (size_t c = 0; c < num_transitions; ++c) {
+                    scratch.scores[c * kBlockSize + lane] = step_scores[lane * num_transitions + c];
+                }
+            }
+
+            scan_step_impl(scratch.scores.data(), scratch.prev.data(), scratch.next.data(),
+                           num_states, fixed_stay_score, backward);
+
+            const size_t out_t = backward ? t : t + 1;
+            for (size_t lane = 0; lane < block_chunks; ++lane) {
+                float* const dest =
+                        out + (first_chunk + lane) * chunk_out_size + out_t * num_states;
+                for (size_t s = 0; s < num_states; ++s) {
+                    dest[s] = scratch.next[s * kBlockSize + lane];
+                }
+            }
+            std::swap(scratch.prev, scratch.next);
+        }
+    }
+}
+
+}  // namespace
+
+namespace dorado {
+
+void crf_forward_scan(const float* const scores,
+                      size_t num_timesteps,
+                      size_t time_stride,
+                      size_t num_chunks,
+                      size_t num_states,
+                      float fixed_stay_score,
+                      float* const alpha) {
+    scan(scores, num_timesteps, time_stride, num_chunks, num_states, fixed_stay_score, false,
+         alpha);
+}
+
+void crf_backward_scan(const float* const scores,
+                       size_t num_timesteps,
+                       size_t time_stride,
+                       size_t num_chunks,
+                       size_t num_states,
+                       float fixed_stay_score,
+                       float* const beta) {
+    scan(scores, num_timesteps, time_stride, num_chunks, num_states, fixed_stay_score, true,
+         beta);
+}
+
+}  // namespace dorado
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+
+namespace dorado {
+
+// Chunks scanned together.  Callers sharing a batch's scans between threads should split it
+// at multiples of this.
+constexpr std::size_t kCRFScanBlockSize = 8;
+
+// Forward and backward scans of a CRF's transition scores in the log semiring, as used to
+// compute the posteriors and back guides for beam search.
+//
+// scores holds, for each of num_timesteps timesteps, the num_states * 4 transition scores of
+// each of num_chunks chunks: the score of chunk n's transition c at timestep t is at
+// scores[t * time_stride + n * num_states * 4 + c].  Transition s * 4 + k is the step into
+// state s from its k'th predecessor, s / 4 + k * num_states / 4, and a stay in any state
+// scores fixed_stay_score.
+//
+// The scores of each chunk are written to out as [num_timesteps + 1, num_states], with the
+// chunks one after another.  Chunks are scanned in blocks, a lane per chunk, so that the
+// log-sum-exp of each state's stay and 4 steps is vectorised.
+
+// alpha[n][t + 1][s] is the log-sum-exp of the scores of paths ending in state s after
+// timestep t, and alpha[n][0] is zero.
+void crf_forward_scan(const float* scores,
+                      std::size_t num_timesteps,
+                      std::size_t time_stride,
+                      std::size_t num_chunks,
+                      std::size_t num_states,
+                      float fixed_stay_score,
+                      float* alpha);
+
+// beta[n][t][s] is the log-sum-exp of the scores of paths from state s before timestep t to
+// the end of the chunk, and beta[n][num_timesteps] is zero.
+void crf_backward_scan(const float* scores,
+                       std::size_t num_timesteps,
+                       std::size_t time_stride,
+                       std::size_t num_chunks,
+                       std::size_t num_states,
+                       float fixed_stay_score,
+                       float* beta);
+
+}  // namespace dorado
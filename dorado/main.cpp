@@ -56,7 +56,12 @@ int main(int argc, char* argv[]) {
     const std::map<std::string, entry_ptr> subcommands = {
             {"basecaller", &dorado::basecaller}, {"duplex", &dorado::duplex},
             {"download", &dorado::download},     {"aligner", &dorado::aligner},
-            {"summary", &dorado::summary},
+            {"summary", &dorado::summary},       {"merge", &dorado::merge},
+    };
+
+    // Developer tools which aren't listed in the usage message.
+    const std::map<std::string, entry_ptr> hidden_subcommands = {
+            {"benchmark", &dorado::benchmark},
     };
 
     std::vector<std::string> arguments(argv + 1, argv + argc);
@@ -89,6 +94,8 @@ int main(int argc, char* argv[]) {
         return 0;
     } else if (subcommands.find(subcommand) != subcommands.end()) {
         return subcommands.at(subcommand)(--argc, ++argv);
+    } else if (hidden_subcommands.find(subcommand) != hidden_subcommands.end()) {
+        return hidden_subcommands.at(subcommand)(--argc, ++argv);
     } else {
         usage(keys);
         return 1;
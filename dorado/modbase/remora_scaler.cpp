@@ -2,6 +2,7 @@
 
 #include "remora_utils.h"
 #include "utils/math_utils.h"
+#include "utils/quantile_utils.h"
 
 #include <nvtx3/nvtx3.hpp>
 
@@ -82,18 +83,28 @@ std::pair<float, float> RemoraScaler::calc_offset_scale(const torch::Tensor& sam
             new_levels[i] = levels[i];
         }
     }
+    size_t first = 0;
+    size_t count = n;
     if (clip_bases > 0 && levels.size() > clip_bases * 2) {
-        new_levels = {std::begin(new_levels) + clip_bases, std::end(new_levels) - clip_bases};
-        optim_dacs = {std::begin(optim_dacs) + clip_bases, std::end(optim_dacs) - clip_bases};
+        first = clip_bases;
+        count = n > clip_bases * 2 ? n - clip_bases * 2 : 0;
+    }
+    // A regression needs at least two points, otherwise the identity transform is used.
+    if (count < 2) {
+        return {0.f, 1.f};
     }
 
     std::vector<float> quants(19);
     std::generate(std::begin(quants), std::end(quants), [n = 0.f]() mutable { return n += 0.05f; });
 
-    new_levels = utils::quantiles(new_levels, quants);
-    optim_dacs = utils::quantiles(optim_dacs, quants);
+    std::vector<float> level_quantiles(quants.size());
+    std::vector<float> dac_quantiles(quants.size());
+    utils::quantiles(new_levels.data() + first, count, quants.data(), quants.size(),
+                     level_quantiles.data(), utils::QuantileInterpolation::LINEAR);
+    utils::quantiles(optim_dacs.data() + first, count, quants.data(), quants.size(),
+                     dac_quantiles.data(), utils::QuantileInterpolation::LINEAR);
 
-    auto [new_scale, new_offset, rcoeff] = utils::linear_regression(optim_dacs, new_levels);
+    auto [new_scale, new_offset, rcoeff] = utils::linear_regression(dac_quantiles, level_quantiles);
     return {new_offset, new_scale};
 }
 
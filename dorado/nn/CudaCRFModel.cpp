@@ -3,6 +3,7 @@
 #include "decode/GPUDecoder.h"
 #include "utils/cuda_utils.h"
 #include "utils/math_utils.h"
+#include "utils/tensor_utils.h"
 
 #include <c10/cuda/CUDAGuard.h>
 #include <c10/cuda/CUDAStream.h>
@@ -206,6 +207,18 @@ void CudaModelRunner::accept_chunk(int chunk_idx, const torch::Tensor &chunk) {
     m_input.index_put_({chunk_idx, torch::indexing::Ellipsis}, chunk);
 }
 
+void CudaModelRunner::stage_chunk(int chunk_idx,
+                                  const c10::Half *signal,
+                                  size_t len,
+                                  size_t num_rows,
+                                  size_t row_stride,
+                                  ChunkPadMode pad_mode) {
+    assert(num_rows == static_cast<size_t>(m_input.size(1)));
+    // Written straight into the pinned input, ready for the copy to the GPU.
+    utils::copy_signal_rows(m_input, chunk_idx * m_input.stride(0), chunk_size(), signal, num_rows,
+                            row_stride, len, pad_mode == ChunkPadMode::REPEAT);
+}
+
 std::vector<DecodedChunk> CudaModelRunner::call_chunks(int num_chunks) {
     ++m_num_batches_called;
     stats::Timer timer;
@@ -26,6 +26,12 @@ class CudaModelRunner : public ModelRunnerBase {
 public:
     explicit CudaModelRunner(std::shared_ptr<CudaCaller> caller);
     void accept_chunk(int chunk_idx, const torch::Tensor& chunk) final;
+    void stage_chunk(int chunk_idx,
+                     const c10::Half* signal,
+                     size_t len,
+                     size_t num_rows,
+                     size_t row_stride,
+                     ChunkPadMode pad_mode) final;
     std::vector<DecodedChunk> call_chunks(int num_chunks) final;
     size_t model_stride() const final;
     size_t chunk_size() const final;
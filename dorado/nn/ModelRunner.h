@@ -4,19 +4,37 @@
 #include "CRFModel.h"
 #include "utils/stats.h"
 #include "utils/stitch.h"
+#include "utils/tensor_utils.h"
 
 #include <spdlog/spdlog.h>
 #include <toml.hpp>
 #include <torch/torch.h>
 
 #include <atomic>
+#include <cassert>
 #include <string>
 
 namespace dorado {
 
+// How the samples of a chunk shorter than the runner's chunk size are padded.
+enum class ChunkPadMode {
+    REPEAT,  // The chunk's samples repeated from its start.
+    ZERO,    // Zeros.
+};
+
 class ModelRunnerBase {
 public:
     virtual void accept_chunk(int chunk_idx, const torch::Tensor &chunk) = 0;
+    // Copies the samples of a chunk straight into the runner's input for chunk_idx, padded to
+    // chunk_size() as pad_mode says, without the intermediate tensors needed to slice and
+    // pad a chunk for accept_chunk.  signal holds num_rows rows of len samples, the rows
+    // row_stride elements apart, as in a read's raw_data from a chunk's offset.
+    virtual void stage_chunk(int chunk_idx,
+                             const c10::Half *signal,
+                             size_t len,
+                             size_t num_rows,
+                             size_t row_stride,
+                             ChunkPadMode pad_mode);
     virtual std::vector<DecodedChunk> call_chunks(int num_chunks) = 0;
     virtual size_t model_stride() const = 0;
     virtual size_t chunk_size() const = 0;
@@ -26,6 +44,22 @@ public:
     virtual stats::NamedStats sample_stats() const = 0;
 };
 
+// Runners whose input isn't laid out [batch, rows, samples] on the CPU are given the padded
+// chunk via accept_chunk.
+inline void ModelRunnerBase::stage_chunk(int chunk_idx,
+                                         const c10::Half *signal,
+                                         size_t len,
+                                         size_t num_rows,
+                                         size_t row_stride,
+                                         ChunkPadMode pad_mode) {
+    const auto padded_len = chunk_size();
+    auto chunk = torch::empty({static_cast<int64_t>(num_rows), static_cast<int64_t>(padded_len)},
+                              torch::kFloat16);
+    utils::copy_signal_rows(chunk, 0, padded_len, signal, num_rows, row_stride, len,
+                            pad_mode == ChunkPadMode::REPEAT);
+    accept_chunk(chunk_idx, num_rows == 1 ? chunk[0] : chunk);
+}
+
 using Runner = std::shared_ptr<ModelRunnerBase>;
 
 template <typename T>
@@ -34,8 +68,15 @@ public:
     ModelRunner(const std::filesystem::path &model,
                 const std::string &device,
                 int chunk_size,
-                int batch_size);
+                int batch_size,
+                const DecoderOptions &decoder_options = DecoderOptions());
     void accept_chunk(int chunk_idx, const torch::Tensor &chunk) final;
+    void stage_chunk(int chunk_idx,
+                     const c10::Half *signal,
+                     size_t len,
+                     size_t num_rows,
+                     size_t row_stride,
+                     ChunkPadMode pad_mode) final;
     std::vector<DecodedChunk> call_chunks(int num_chunks) final;
     size_t model_stride() const final { return m_model_stride; }
     size_t chunk_size() const final { return m_input.size(2); }
@@ -62,11 +103,12 @@ template <typename T>
 ModelRunner<T>::ModelRunner(const std::filesystem::path &model_path,
                             const std::string &device,
                             int chunk_size,
-                            int batch_size) {
+                            int batch_size,
+                            const DecoderOptions &decoder_options) {
     const auto model_config = load_crf_model_config(model_path);
     m_model_stride = static_cast<size_t>(model_config.stride);
 
-    m_decoder_options = DecoderOptions();
+    m_decoder_options = decoder_options;
     m_decoder_options.q_shift = model_config.qbias;
     m_decoder_options.q_scale = model_config.qscale;
     m_decoder = std::make_unique<T>();
@@ -77,7 +119,7 @@ ModelRunner<T>::ModelRunner(const std::filesystem::path &model_path,
     // adjust chunk size to be a multiple of the stride
     chunk_size -= chunk_size % m_model_stride;
 
-    m_input = torch::zeros({batch_size, 1, chunk_size},
+    m_input = torch::zeros({batch_size, model_config.num_features, chunk_size},
                            torch::TensorOptions().dtype(T::dtype).device(torch::kCPU));
 }
 
@@ -97,7 +139,20 @@ std::vector<DecodedChunk> ModelRunner<T>::call_chunks(int num_chunks) {
 
 template <typename T>
 void ModelRunner<T>::accept_chunk(int chunk_idx, const torch::Tensor &chunk) {
-    m_input.index_put_({chunk_idx, 0}, chunk);
+    m_input.index_put_({chunk_idx, torch::indexing::Ellipsis}, chunk);
+}
+
+template <typename T>
+void ModelRunner<T>::stage_chunk(int chunk_idx,
+                                 const c10::Half *signal,
+                                 size_t len,
+                                 size_t num_rows,
+                                 size_t row_stride,
+                                 ChunkPadMode pad_mode) {
+    assert(num_rows == static_cast<size_t>(m_input.size(1)));
+    // The float32 CPU input is converted to as it's written.
+    utils::copy_signal_rows(m_input, chunk_idx * m_input.stride(0), chunk_size(), signal, num_rows,
+                            row_stride, len, pad_mode == ChunkPadMode::REPEAT);
 }
 
 template <typename T>
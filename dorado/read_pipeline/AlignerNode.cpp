@@ -10,7 +10,9 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -21,8 +23,10 @@ Aligner::Aligner(MessageSink& sink,
                  int k,
                  int w,
                  uint64_t index_batch_size,
-                 int threads)
-        : MessageSink(10000), m_sink(sink), m_threads(threads) {
+                 int threads,
+                 QueueBackend queue_backend)
+        : MessageSink(10000, queue_backend), m_threads(std::max(threads, 1)) {
+    add_output(sink);
     // Check if reference file exists.
     if (!std::filesystem::exists(filename)) {
         throw std::runtime_error("Aligner reference path does not exist: " + filename);
@@ -75,24 +79,19 @@ Aligner::Aligner(MessageSink& sink,
         m_tbufs.push_back(mm_tbuf_init());
     }
 
-    for (size_t i = 0; i < m_threads; i++) {
-        m_workers.push_back(
-                std::make_unique<std::thread>(std::thread(&Aligner::worker_thread, this, i)));
-    }
+    m_worker = std::thread(&Aligner::worker_thread, this);
 }
 
 Aligner::~Aligner() {
     terminate();
-    for (auto& m : m_workers) {
-        m->join();
-    }
+    m_worker.join();
     for (int i = 0; i < m_threads; i++) {
         mm_tbuf_destroy(m_tbufs[i]);
     }
     mm_idx_reader_close(m_index_reader);
     mm_idx_destroy(m_index);
     // Adding for thread safety in case worker thread throws exception.
-    m_sink.terminate();
+    terminate_outputs();
 }
 
 std::vector<std::pair<char*, uint32_t>> Aligner::get_sequence_records_for_header() {
@@ -103,23 +102,17 @@ std::vector<std::pair<char*, uint32_t>> Aligner::get_sequence_records_for_header
     return records;
 }
 
-void Aligner::worker_thread(size_t tid) {
-    m_active++;  // Track active threads.
-
-    Message message;
-    while (m_work_queue.try_pop(message)) {
+void Aligner::worker_thread() {
+    // Each slot has its own minimap2 thread buffer.
+    process_messages_in_order(m_threads, [this](size_t slot, Message&& message) {
         auto read = std::get<BamPtr>(std::move(message));
-        auto records = align(read.get(), m_tbufs[tid]);
-        for (auto& record : records) {
-            m_sink.push_message(std::move(record));
-        }
-    }
+        auto records = align(read.get(), m_tbufs[slot]);
+        return std::vector<Message>(std::make_move_iterator(records.begin()),
+                                    std::make_move_iterator(records.end()));
+    });
 
-    int num_active = --m_active;
-    if (num_active == 0) {
-        terminate();
-        m_sink.terminate();
-    }
+    terminate();
+    terminate_outputs();
 }
 
 // Function to add auxiliary tags to the alignment record.
@@ -337,6 +330,6 @@ std::vector<BamPtr> Aligner::align(bam1_t* irecord, mm_tbuf_t* buf) {
     return results;
 }
 
-stats::NamedStats Aligner::sample_stats() const { return stats::from_obj(m_work_queue); }
+stats::NamedStats Aligner::sample_stats() const { return stats::from_obj(*m_work_queue); }
 
 }  // namespace dorado
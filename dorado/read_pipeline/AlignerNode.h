@@ -5,8 +5,9 @@
 #include "utils/stats.h"
 #include "utils/types.h"
 
-#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace dorado {
 
@@ -19,7 +20,8 @@ public:
             int k,
             int w,
             uint64_t index_batch_size,
-            int threads);
+            int threads,
+            QueueBackend queue_backend = QueueBackend::MUTEX);
     ~Aligner();
     std::string get_name() const override { return "Aligner"; }
     stats::NamedStats sample_stats() const override;
@@ -27,12 +29,12 @@ public:
     sq_t get_sequence_records_for_header();
 
 private:
-    MessageSink& m_sink;
+    // Most reads aligned at once, on the shared executor.  Also used for indexing.
     size_t m_threads{1};
-    std::atomic<size_t> m_active{0};
+    // Thread buffer for each parallel_for slot.
     std::vector<mm_tbuf_t*> m_tbufs;
-    std::vector<std::unique_ptr<std::thread>> m_workers;
-    void worker_thread(size_t tid);
+    std::thread m_worker;
+    void worker_thread();
     void add_tags(bam1_t*, const mm_reg1_t*, const std::string&, const mm_tbuf_t*);
 
     mm_idxopt_t m_idx_opt;
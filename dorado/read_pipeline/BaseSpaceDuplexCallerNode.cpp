@@ -74,7 +74,7 @@ void BaseSpaceDuplexCallerNode::worker_thread() {
     }
 
     // Notify the sink that the Node has terminated
-    m_sink.terminate();
+    terminate_outputs();
 }
 
 void BaseSpaceDuplexCallerNode::basespace(std::string template_read_id,
@@ -171,7 +171,7 @@ void BaseSpaceDuplexCallerNode::basespace(std::string template_read_id,
         duplex_read->read_id = template_read->read_id + ";" + complement_read->read_id;
         duplex_read->read_tag = template_read->read_tag;
 
-        m_sink.push_message(duplex_read);
+        send_message_to_sink(duplex_read);
     }
     edlibFreeAlignResult(result);
 }
@@ -182,10 +182,10 @@ BaseSpaceDuplexCallerNode::BaseSpaceDuplexCallerNode(
         read_map reads,
         size_t threads)
         : MessageSink(1000),
-          m_sink(sink),
           m_template_complement_map(std::move(template_complement_map)),
           m_reads(std::move(reads)),
           m_num_worker_threads(threads) {
+    add_output(sink);
     m_worker_thread =
             std::make_unique<std::thread>(&BaseSpaceDuplexCallerNode::worker_thread, this);
 }
@@ -194,7 +194,7 @@ BaseSpaceDuplexCallerNode::~BaseSpaceDuplexCallerNode() {
     terminate();
     m_worker_thread->join();
     // Notify the sink that the Node has terminated
-    m_sink.terminate();
+    terminate_outputs();
 }
 
 }  // namespace dorado
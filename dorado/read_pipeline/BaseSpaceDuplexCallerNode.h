@@ -18,8 +18,6 @@ public:
 private:
     void worker_thread();
     void basespace(std::string template_read_id, std::string complement_read_id);
-    MessageSink&
-            m_sink;  // MessageSink to consume Duplex Called Reads. This will typically be a writer node
     size_t m_num_worker_threads{1};
     std::unique_ptr<std::thread> m_worker_thread;
     std::map<std::string, std::string> m_template_complement_map;
@@ -1,14 +1,22 @@
 #include "BasecallerNode.h"
 
 #include "../decode/CPUDecoder.h"
+#include "utils/AdaptiveBatchTimeout.h"
 #include "utils/stats.h"
 #include "utils/stitch.h"
 
 #include <nvtx3/nvtx3.hpp>
 
+#include <algorithm>
+#include <cassert>
 #include <chrono>
 #include <cstdlib>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
 
 #if defined(__APPLE__) && !defined(__x86_64__)
 #include "utils/metal_utils.h"
@@ -19,33 +27,40 @@ using namespace torch::indexing;
 
 namespace dorado {
 
-void BasecallerNode::input_worker_thread() {
-    Message message;
-
-    // Allow 5 batches per model runner on the chunks_in queue
-    size_t max_chunks_in = 0;
-    // Allows optimal batch size to be used for every GPU
-    for (auto &runner : m_model_runners) {
-        max_chunks_in += runner->batch_size() * 5;
+BasecallerNode::ChunkQueue &BasecallerNode::select_chunk_queue(size_t raw_size) {
+    ChunkQueue *best_queue = nullptr;
+    size_t best_samples = std::numeric_limits<size_t>::max();
+    // Queues are largest chunk size first, so ties go to the larger chunks, which have fewer
+    // joins between them.
+    for (auto &queue : m_chunk_queues) {
+        // As chunked by input_worker_thread: the first chunk, then one per step, rounded up.
+        const size_t chunk_size = queue->chunk_size;
+        const size_t step = chunk_size - m_overlap;
+        const size_t num_chunks =
+                raw_size <= chunk_size ? 1 : 1 + (raw_size - chunk_size + step - 1) / step;
+        if (num_chunks * chunk_size < best_samples) {
+            best_samples = num_chunks * chunk_size;
+            best_queue = queue.get();
+        }
     }
+    return *best_queue;
+}
 
-    while (m_work_queue.try_pop(message)) {
-        if (std::holds_alternative<CandidatePairRejectedMessage>(message)) {
-            m_sink.push_message(std::move(message));
-            continue;
-        }
+void BasecallerNode::input_worker_thread() {
+    Message message;
 
+    while (m_work_queue->try_pop(message)) {
         // If this message isn't a read, we'll get a bad_variant_access exception.
+        // Reads which have already been basecalled and rejected duplex candidate pairs are
+        // routed around this node by the pipeline, so everything arriving here needs calling.
         auto read = std::get<std::shared_ptr<Read>>(message);
-        // If a read has already been basecalled, just send it to the sink without basecalling again
-        // TODO: This is necessary because some reads (e.g failed Stereo Encoding) will be passed
-        // to the basecaller node having already been called. This should be fixed in the future with
-        // support for graphs of nodes rather than linear pipelines.
-        if (!read->seq.empty()) {
-            m_sink.push_message(read);
-            continue;
-        }
-        // Now that we have acquired a read, wait until we can push to chunks_in
+        size_t raw_size =
+                read->raw_data.sizes()[read->raw_data.sizes().size() - 1];  // Time dimension.
+        auto &queue = select_chunk_queue(raw_size);
+        const size_t chunk_size = queue.chunk_size;
+        // Batches for this queue wait for the read's chunks rather than flushing on idling.
+        ++queue.num_staging_reads;
+        // Now that we have acquired a read, wait until we can push to its chunk queue
         while (true) {
             std::unique_lock<std::mutex> chunk_lock(m_chunks_in_mutex);
             // A new condition was added to the condition variable which adjusts the predicate
@@ -56,50 +71,61 @@ void BasecallerNode::input_worker_thread() {
             // This change below more effectively puts a ceiling on the host memory usage.
             // Keeping the condition a function of the current sink size (empmirically at 5k reads this
             // caps memory around 30GB).
-            m_chunks_in_has_space_cv.wait_for(chunk_lock, 10ms, [this, &max_chunks_in] {
+            m_chunks_in_has_space_cv.wait_for(chunk_lock, 10ms, [this, &queue] {
                 auto under_read_limit =
-                        m_in_duplex_pipeline ? (m_working_reads.size() < 5 * m_max_reads) : true;
-                return (m_chunks_in.size() < max_chunks_in) && under_read_limit;
+                        m_in_duplex_pipeline
+                                ? (static_cast<size_t>(m_working_reads_size.load()) <
+                                   5 * m_max_reads)
+                                : true;
+                return (queue.chunks.size() < queue.max_chunks) && under_read_limit;
             });
 
-            if (m_chunks_in.size() >= max_chunks_in) {
+            if (queue.chunks.size() >= queue.max_chunks) {
                 continue;
             }
 
             // Chunk up the read and put the chunks into the pending chunk list.
-            size_t raw_size =
-                    read->raw_data.sizes()[read->raw_data.sizes().size() - 1];  // Time dimension.
-
+            auto arena = acquire_chunk_arena();
+            auto &chunks = arena->chunks;
             size_t offset = 0;
             size_t chunk_in_read_idx = 0;
-            size_t signal_chunk_step = m_chunk_size - m_overlap;
-            m_chunks_in.push_back(
-                    std::make_shared<Chunk>(read, offset, chunk_in_read_idx++, m_chunk_size));
-            read->num_chunks = 1;
-            auto last_chunk_offset = raw_size - m_chunk_size;
+            size_t signal_chunk_step = chunk_size - m_overlap;
+            chunks.emplace_back(read.get(), offset, chunk_in_read_idx++, chunk_size);
+            auto last_chunk_offset = raw_size - chunk_size;
             auto misalignment = last_chunk_offset % m_model_stride;
             if (misalignment != 0) {
                 // move last chunk start to the next stride boundary. we'll zero pad any excess samples required.
                 last_chunk_offset += m_model_stride - misalignment;
             }
-            while (offset + m_chunk_size < raw_size) {
+            while (offset + chunk_size < raw_size) {
                 offset = std::min(offset + signal_chunk_step, last_chunk_offset);
-                m_chunks_in.push_back(
-                        std::make_shared<Chunk>(read, offset, chunk_in_read_idx++, m_chunk_size));
-                read->num_chunks++;
+                chunks.emplace_back(read.get(), offset, chunk_in_read_idx++, chunk_size);
             }
-            read->called_chunks.resize(read->num_chunks);
+            // Calls have one move per stride, and at most one base per move.
+            arena->init_calls(chunk_size / m_model_stride);
+            read->num_chunks = chunks.size();
+            read->chunk_arena = std::move(arena);
             read->num_chunks_called.store(0);
-            chunk_lock.unlock();
 
-            // Put the read in the working list
+            // Put the read in the working list before its chunks can be called, so that it's
+            // there to be completed when the last of them is.
             {
                 std::lock_guard working_reads_lock(m_working_reads_mutex);
-                m_working_reads.push_back(std::move(read));
+                Read *read_key = read.get();
+                m_working_reads.emplace(
+                        read_key, WorkingRead{std::move(read), std::chrono::steady_clock::now()});
                 ++m_working_reads_size;
             }
 
-            m_chunks_added_cv.notify_one();
+            // chunks is complete, so pointers to its elements stay valid until the arena is
+            // recycled, which is after they have all been called.
+            for (auto &chunk : chunks) {
+                queue.chunks.push_back(&chunk);
+            }
+            --queue.num_staging_reads;
+            chunk_lock.unlock();
+
+            queue.chunks_added_cv.notify_one();
 
             break;  // Go back to watching the input reads
         }
@@ -107,71 +133,119 @@ void BasecallerNode::input_worker_thread() {
 
     // Notify the basecaller threads that it is safe to gracefully terminate the basecaller
     m_terminate_basecaller.store(true);
-    m_chunks_added_cv.notify_all();
+    for (auto &queue : m_chunk_queues) {
+        queue->chunks_added_cv.notify_all();
+    }
+}
+
+std::unique_ptr<ChunkArena> BasecallerNode::acquire_chunk_arena() {
+    std::lock_guard lock(m_chunk_arena_pool_mutex);
+    if (m_chunk_arena_pool.empty()) {
+        return std::make_unique<ChunkArena>();
+    }
+    auto arena = std::move(m_chunk_arena_pool.back());
+    m_chunk_arena_pool.pop_back();
+    return arena;
+}
+
+void BasecallerNode::recycle_chunk_arena(std::unique_ptr<ChunkArena> arena) {
+    arena->clear();
+    std::lock_guard lock(m_chunk_arena_pool_mutex);
+    if (m_chunk_arena_pool.size() < kMaxPooledChunkArenas) {
+        m_chunk_arena_pool.push_back(std::move(arena));
+    }
 }
 
 void BasecallerNode::basecall_current_batch(int worker_id) {
     NVTX3_FUNC_RANGE();
     auto model_runner = m_model_runners[worker_id];
+    const size_t num_chunks = m_batched_chunks[worker_id].size();
+    const size_t batch_size = model_runner->batch_size();
     dorado::stats::Timer timer;
-    auto decode_results = model_runner->call_chunks(m_batched_chunks[worker_id].size());
+    auto decode_results = model_runner->call_chunks(num_chunks);
     m_call_chunks_ms += timer.GetElapsedMS();
-
-    for (size_t i = 0; i < m_batched_chunks[worker_id].size(); i++) {
-        m_batched_chunks[worker_id][i]->seq = decode_results[i].sequence;
-        m_batched_chunks[worker_id][i]->qstring = decode_results[i].qstring;
-        m_batched_chunks[worker_id][i]->moves = decode_results[i].moves;
+    if (num_chunks < batch_size) {
+        ++m_num_partial_batches_called;
     }
+    m_num_batched_chunks += num_chunks;
+    m_num_batch_slots += batch_size;
 
-    // We need to assign each chunk back to the read it came from
-    for (auto &complete_chunk : m_batched_chunks[worker_id]) {
-        std::shared_ptr<Read> source_read = complete_chunk->source_read.lock();
-        source_read->called_chunks[complete_chunk->idx_in_read] = complete_chunk;
-        ++source_read->num_chunks_called;
+    // Copy each chunk's calls into its read's arena.
+    for (size_t i = 0; i < m_batched_chunks[worker_id].size(); i++) {
+        const Chunk *complete_chunk = m_batched_chunks[worker_id][i];
+        const auto &result = decode_results[i];
+        Read *source_read = complete_chunk->source_read;
+        source_read->chunk_arena->set_calls(complete_chunk->idx_in_read, result.sequence,
+                                            result.qstring, result.moves);
+        source_read->memory_charge.add(result.sequence.size() + result.qstring.size() +
+                                       result.moves.size());
+        // The increment which reaches num_chunks is the last, so every call is in place.
+        if (++source_read->num_chunks_called == source_read->num_chunks) {
+            complete_read(source_read);
+        }
     }
     m_batched_chunks[worker_id].clear();
     ++m_num_batches_called;
 }
 
+void BasecallerNode::complete_read(Read *read) {
+    {
+        std::lock_guard working_reads_lock(m_working_reads_mutex);
+        auto working_read = m_working_reads.extract(read);
+        assert(working_read);
+        m_completed_reads.push_back(std::move(working_read.mapped()));
+    }
+    m_completed_reads_cv.notify_one();
+}
+
 void BasecallerNode::working_reads_manager() {
+    // Decided once reads start arriving, by which time the pipeline is complete.
+    std::optional<bool> release_raw_data;
     while (true) {
         nvtx3::scoped_range loop{"working_reads_manager"};
 
-        std::deque<std::shared_ptr<Read>> completed_reads;
+        std::deque<WorkingRead> completed_reads;
         {
-            std::lock_guard working_reads_lock(m_working_reads_mutex);
-            if (m_terminate_manager.load() && m_working_reads.empty()) {
+            std::unique_lock working_reads_lock(m_working_reads_mutex);
+            m_completed_reads_cv.wait(working_reads_lock, [this] {
+                return !m_completed_reads.empty() ||
+                       (m_terminate_manager.load() && m_working_reads.empty());
+            });
+            if (m_completed_reads.empty()) {
                 break;
             }
-            for (auto read_iter = m_working_reads.begin(); read_iter != m_working_reads.end();) {
-                if ((*read_iter)->num_chunks_called.load() == (*read_iter)->num_chunks) {
-                    (*read_iter)->model_name =
-                            m_model_name;  // Before sending read to sink, assign its model name
-                    completed_reads.push_back(*read_iter);
-                    read_iter = m_working_reads.erase(read_iter);
-                    --m_working_reads_size;
-                } else {
-                    read_iter++;
-                }
-            }
+            completed_reads.swap(m_completed_reads);
         }
-
-        if (completed_reads.empty()) {
-            std::this_thread::sleep_for(10ms);
-        } else {
-            m_chunks_in_has_space_cv.notify_one();
-        }
-
-        for (auto &read : completed_reads) {
+        m_working_reads_size -= completed_reads.size();
+        m_chunks_in_has_space_cv.notify_one();
+
+        for (auto &[read, admit_time] : completed_reads) {
+            read->model_name = m_model_name;  // Before sending read to sink, assign its model name
+            // Reads being recalled with another model give up their earlier calls.
+            read->memory_charge.remove(read->seq.size() + read->qstring.size() +
+                                       read->moves.size());
             utils::stitch_chunks(read);
+            // The chunk calls are superseded by the stitched ones.
+            read->memory_charge.remove(read->chunk_arena->calls_size());
+            read->memory_charge.add(read->seq.size() + read->qstring.size() + read->moves.size());
+            recycle_chunk_arena(std::move(read->chunk_arena));
             ++m_called_reads_pushed;
             m_num_bases_processed += read->seq.length();
             m_num_samples_processed += read->raw_data.size(0);
-            m_sink.push_message(std::move(read));
+            if (!release_raw_data) {
+                release_raw_data = !downstream_needs_raw_data();
+            }
+            if (*release_raw_data) {
+                read->release_raw_data();
+            }
+            m_read_latency_ns.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now() - admit_time)
+                                             .count());
+            send_message_to_sink(std::move(read));
         }
     }
 
-    m_sink.terminate();
+    terminate_outputs();
 }
 
 void BasecallerNode::basecall_worker_thread(int worker_id) {
@@ -179,31 +253,48 @@ void BasecallerNode::basecall_worker_thread(int worker_id) {
     // Model execution creates GPU-related autorelease objects.
     utils::ScopedAutoReleasePool autorelease_pool;
 #endif
-    auto last_chunk_reserve_time = std::chrono::system_clock::now();
+    // Partial batches are called within the batch timeout, or sooner if chunks stop arriving.
+    utils::AdaptiveBatchTimeout batch_timeout(std::chrono::milliseconds(m_batch_timeout_ms));
+    auto call_batch = [this, worker_id, &batch_timeout] {
+        basecall_current_batch(worker_id);
+        batch_timeout.batch_called();
+    };
     int batch_size = m_model_runners[worker_id]->batch_size();
+    auto &queue = *m_runner_chunk_queues[worker_id];
+    const size_t chunk_size = queue.chunk_size;
+    // Chunks on their way to this worker's batch: queued, or being chunked from a read.
+    // Each staging read has at least one chunk.  Called with m_chunks_in_mutex held.
+    auto num_pending_chunks = [&queue] {
+        return queue.chunks.size() + queue.num_staging_reads.load();
+    };
     while (true) {
         std::unique_lock<std::mutex> chunks_lock(m_chunks_in_mutex);
-        if (!m_chunks_added_cv.wait_until(
+        if (!queue.chunks_added_cv.wait_until(
                     chunks_lock,
-                    last_chunk_reserve_time + std::chrono::milliseconds(m_batch_timeout_ms),
-                    [this] { return !m_chunks_in.empty() || m_terminate_basecaller.load(); })) {
+                    batch_timeout.flush_deadline(utils::AdaptiveBatchTimeout::Clock::now(),
+                                                 num_pending_chunks()),
+                    [this, &queue] {
+                        return !queue.chunks.empty() || m_terminate_basecaller.load();
+                    })) {
             // timeout without new chunks or termination call
+            // A read may have started staging while waiting, in which case wait on for it.
+            const auto now = utils::AdaptiveBatchTimeout::Clock::now();
+            if (batch_timeout.flush_deadline(now, num_pending_chunks()) > now) {
+                continue;
+            }
             chunks_lock.unlock();
             if (!m_batched_chunks[worker_id].empty()) {
-                basecall_current_batch(worker_id);
+                call_batch();
             }
-
-            // reset wait period
-            last_chunk_reserve_time = std::chrono::system_clock::now();
             continue;
         }
 
-        if (m_chunks_in.empty() && m_terminate_basecaller.load()) {
+        if (queue.chunks.empty() && m_terminate_basecaller.load()) {
             // no remaining chunks and we've been told to terminate
             // call the remaining batch
             chunks_lock.unlock();  // Not strictly necessary
             if (!m_batched_chunks[worker_id].empty()) {
-                basecall_current_batch(worker_id);
+                call_batch();
             }
 
             // Reduce the count of active runner threads.  If this was the last active
@@ -215,62 +306,77 @@ void BasecallerNode::basecall_worker_thread(int worker_id) {
                 for (auto &runner : m_model_runners) {
                     runner->terminate();
                 }
-                m_terminate_manager.store(true);
+                {
+                    std::lock_guard working_reads_lock(m_working_reads_mutex);
+                    m_terminate_manager.store(true);
+                }
+                m_completed_reads_cv.notify_one();
             }
             return;
         }
 
         // There's chunks to get_scores, so let's add them to our input tensor
-        while (m_batched_chunks[worker_id].size() != batch_size && !m_chunks_in.empty()) {
-            std::shared_ptr<Chunk> chunk = m_chunks_in.front();
-            m_chunks_in.pop_front();
+        const size_t previous_chunk_count = m_batched_chunks[worker_id].size();
+        while (m_batched_chunks[worker_id].size() != batch_size && !queue.chunks.empty()) {
+            Chunk *chunk = queue.chunks.front();
+            queue.chunks.pop_front();
             chunks_lock.unlock();
             m_chunks_in_has_space_cv.notify_one();
 
             // Copy the chunk into the input tensor
-            std::shared_ptr<Read> source_read = chunk->source_read.lock();
-
-            auto input_slice = source_read->raw_data.index(
-                    {Ellipsis, Slice(chunk->input_offset, chunk->input_offset + m_chunk_size)});
-            size_t slice_size;
-            if (input_slice.ndimension() == 1) {
-                slice_size = input_slice.size(0);
+            Read *source_read = chunk->source_read;
+
+            const auto &raw_data = source_read->raw_data;
+            const int chunk_idx = static_cast<int>(m_batched_chunks[worker_id].size());
+            if (raw_data.dtype() == torch::kFloat16 && raw_data.is_contiguous()) {
+                // Copy and repeat-pad the samples straight into the runner's input.
+                // Stereo encodings have a row of samples per feature.
+                const size_t raw_size = raw_data.size(-1);
+                const size_t num_rows = raw_data.dim() == 1 ? 1 : raw_data.size(0);
+                const size_t len = std::min(chunk_size, raw_size - chunk->input_offset);
+                m_num_padding_samples += chunk_size - len;
+                m_model_runners[worker_id]->stage_chunk(
+                        chunk_idx, raw_data.data_ptr<c10::Half>() + chunk->input_offset, len,
+                        num_rows, raw_size, ChunkPadMode::REPEAT);
             } else {
-                slice_size = input_slice.sizes()[1];
-            }
-
-            // repeat-pad any non-full chunks
-            // Stereo and Simplex encoding need to be treated differently
-            if (slice_size != m_chunk_size) {
-                if (input_slice.ndimension() == 1) {
-                    auto [n, overhang] = std::div((int)m_chunk_size, (int)slice_size);
-                    input_slice = torch::concat(
-                            {input_slice.repeat({n}),
-                             input_slice.index({Ellipsis, torch::indexing::Slice(0, overhang)})});
-                } else if (input_slice.ndimension() == 2) {
-                    auto [n, overhang] = std::div((int)m_chunk_size, (int)slice_size);
-                    input_slice = torch::concat(
-                            {input_slice.repeat({1, n}),
-                             input_slice.index({Ellipsis, torch::indexing::Slice(0, overhang)})},
-                            1);
+                auto input_slice = raw_data.index(
+                        {Ellipsis, Slice(chunk->input_offset, chunk->input_offset + chunk_size)});
+                const size_t slice_size = input_slice.size(-1);
+                m_num_padding_samples += chunk_size - slice_size;
+
+                // repeat-pad any non-full chunks
+                // Stereo and Simplex encoding need to be treated differently
+                if (slice_size != chunk_size) {
+                    auto [n, overhang] = std::div((int)chunk_size, (int)slice_size);
+                    if (input_slice.ndimension() == 1) {
+                        input_slice = torch::concat(
+                                {input_slice.repeat({n}),
+                                 input_slice.index({Ellipsis, Slice(0, overhang)})});
+                    } else if (input_slice.ndimension() == 2) {
+                        input_slice = torch::concat(
+                                {input_slice.repeat({1, n}),
+                                 input_slice.index({Ellipsis, Slice(0, overhang)})},
+                                1);
+                    }
                 }
-            }
 
-            // Insert the chunk in the input tensor
-            m_model_runners[worker_id]->accept_chunk(
-                    static_cast<int>(m_batched_chunks[worker_id].size()), input_slice);
+                // Insert the chunk in the input tensor
+                m_model_runners[worker_id]->accept_chunk(chunk_idx, input_slice);
+            }
 
             m_batched_chunks[worker_id].push_back(chunk);
+            m_num_chunk_samples += chunk_size;
+            ++queue.num_chunks_called;
             chunks_lock.lock();
-
-            last_chunk_reserve_time = std::chrono::system_clock::now();
         }
 
         chunks_lock.unlock();
+        batch_timeout.chunks_added(m_batched_chunks[worker_id].size() - previous_chunk_count,
+                                   utils::AdaptiveBatchTimeout::Clock::now());
 
         if (m_batched_chunks[worker_id].size() == batch_size) {
             // Input tensor is full, let's get_scores.
-            basecall_current_batch(worker_id);
+            call_batch();
         }
     }
 }
@@ -284,9 +390,7 @@ BasecallerNode::BasecallerNode(MessageSink &sink,
                                const std::string &node_name,
                                bool in_duplex_pipeline)
         : MessageSink(max_reads),
-          m_sink(sink),
           m_model_runners(std::move(model_runners)),
-          m_chunk_size(m_model_runners.front()->chunk_size()),
           m_overlap(overlap),
           m_model_stride(m_model_runners.front()->model_stride()),
           m_terminate_basecaller(false),
@@ -295,12 +399,39 @@ BasecallerNode::BasecallerNode(MessageSink &sink,
           m_max_reads(max_reads),
           m_in_duplex_pipeline(in_duplex_pipeline),
           m_node_name(node_name) {
+    add_output(sink);
     // Setup worker state
     size_t const num_workers = m_model_runners.size();
     m_batched_chunks.resize(num_workers);
     m_basecall_workers.resize(num_workers);
     m_num_active_model_runners = num_workers;
 
+    // A queue per distinct runner chunk size, largest first.
+    std::vector<size_t> chunk_sizes;
+    for (auto &runner : m_model_runners) {
+        chunk_sizes.push_back(runner->chunk_size());
+    }
+    std::sort(chunk_sizes.begin(), chunk_sizes.end(), std::greater<size_t>());
+    chunk_sizes.erase(std::unique(chunk_sizes.begin(), chunk_sizes.end()), chunk_sizes.end());
+    for (auto chunk_size : chunk_sizes) {
+        if (chunk_size <= m_overlap) {
+            throw std::runtime_error("Chunk size " + std::to_string(chunk_size) +
+                                     " must be larger than the overlap " +
+                                     std::to_string(m_overlap));
+        }
+        m_chunk_queues.push_back(std::make_unique<ChunkQueue>(chunk_size));
+    }
+    for (auto &runner : m_model_runners) {
+        auto &queue = *std::find_if(m_chunk_queues.begin(), m_chunk_queues.end(),
+                                    [&runner](const auto &q) {
+                                        return q->chunk_size == runner->chunk_size();
+                                    });
+        // Allow 5 batches per model runner on its chunk queue.
+        // Allows optimal batch size to be used for every GPU.
+        queue->max_chunks += runner->batch_size() * 5;
+        m_runner_chunk_queues.push_back(queue.get());
+    }
+
     initialization_time = std::chrono::system_clock::now();
 
     // Spin up any workers last so that we're not mutating |this| underneath them
@@ -322,18 +453,39 @@ BasecallerNode::~BasecallerNode() {
 }
 
 stats::NamedStats BasecallerNode::sample_stats() const {
-    stats::NamedStats stats = stats::from_obj(m_work_queue);
+    stats::NamedStats stats = stats::from_obj(*m_work_queue);
     for (const auto &runner : m_model_runners) {
         const auto runner_stats = stats::from_obj(*runner);
         stats.insert(runner_stats.begin(), runner_stats.end());
     }
     stats["batches_called"] = m_num_batches_called;
     stats["partial_batches_called"] = m_num_partial_batches_called;
+    if (m_num_batch_slots > 0) {
+        stats["batch_fill_fraction"] =
+                static_cast<double>(m_num_batched_chunks) / m_num_batch_slots;
+    }
     stats["call_chunks_ms"] = m_call_chunks_ms;
     stats["called_reads_pushed"] = m_called_reads_pushed;
     stats["working_reads_items"] = m_working_reads_size;
     stats["bases_processed"] = m_num_bases_processed;
     stats["samples_processed"] = m_num_samples_processed;
+    // How much of the signal called was padding of chunks beyond the ends of reads.
+    stats["chunk_samples"] = m_num_chunk_samples;
+    stats["padding_samples"] = m_num_padding_samples;
+    if (m_num_chunk_samples > 0) {
+        stats["padding_fraction"] =
+                static_cast<double>(m_num_padding_samples) / m_num_chunk_samples;
+    }
+    for (const auto &queue : m_chunk_queues) {
+        stats["chunks_called_" + std::to_string(queue->chunk_size)] = queue->num_chunks_called;
+    }
+    // Time from reads' chunks being queued to the reads being sent on.
+    const auto latency = m_read_latency_ns.sample();
+    constexpr double kNsPerMs = 1e6;
+    stats["read_latency_p50_ms"] = latency.p50 / kNsPerMs;
+    stats["read_latency_p90_ms"] = latency.p90 / kNsPerMs;
+    stats["read_latency_p99_ms"] = latency.p99 / kNsPerMs;
+    stats["read_latency_max_ms"] = latency.max / kNsPerMs;
     return stats;
 }
 
@@ -2,16 +2,25 @@
 
 #include "../nn/ModelRunner.h"
 #include "ReadPipeline.h"
+#include "utils/LogHistogram.h"
 #include "utils/stats.h"
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace dorado {
 
 class BasecallerNode : public MessageSink {
 public:
-    // Chunk size and overlap are in raw samples
+    // Chunk size and overlap are in raw samples.  Runners may have different chunk sizes, in
+    // which case each read is called in chunks of whichever size computes the fewest samples.
     BasecallerNode(MessageSink& sink,
                    std::vector<Runner> model_runners,
                    size_t overlap,
@@ -23,27 +32,50 @@ public:
     ~BasecallerNode();
     std::string get_name() const override { return m_node_name; }
     stats::NamedStats sample_stats() const override;
+    bool needs_raw_data() const override { return true; }
 
 private:
+    // Chunks waiting to be called by the runners with one chunk size.
+    struct ChunkQueue {
+        explicit ChunkQueue(size_t chunk_size_) : chunk_size(chunk_size_) {}
+        const size_t chunk_size;
+        // Limit on the number of queued chunks.
+        size_t max_chunks{0};
+        // Guarded by m_chunks_in_mutex.
+        std::deque<Chunk*> chunks;
+        // Signalled when chunks are added to chunks
+        std::condition_variable chunks_added_cv;
+        // Chunks called, for stats.
+        std::atomic<int64_t> num_chunks_called{0};
+        // Reads taken by input_worker_thread for this queue whose chunks aren't queued yet.
+        std::atomic<size_t> num_staging_reads{0};
+    };
+
+    // The queue for the chunk size which calls a read of raw_size samples with the fewest
+    // samples, including padding and overlaps.
+    ChunkQueue& select_chunk_queue(size_t raw_size);
     // Consume reads from input queue
     void input_worker_thread();
     // Basecall reads
     void basecall_worker_thread(int worker_id);
     // Basecall batch of chunks
     void basecall_current_batch(int worker_id);
-    // Construct complete reads
+    // Move a read whose last chunk has been called to the completed reads queue.
+    void complete_read(Read* read);
+    // Stitch and send on completed reads as they arrive.
     void working_reads_manager();
+    // Take an arena from the pool, or a new one if it's empty.
+    std::unique_ptr<ChunkArena> acquire_chunk_arena();
+    // Return an arena to the pool once its read has been stitched.
+    void recycle_chunk_arena(std::unique_ptr<ChunkArena> arena);
 
-    MessageSink& m_sink;
     // Vector of model runners (each with their own GPU access etc)
     std::vector<Runner> m_model_runners;
-    // Chunk length
-    size_t m_chunk_size;
     // Minimum overlap between two adjacent chunks in a read. Overlap is used to reduce edge effects and improve accuracy.
     size_t m_overlap;
     // Stride of the model in the runners
     size_t m_model_stride;
-    // Time in milliseconds before partial batches are called.
+    // Longest time in milliseconds a chunk waits in a partial batch before it's called.
     int m_batch_timeout_ms;
     // model_name
     std::string m_model_name;
@@ -62,21 +94,38 @@ private:
     std::chrono::time_point<std::chrono::system_clock> initialization_time;
     // Time when Basecaller Node terminates. Used for benchmarking and debugging
     std::chrono::time_point<std::chrono::system_clock> termination_time;
-    // Signalled when there is space in m_chunks_in
+    // Signalled when there is space in the chunk queues
     std::condition_variable m_chunks_in_has_space_cv;
-    // Global chunk input list
+    // Guards the chunk queues
     std::mutex m_chunks_in_mutex;
-    // Signalled when chunks are added to m_chunks_in
-    std::condition_variable m_chunks_added_cv;
-    // Gets filled with chunks from the input reads
-    std::deque<std::shared_ptr<Chunk>> m_chunks_in;
+    // Gets filled with chunks from the input reads, one queue per runner chunk size, largest
+    // first.
+    std::vector<std::unique_ptr<ChunkQueue>> m_chunk_queues;
+    // The queue each runner takes its chunks from.
+    std::vector<ChunkQueue*> m_runner_chunk_queues;
 
+    struct WorkingRead {
+        std::shared_ptr<Read> read;
+        // When the read's chunks were queued for calling.
+        std::chrono::steady_clock::time_point admit_time;
+    };
+    // Guards m_working_reads and m_completed_reads.
     std::mutex m_working_reads_mutex;
-    // Reads removed from input queue and being basecalled.
-    std::deque<std::shared_ptr<Read>> m_working_reads;
+    // Reads removed from input queue and being basecalled, keyed by the chunks' source_read.
+    std::unordered_map<Read*, WorkingRead> m_working_reads;
+    // Reads with every chunk called, waiting to be stitched.
+    std::deque<WorkingRead> m_completed_reads;
+    // Signalled when reads are added to m_completed_reads, or the manager should terminate.
+    std::condition_variable m_completed_reads_cv;
 
     // If we go multi-threaded, there will be one of these batches per thread
-    std::vector<std::deque<std::shared_ptr<Chunk>>> m_batched_chunks;
+    std::vector<std::deque<Chunk*>> m_batched_chunks;
+
+    // Arenas of reads which have been stitched, ready for reuse.  Bounded so that a burst
+    // of long reads doesn't pin their memory indefinitely.
+    static constexpr size_t kMaxPooledChunkArenas = 64;
+    std::mutex m_chunk_arena_pool_mutex;
+    std::vector<std::unique_ptr<ChunkArena>> m_chunk_arena_pool;
 
     // Class members are initialised in declaration order regardless of initialiser list order.
     // Class data members whose construction launches threads must therefore have their
@@ -93,11 +142,19 @@ private:
     std::string m_node_name;
     std::atomic<int64_t> m_num_batches_called = 0;
     std::atomic<int64_t> m_num_partial_batches_called = 0;
+    // Chunks in the batches called, and the batches' capacity, for how full batches were.
+    std::atomic<int64_t> m_num_batched_chunks = 0;
+    std::atomic<int64_t> m_num_batch_slots = 0;
     std::atomic<int64_t> m_call_chunks_ms = 0;
     std::atomic<int64_t> m_called_reads_pushed = 0;
     std::atomic<int64_t> m_working_reads_size = 0;
     std::atomic<int64_t> m_num_bases_processed = 0;
     std::atomic<int64_t> m_num_samples_processed = 0;
+    // Samples in called chunks, and how many of those were padding.
+    std::atomic<int64_t> m_num_chunk_samples = 0;
+    std::atomic<int64_t> m_num_padding_samples = 0;
+    // Time from each read being admitted to it being sent on.
+    utils::LogHistogram m_read_latency_ns;
 };
 
 }  // namespace dorado
@@ -192,6 +192,11 @@ std::shared_ptr<Read> subread(const Read& read, PosRange seq_range, PosRange sig
     } else {
         subread->parent_read_id = read.read_id;
     }
+
+    // The subread's signal is a view of the parent's, so outlives the parent's charge.
+    subread->memory_charge = read.memory_charge.derive(
+            subread->raw_data.numel() * subread->raw_data.element_size() + subread->seq.size() +
+            subread->qstring.size() + subread->moves.size());
     return subread;
 }
 
@@ -433,15 +438,15 @@ void DuplexSplitNode::worker_thread() {
     m_active++;  // Track active threads.
     Message message;
 
-    while (m_work_queue.try_pop(message)) {
+    while (m_work_queue->try_pop(message)) {
         if (!m_settings.enabled) {
-            m_sink.push_message(std::move(message));
+            send_message_to_sink(std::move(message));
         } else {
             // If this message isn't a read, we'll get a bad_variant_access exception.
             auto init_read = std::get<std::shared_ptr<Read>>(message);
             for (auto& subread : split(init_read)) {
                 //TODO correctly process end_reason when we have them
-                m_sink.push_message(std::move(subread));
+                send_message_to_sink(std::move(subread));
             }
         }
     }
@@ -449,7 +454,7 @@ void DuplexSplitNode::worker_thread() {
     int num_active = --m_active;
     if (num_active == 0) {
         terminate();
-        m_sink.terminate();
+        terminate_outputs();
     }
 }
 
@@ -458,9 +463,9 @@ DuplexSplitNode::DuplexSplitNode(MessageSink& sink,
                                  int num_worker_threads,
                                  size_t max_reads)
         : MessageSink(max_reads),
-          m_sink(sink),
           m_settings(std::move(settings)),
           m_num_worker_threads(num_worker_threads) {
+    add_output(sink);
     m_split_finders = build_split_finders();
     for (int i = 0; i < m_num_worker_threads; i++) {
         worker_threads.push_back(
@@ -477,9 +482,9 @@ DuplexSplitNode::~DuplexSplitNode() {
     }
 
     // Notify the sink that the Node has terminated
-    m_sink.terminate();
+    terminate_outputs();
 }
 
-stats::NamedStats DuplexSplitNode::sample_stats() const { return stats::from_obj(m_work_queue); }
+stats::NamedStats DuplexSplitNode::sample_stats() const { return stats::from_obj(*m_work_queue); }
 
 }  // namespace dorado
@@ -55,6 +55,7 @@ public:
     ~DuplexSplitNode();
     std::string get_name() const override { return "DuplexSplitNode"; }
     stats::NamedStats sample_stats() const override;
+    bool needs_raw_data() const override { return true; }
 
     std::vector<std::shared_ptr<Read>> split(std::shared_ptr<Read> init_read) const;
 
@@ -81,7 +82,6 @@ private:
     std::vector<std::pair<std::string, SplitFinderF>> build_split_finders() const;
 
     void worker_thread();  // Worker thread performs splitting asynchronously.
-    MessageSink& m_sink;   // MessageSink to consume scaled reads.
 
     const DuplexSplitSettings m_settings;
     std::vector<std::pair<std::string, SplitFinderF>> m_split_finders;
@@ -15,8 +15,12 @@
 
 namespace dorado {
 
-HtsWriter::HtsWriter(const std::string& filename, OutputMode mode, size_t threads, size_t num_reads)
-        : MessageSink(10000), m_num_reads_expected(num_reads) {
+HtsWriter::HtsWriter(const std::string& filename,
+                     OutputMode mode,
+                     size_t threads,
+                     size_t num_reads,
+                     QueueBackend queue_backend)
+        : MessageSink(10000, queue_backend), m_num_reads_expected(num_reads) {
     switch (mode) {
     case FASTQ:
         m_file = hts_open(filename.c_str(), "wf");
@@ -72,21 +76,24 @@ void HtsWriter::join() { m_worker->join(); }
 void HtsWriter::worker_thread() {
     size_t write_count = 0;
 
-    Message message;
-    while (m_work_queue.try_pop(message)) {
-        auto aln = std::get<BamPtr>(std::move(message));
-        write(aln.get());
-        std::string read_id = bam_get_qname(aln.get());
-        aln.reset();  // Free the bam alignment that's already written
-
-        // For the purpose of estimating write count, we ignore duplex reads
-        // these can be identified by a semicolon in their ID.
-        // TODO: This is a hack, we should have a better way of identifying duplex reads.
-        bool ignore_read_id = read_id.find(';') != std::string::npos;
-
-        if (!ignore_read_id) {
-            m_processed_read_ids.insert(std::move(read_id));
+    std::vector<Message> messages;
+    while (m_work_queue->try_pop_batch(messages, kMaxMessageBatchSize)) {
+        for (auto& message : messages) {
+            auto aln = std::get<BamPtr>(std::move(message));
+            write(aln.get());
+            std::string read_id = bam_get_qname(aln.get());
+            aln.reset();  // Free the bam alignment that's already written
+
+            // For the purpose of estimating write count, we ignore duplex reads
+            // these can be identified by a semicolon in their ID.
+            // TODO: This is a hack, we should have a better way of identifying duplex reads.
+            bool ignore_read_id = read_id.find(';') != std::string::npos;
+
+            if (!ignore_read_id) {
+                m_processed_read_ids.insert(std::move(read_id));
+            }
         }
+        messages.clear();
     }
     spdlog::debug("Written {} records.", write_count);
 }
@@ -121,7 +128,7 @@ int HtsWriter::write_header(const sam_hdr_t* hdr) {
 }
 
 stats::NamedStats HtsWriter::sample_stats() const {
-    auto stats = stats::from_obj(m_work_queue);
+    auto stats = stats::from_obj(*m_work_queue);
     stats["unique_simplex_reads_written"] = m_processed_read_ids.size();
     return stats;
 }
@@ -23,7 +23,11 @@ public:
         FASTQ,
     };
 
-    HtsWriter(const std::string& filename, OutputMode mode, size_t threads, size_t num_reads);
+    HtsWriter(const std::string& filename,
+              OutputMode mode,
+              size_t threads,
+              size_t num_reads,
+              QueueBackend queue_backend = QueueBackend::MUTEX);
     ~HtsWriter();
     std::string get_name() const override { return "HtsWriter"; }
     stats::NamedStats sample_stats() const override;
@@ -3,6 +3,7 @@
 #include "modbase/remora_encoder.h"
 #include "modbase/remora_utils.h"
 #include "nn/ModBaseRunner.h"
+#include "utils/AdaptiveBatchTimeout.h"
 #include "utils/base_mod_utils.h"
 #include "utils/math_utils.h"
 #include "utils/sequence_utils.h"
@@ -14,23 +15,24 @@
 
 #include <chrono>
 #include <cstring>
+#include <optional>
 using namespace std::chrono_literals;
 
 namespace dorado {
 
-constexpr auto FORCE_TIMEOUT = 100ms;
-
 ModBaseCallerNode::ModBaseCallerNode(MessageSink& sink,
                                      std::vector<std::unique_ptr<ModBaseRunner>> model_runners,
                                      size_t remora_threads,
                                      size_t block_stride,
                                      size_t batch_size,
-                                     size_t max_reads)
+                                     size_t max_reads,
+                                     int batch_timeout_ms)
         : MessageSink(max_reads),
-          m_sink(sink),
           m_batch_size(batch_size),
           m_block_stride(block_stride),
+          m_batch_timeout_ms(batch_timeout_ms),
           m_runners(std::move(model_runners)) {
+    add_output(sink);
     init_modbase_info();
 
     m_output_worker = std::make_unique<std::thread>(&ModBaseCallerNode::output_worker_thread, this);
@@ -136,8 +138,10 @@ void ModBaseCallerNode::init_modbase_info() {
 }
 
 void ModBaseCallerNode::input_worker_thread() {
+    // Decided once reads start arriving, by which time the pipeline is complete.
+    std::optional<bool> release_raw_data;
     Message message;
-    while (m_work_queue.try_pop(message)) {
+    while (m_work_queue->try_pop(message)) {
         nvtx3::scoped_range range{"modbase_input_worker_thread"};
         // If this message isn't a read, we'll get a bad_variant_access exception.
         auto read = std::get<std::shared_ptr<Read>>(message);
@@ -223,13 +227,21 @@ void ModBaseCallerNode::input_worker_thread() {
             }
             m_chunk_generation_ms += timer.GetElapsedMS();
 
+            // The chunks hold their own copies of the scaled signal.
+            if (!release_raw_data) {
+                release_raw_data = !downstream_needs_raw_data();
+            }
+            if (*release_raw_data) {
+                read->release_raw_data();
+            }
+
             if (read->num_modbase_chunks != 0) {
                 // Put the read in the working list
                 std::scoped_lock<std::mutex> working_reads_lock(m_working_reads_mutex);
                 m_working_reads.push_back(read);
             } else {
                 // No modbases to call, pass directly to next node
-                m_sink.push_message(read);
+                send_message_to_sink(read);
                 ++m_num_non_mod_base_reads_pushed;
             }
             break;
@@ -248,23 +260,27 @@ void ModBaseCallerNode::modbasecall_worker_thread(size_t worker_id, size_t calle
     auto& chunk_queue = m_chunk_queues[caller_id];
 
     auto batched_chunks = std::vector<std::shared_ptr<RemoraChunk>>{};
-    auto last_chunk_reserve_time = std::chrono::system_clock::now();
+    // Partial batches are called within the batch timeout, or sooner if chunks stop arriving.
+    utils::AdaptiveBatchTimeout batch_timeout(std::chrono::milliseconds(m_batch_timeout_ms));
+    auto call_batch = [&] {
+        call_current_batch(worker_id, caller_id, batched_chunks);
+        batch_timeout.batch_called();
+    };
 
     while (true) {
         nvtx3::scoped_range range{"modbasecall_worker_thread"};
         std::unique_lock<std::mutex> chunks_lock(m_chunk_queues_mutex);
         if (!m_chunks_added_cv.wait_until(
-                    chunks_lock, last_chunk_reserve_time + FORCE_TIMEOUT, [&chunk_queue, this] {
+                    chunks_lock,
+                    batch_timeout.flush_deadline(utils::AdaptiveBatchTimeout::Clock::now()),
+                    [&chunk_queue, this] {
                         return !chunk_queue.empty() || m_terminate_runners.load();
                     })) {
             // timeout without new chunks or termination call
             chunks_lock.unlock();
             if (!batched_chunks.empty()) {
-                call_current_batch(worker_id, caller_id, batched_chunks);
+                call_batch();
             }
-
-            // reset wait period
-            last_chunk_reserve_time = std::chrono::system_clock::now();
             continue;
         }
 
@@ -273,7 +289,7 @@ void ModBaseCallerNode::modbasecall_worker_thread(size_t worker_id, size_t calle
             // call the remaining batch
             chunks_lock.unlock();  // Not strictly necessary
             if (!batched_chunks.empty()) {
-                call_current_batch(worker_id, caller_id, batched_chunks);
+                call_batch();
             }
 
             // Reduce the count of active runner threads.  If this was the last active
@@ -305,9 +321,10 @@ void ModBaseCallerNode::modbasecall_worker_thread(size_t worker_id, size_t calle
                 std::shared_ptr<RemoraChunk> chunk = chunk_queue.front();
                 chunk_queue.pop_front();
                 batched_chunks.push_back(chunk);
-                last_chunk_reserve_time = std::chrono::system_clock::now();
             }
         }
+        batch_timeout.chunks_added(batched_chunks.size() - previous_chunk_count,
+                                   utils::AdaptiveBatchTimeout::Clock::now());
         // Relinquish the chunk queue mutex, allowing other chunk queue
         // activity to progress.
         chunks_lock.unlock();
@@ -322,7 +339,7 @@ void ModBaseCallerNode::modbasecall_worker_thread(size_t worker_id, size_t calle
 
         if (batched_chunks.size() == m_batch_size) {
             // Input tensor is full, let's get_scores.
-            call_current_batch(worker_id, caller_id, batched_chunks);
+            call_batch();
         }
     }
 }
@@ -336,6 +353,10 @@ void ModBaseCallerNode::call_current_batch(
     dorado::stats::Timer timer;
     auto results = m_runners[worker_id]->call_chunks(caller_id, batched_chunks.size());
     m_call_chunks_ms += timer.GetElapsedMS();
+    if (batched_chunks.size() < m_batch_size) {
+        ++m_num_partial_batches_called;
+    }
+    m_num_batched_chunks += batched_chunks.size();
 
     // Convert results to float32 with one call and address via a raw pointer,
     // to avoid huge libtorch indexing overhead.
@@ -370,7 +391,7 @@ void ModBaseCallerNode::output_worker_thread() {
             return !m_processed_chunks.empty() || m_terminate_output.load();
         });
         if (m_terminate_output.load() && m_processed_chunks.empty()) {
-            m_sink.terminate();
+            terminate_outputs();
             return;
         }
 
@@ -403,20 +424,24 @@ void ModBaseCallerNode::output_worker_thread() {
         }
         working_reads_lock.unlock();
         for (auto& read : completed_reads) {
-            m_sink.push_message(read);
+            send_message_to_sink(read);
             ++m_num_mod_base_reads_pushed;
         }
     }
 }
 
 std::unordered_map<std::string, double> ModBaseCallerNode::sample_stats() const {
-    stats::NamedStats stats = stats::from_obj(m_work_queue);
+    stats::NamedStats stats = stats::from_obj(*m_work_queue);
     for (const auto& runner : m_runners) {
         const auto runner_stats = stats::from_obj(*runner);
         stats.insert(runner_stats.begin(), runner_stats.end());
     }
     stats["batches_called"] = m_num_batches_called;
     stats["partial_batches_called"] = m_num_partial_batches_called;
+    if (m_num_batches_called > 0) {
+        stats["batch_fill_fraction"] = static_cast<double>(m_num_batched_chunks) /
+                                       (m_num_batches_called * m_batch_size);
+    }
     stats["input_chunks_sleeps"] = m_num_input_chunks_sleeps;
     stats["call_chunks_ms"] = m_call_chunks_ms;
     stats["context_hits"] = m_num_context_hits;
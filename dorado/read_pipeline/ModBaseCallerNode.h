@@ -21,10 +21,12 @@ public:
                       size_t remora_threads,
                       size_t block_stride,
                       size_t batch_size,
-                      size_t max_reads = 1000);
+                      size_t max_reads = 1000,
+                      int batch_timeout_ms = 100);
     ~ModBaseCallerNode();
     std::string get_name() const override { return "ModBaseCallerNode"; }
     stats::NamedStats sample_stats() const override;
+    bool needs_raw_data() const override { return true; }
 
     struct Info {
         std::string long_names;
@@ -61,9 +63,10 @@ private:
     // Worker thread, processes chunk results back into the reads
     void output_worker_thread();
 
-    MessageSink& m_sink;
     size_t m_batch_size;
     size_t m_block_stride;
+    // Longest time in milliseconds a chunk waits in a partial batch before it's called.
+    int m_batch_timeout_ms;
 
     std::vector<std::unique_ptr<ModBaseRunner>> m_runners;
 
@@ -99,6 +102,8 @@ private:
     // Performance monitoring stats.
     std::atomic<int64_t> m_num_batches_called = 0;
     std::atomic<int64_t> m_num_partial_batches_called = 0;
+    // Chunks in the batches called, for how full batches were.
+    std::atomic<int64_t> m_num_batched_chunks = 0;
     std::atomic<int64_t> m_num_input_chunks_sleeps = 0;
     std::atomic<int64_t> m_call_chunks_ms = 0;
     std::atomic<int64_t> m_num_context_hits = 0;
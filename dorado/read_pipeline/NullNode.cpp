@@ -7,7 +7,7 @@ namespace dorado {
 
 void NullNode::worker_thread() {
     Message message;
-    while (m_work_queue.try_pop(message)) {
+    while (m_work_queue->try_pop(message)) {
         // Do nothing with the popped message.
     }
 }
@@ -17,7 +17,7 @@ namespace dorado {
 
 void PairingNode::pair_list_worker_thread() {
     Message message;
-    while (m_work_queue.try_pop(message)) {
+    while (m_work_queue->try_pop(message)) {
         // If this message isn't a read, we'll get a bad_variant_access exception.
         auto read = std::get<std::shared_ptr<Read>>(message);
 
@@ -49,6 +49,10 @@ void PairingNode::pair_list_worker_thread() {
             std::unique_lock<std::mutex> read_cache_lock(m_read_cache_mutex);
             if (read_cache.find(partner_id) == read_cache.end()) {
                 // Partner is not in the read cache
+                // Held reads don't count against the in-flight memory budget until they're
+                // sent on.  Their partner may be yet to be admitted, so a small budget could
+                // otherwise leave the loader waiting on reads that are waiting on the loader.
+                read->memory_charge.suspend();
                 read_cache[read->read_id] = read;
                 read_cache_lock.unlock();
             } else {
@@ -56,6 +60,7 @@ void PairingNode::pair_list_worker_thread() {
                 auto partner_read = partner_read_itr->second;
                 read_cache.erase(partner_read_itr);
                 read_cache_lock.unlock();
+                partner_read->memory_charge.resume();
 
                 std::shared_ptr<Read> template_read;
                 std::shared_ptr<Read> complement_read;
@@ -74,18 +79,18 @@ void PairingNode::pair_list_worker_thread() {
 
                 ++template_read->num_duplex_candidate_pairs;
 
-                m_sink.push_message(std::make_shared<ReadPair>(read_pair));
+                send_message_to_sink(std::make_shared<ReadPair>(read_pair));
             }
         }
     }
     if (--m_num_worker_threads == 0) {
-        m_sink.terminate();
+        terminate_outputs();
     }
 }
 
 void PairingNode::pair_generating_worker_thread() {
     Message message;
-    while (m_work_queue.try_pop(message)) {
+    while (m_work_queue->try_pop(message)) {
         // If this message isn't a read, we'll get a bad_variant_access exception.
         auto read = std::get<std::shared_ptr<Read>>(message);
 
@@ -112,7 +117,8 @@ void PairingNode::pair_generating_worker_thread() {
 
                 // Remove the oldest key from the map
                 for (auto read_ptr : oldest_key_it->second) {
-                    m_sink.push_message(read_ptr);
+                    read_ptr->memory_charge.resume();
+                    send_message_to_sink(read_ptr);
                 }
                 channel_mux_read_map.erase(oldest_key);
                 assert(channel_mux_read_map.size() == m_working_channel_mux_keys.size());
@@ -126,6 +132,10 @@ void PairingNode::pair_generating_worker_thread() {
             return read1->attributes.start_time < read2->attributes.start_time;
         };
 
+        // Held reads don't count against the in-flight memory budget until they're sent on.
+        // Their pore is only evicted once reads from others are admitted, so a small budget
+        // could otherwise leave the loader waiting on reads that are waiting on the loader.
+        read->memory_charge.suspend();
         if (channel_mux_read_map.count(key)) {
             auto later_read =
                     std::lower_bound(channel_mux_read_map[key].begin(),
@@ -137,7 +147,7 @@ void PairingNode::pair_generating_worker_thread() {
                 if (is_within_time_and_length_criteria(*earlier_read, read)) {
                     ReadPair pair = {*earlier_read, read};
                     ++(*earlier_read)->num_duplex_candidate_pairs;
-                    m_sink.push_message(std::make_shared<ReadPair>(pair));
+                    send_message_to_sink(std::make_shared<ReadPair>(pair));
                 }
             }
 
@@ -145,7 +155,7 @@ void PairingNode::pair_generating_worker_thread() {
                 if (is_within_time_and_length_criteria(read, *later_read)) {
                     ReadPair pair = {read, *later_read};
                     ++read->num_duplex_candidate_pairs;
-                    m_sink.push_message(std::make_shared<ReadPair>(pair));
+                    send_message_to_sink(std::make_shared<ReadPair>(pair));
                 }
             }
 
@@ -165,11 +175,12 @@ void PairingNode::pair_generating_worker_thread() {
 
             for (const auto& read_ptr : reads_list) {
                 // Push each read message
-                m_sink.push_message(read_ptr);
+                read_ptr->memory_charge.resume();
+                send_message_to_sink(read_ptr);
             }
         }
 
-        m_sink.terminate();
+        terminate_outputs();
     }
 }
 
@@ -177,7 +188,8 @@ PairingNode::PairingNode(MessageSink& sink,
                          std::optional<std::map<std::string, std::string>> template_complement_map,
                          int num_worker_threads,
                          size_t max_reads)
-        : MessageSink(max_reads), m_sink(sink), m_num_worker_threads(num_worker_threads) {
+        : MessageSink(max_reads), m_num_worker_threads(num_worker_threads) {
+    add_output(sink);
     if (template_complement_map.has_value()) {
         m_template_complement_map = template_complement_map.value();
         // Set up the complement-template_map
@@ -205,7 +217,7 @@ PairingNode::~PairingNode() {
 }
 
 stats::NamedStats PairingNode::sample_stats() const {
-    stats::NamedStats stats = m_work_queue.sample_stats();
+    stats::NamedStats stats = m_work_queue->sample_stats();
     return stats;
 }
 
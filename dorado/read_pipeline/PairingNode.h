@@ -33,7 +33,6 @@ private:
     using UniquePoreIdentifierKey = std::tuple<int, int, std::string, std::string, int32_t>;
 
     std::vector<std::unique_ptr<std::thread>> m_workers;
-    MessageSink& m_sink;
     std::map<std::string, std::string> m_template_complement_map;
     std::map<std::string, std::string> m_complement_template_map;
 
@@ -0,0 +1,51 @@
+#include "Pipeline.h"
+
+#include <unordered_map>
+
+namespace dorado {
+
+Pipeline::~Pipeline() { shutdown(); }
+
+void Pipeline::shutdown() {
+    // Count each node's inputs from other nodes in the pipeline.
+    std::unordered_map<const MessageSink*, size_t> node_indices;
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+        node_indices[m_nodes[i].get()] = i;
+    }
+    std::vector<int> num_inputs(m_nodes.size(), 0);
+    for (const auto& node : m_nodes) {
+        for (auto* output : node->get_outputs()) {
+            auto it = node_indices.find(output);
+            if (it != node_indices.end()) {
+                ++num_inputs[it->second];
+            }
+        }
+    }
+
+    // Repeatedly destroy a node with no remaining inputs.  Nodes are added sinks first,
+    // so prefer the most recently added one.  A cycle would leave no such node, in which
+    // case fall back to the most recently added node left.
+    for (size_t num_destroyed = 0; num_destroyed < m_nodes.size(); ++num_destroyed) {
+        int next = -1;
+        for (int i = static_cast<int>(m_nodes.size()) - 1; i >= 0; --i) {
+            if (m_nodes[i] && (next == -1 || num_inputs[i] == 0)) {
+                next = i;
+                if (num_inputs[i] == 0) {
+                    break;
+                }
+            }
+        }
+
+        auto outputs = m_nodes[next]->get_outputs();
+        m_nodes[next].reset();
+        for (auto* output : outputs) {
+            auto it = node_indices.find(output);
+            if (it != node_indices.end()) {
+                --num_inputs[it->second];
+            }
+        }
+    }
+    m_nodes.clear();
+}
+
+}  // namespace dorado
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ReadPipeline.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace dorado {
+
+// Owns the nodes of a pipeline and manages their lifetimes.
+// Since a node's constructor takes the node it outputs to, nodes are added sinks
+// first.  Further outputs, e.g. to route some messages around a node, are added with
+// MessageSink::add_output.
+// Nodes are shut down in topological order, sources first, so that each node has
+// finished sending before any node downstream of it is destroyed.
+class Pipeline {
+public:
+    Pipeline() = default;
+    ~Pipeline();
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    // Constructs a node owned by the pipeline, returning a reference to it.
+    template <class NodeType, class... Args>
+    NodeType& add_node(Args&&... args) {
+        auto node = std::make_unique<NodeType>(std::forward<Args>(args)...);
+        auto& node_ref = *node;
+        m_nodes.push_back(std::move(node));
+        return node_ref;
+    }
+
+    // Destroys all nodes, sources first.  Called on destruction if not before.
+    void shutdown();
+
+private:
+    std::vector<std::unique_ptr<MessageSink>> m_nodes;
+};
+
+}  // namespace dorado
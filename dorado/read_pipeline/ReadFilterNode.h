@@ -22,13 +22,13 @@ public:
                    size_t min_qscore,
                    size_t min_read_length,
                    const std::unordered_set<std::string>& read_ids_to_filter,
-                   size_t num_worker_threads);
+                   size_t num_worker_threads,
+                   QueueBackend queue_backend = QueueBackend::MUTEX);
     ~ReadFilterNode();
     std::string get_name() const override { return "ReadFilterNode"; }
     stats::NamedStats sample_stats() const override;
 
 private:
-    MessageSink& m_sink;
     void worker_thread();
 
     // Async worker for writing.
@@ -1,14 +1,25 @@
 #include "ReadPipeline.h"
 
 #include "htslib/sam.h"
+#include "utils/WorkStealingExecutor.h"
 #include "utils/base_mod_utils.h"
 #include "utils/sequence_utils.h"
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <iomanip>
+#include <iterator>
+#include <mutex>
+#include <numeric>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
 
 using namespace std::chrono_literals;
 
@@ -46,6 +57,41 @@ bool get_modbase_channel_name(std::string &channel_name, const std::string &mod_
 
 namespace dorado {
 
+void ChunkArena::init_calls(size_t max_call_len) {
+    const size_t num_chunks = chunks.size();
+    m_max_call_len = max_call_len;
+    // resize only reallocates when growing, so a recycled arena usually allocates nothing.
+    m_seqs.resize(num_chunks * max_call_len);
+    m_qstrings.resize(num_chunks * max_call_len);
+    m_moves.resize(num_chunks * max_call_len);
+    m_seq_lens.assign(num_chunks, 0);
+    m_num_moves.assign(num_chunks, 0);
+}
+
+void ChunkArena::set_calls(size_t chunk,
+                           const std::string &seq,
+                           const std::string &qstring,
+                           const std::vector<uint8_t> &moves) {
+    if (seq.size() > m_max_call_len || qstring.size() != seq.size() ||
+        moves.size() > m_max_call_len) {
+        throw std::runtime_error("Chunk calls don't fit in their ChunkArena slot");
+    }
+    const size_t slot_start = chunk * m_max_call_len;
+    std::copy(seq.begin(), seq.end(), m_seqs.begin() + slot_start);
+    std::copy(qstring.begin(), qstring.end(), m_qstrings.begin() + slot_start);
+    std::copy(moves.begin(), moves.end(), m_moves.begin() + slot_start);
+    m_seq_lens[chunk] = seq.size();
+    m_num_moves[chunk] = moves.size();
+}
+
+size_t ChunkArena::calls_size() const {
+    size_t bytes = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        bytes += 2 * m_seq_lens[i] + m_num_moves[i];
+    }
+    return bytes;
+}
+
 std::string Read::generate_read_group() const {
     if (!run_id.empty() && !model_name.empty()) {
         return std::string(run_id + "_" + model_name);
@@ -57,10 +103,10 @@ void Read::generate_read_tags(bam1_t *aln, bool emit_moves) const {
     int qs = static_cast<int>(std::round(utils::mean_qscore_from_qstring(qstring)));
     bam_aux_append(aln, "qs", 'i', sizeof(qs), (uint8_t *)&qs);
 
-    float du = (float)(raw_data.size(0) + num_trimmed_samples) / (float)sample_rate;
+    float du = (float)(num_raw_samples() + num_trimmed_samples) / (float)sample_rate;
     bam_aux_append(aln, "du", 'f', sizeof(du), (uint8_t *)&du);
 
-    int ns = raw_data.size(0) + num_trimmed_samples;
+    int ns = num_raw_samples() + num_trimmed_samples;
     bam_aux_append(aln, "ns", 'i', sizeof(ns), (uint8_t *)&ns);
 
     int ts = num_trimmed_samples;
@@ -174,6 +220,19 @@ uint64_t Read::get_end_time_ms() {
            ((end_sample - start_sample) * 1000) / sample_rate;  //TODO get rid of the trimmed thing?
 }
 
+int64_t Read::num_raw_samples() const {
+    return raw_data.defined() ? raw_data.size(0) : m_num_released_raw_samples;
+}
+
+void Read::release_raw_data() {
+    if (!raw_data.defined()) {
+        return;
+    }
+    m_num_released_raw_samples = raw_data.size(0);
+    memory_charge.remove(raw_data.numel() * raw_data.element_size());
+    raw_data = torch::Tensor();
+}
+
 void Read::generate_modbase_string(bam1_t *aln, uint8_t threshold) const {
     if (!base_mod_info) {
         return;
@@ -251,12 +310,219 @@ void Read::generate_modbase_string(bam1_t *aln, uint8_t threshold) const {
 }
 
 void MessageSink::push_message(Message &&message) {
-    const bool success = m_work_queue.try_push(std::move(message));
+    const bool success = m_work_queue->try_push(std::move(message));
     // try_push will fail if the sink has been told to terminate.
     // We do not expect to be pushing reads from this source if that is the case.
     assert(success);
 }
 
-MessageSink::MessageSink(size_t max_messages) : m_work_queue(max_messages) {}
+void MessageSink::push_messages(std::vector<Message> &&messages) {
+    const bool success = m_work_queue->try_push_batch(std::move(messages));
+    // As with push_message, failure means the sink has been told to terminate.
+    assert(success);
+}
+
+void MessageSink::add_output(MessageSink &sink, MessageRoute route) {
+    if (route) {
+        m_routed_outputs.push_back({&sink, std::move(route)});
+    } else if (m_default_output) {
+        throw std::runtime_error("Node already has an output without a route");
+    } else {
+        m_default_output = &sink;
+    }
+    ++sink.m_num_active_inputs;
+}
+
+std::vector<MessageSink *> MessageSink::get_outputs() const {
+    std::vector<MessageSink *> outputs;
+    for (const auto &output : m_routed_outputs) {
+        outputs.push_back(output.sink);
+    }
+    if (m_default_output) {
+        outputs.push_back(m_default_output);
+    }
+    return outputs;
+}
+
+bool MessageSink::downstream_needs_raw_data() const {
+    // Nodes may be reachable by several paths, so each is only visited once.
+    std::unordered_set<const MessageSink *> visited;
+    const auto outputs = get_outputs();
+    std::vector<const MessageSink *> to_visit(outputs.begin(), outputs.end());
+    while (!to_visit.empty()) {
+        const auto *node = to_visit.back();
+        to_visit.pop_back();
+        if (!visited.insert(node).second) {
+            continue;
+        }
+        if (node->needs_raw_data()) {
+            return true;
+        }
+        for (const auto *output : node->get_outputs()) {
+            to_visit.push_back(output);
+        }
+    }
+    return false;
+}
+
+void MessageSink::input_finished() {
+    if (--m_num_active_inputs <= 0) {
+        terminate();
+    }
+}
+
+MessageSink &MessageSink::route_message(const Message &message) const {
+    for (const auto &output : m_routed_outputs) {
+        if (output.route(message)) {
+            return *output.sink;
+        }
+    }
+    if (!m_default_output) {
+        throw std::runtime_error("No output accepts message");
+    }
+    return *m_default_output;
+}
+
+void MessageSink::send_message_to_sink(Message &&message) {
+    route_message(message).push_message(std::move(message));
+}
+
+void MessageSink::send_messages_to_sink(std::vector<Message> &&messages) {
+    if (m_routed_outputs.empty()) {
+        // Common case of a linear pipeline: the whole batch goes to one place.
+        if (!messages.empty()) {
+            route_message(messages.front()).push_messages(std::move(messages));
+        }
+        return;
+    }
+
+    // Split the batch between outputs, preserving order within each.
+    std::unordered_map<MessageSink *, std::vector<Message>> batches;
+    for (auto &message : messages) {
+        batches[&route_message(message)].push_back(std::move(message));
+    }
+    messages.clear();
+    for (auto &[sink, batch] : batches) {
+        sink->push_messages(std::move(batch));
+    }
+}
+
+void MessageSink::process_messages_in_order(size_t max_concurrency,
+                                            const MessageProcessor &process) {
+    max_concurrency = std::max<size_t>(max_concurrency, 1);
+    const size_t max_window_size = 2 * max_concurrency;
+
+    struct Entry {
+        Message message;
+        std::vector<Message> results;
+        bool done = false;
+    };
+    // Shared with the tasks, which may still be releasing the mutex after the last one
+    // has been sent on.
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        // Messages popped but not yet sent on, in input order.  Entries are only added
+        // and removed at the ends, so tasks can hold references to theirs.
+        std::deque<Entry> window;
+        std::vector<size_t> free_slots;
+        bool input_finished = false;
+        std::exception_ptr exception;
+    };
+    auto state = std::make_shared<State>();
+    state->free_slots.resize(max_concurrency);
+    std::iota(state->free_slots.rbegin(), state->free_slots.rend(), 0);
+
+    // Sends on the results at the front of the window as they complete, so that the thread
+    // popping messages never waits for output.
+    std::thread sender([this, &state = *state] {
+        std::unique_lock lock(state.mutex);
+        std::vector<Message> results;
+        while (true) {
+            state.cv.wait(lock, [&state] {
+                return (!state.window.empty() && state.window.front().done) ||
+                       (state.window.empty() && state.input_finished);
+            });
+            if (state.window.empty()) {
+                return;
+            }
+            while (!state.window.empty() && state.window.front().done) {
+                auto &front_results = state.window.front().results;
+                results.insert(results.end(), std::make_move_iterator(front_results.begin()),
+                               std::make_move_iterator(front_results.end()));
+                state.window.pop_front();
+            }
+            state.cv.notify_all();
+            lock.unlock();
+            send_messages_to_sink(std::move(results));
+            results.clear();
+            lock.lock();
+        }
+    });
+
+    auto &executor = utils::WorkStealingExecutor::global();
+    Message message;
+    while (m_work_queue->try_pop(message)) {
+        std::unique_lock lock(state->mutex);
+        state->cv.wait(lock, [&state, max_window_size] {
+            return !state->free_slots.empty() && state->window.size() < max_window_size;
+        });
+        const size_t slot = state->free_slots.back();
+        state->free_slots.pop_back();
+        auto &entry = state->window.emplace_back();
+        entry.message = std::move(message);
+        lock.unlock();
+
+        executor.submit([state, &entry, slot, &process] {
+            std::vector<Message> results;
+            std::exception_ptr exception;
+            try {
+                results = process(slot, std::move(entry.message));
+            } catch (...) {
+                exception = std::current_exception();
+            }
+            std::lock_guard task_lock(state->mutex);
+            entry.results = std::move(results);
+            entry.done = true;
+            if (exception && !state->exception) {
+                state->exception = exception;
+            }
+            state->free_slots.push_back(slot);
+            state->cv.notify_all();
+        });
+    }
+
+    {
+        std::lock_guard lock(state->mutex);
+        state->input_finished = true;
+    }
+    state->cv.notify_all();
+    sender.join();
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+}
+
+void MessageSink::terminate_outputs() {
+    if (m_outputs_terminated.exchange(true)) {
+        return;
+    }
+    for (auto *output : get_outputs()) {
+        output->input_finished();
+    }
+}
+
+MessageSink::MessageSink(size_t max_messages, QueueBackend queue_backend) {
+    switch (queue_backend) {
+    case QueueBackend::MUTEX:
+        m_work_queue = std::make_unique<AsyncQueue<Message>>(max_messages);
+        break;
+    case QueueBackend::RING_BUFFER:
+        m_work_queue = std::make_unique<RingBufferQueue<Message>>(max_messages);
+        break;
+    default:
+        throw std::runtime_error("Unknown message queue backend");
+    }
+}
 
 }  // namespace dorado
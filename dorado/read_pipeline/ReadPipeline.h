@@ -1,14 +1,19 @@
 #pragma once
 #include "utils/AsyncQueue.h"
+#include "utils/MemoryBudget.h"
+#include "utils/RingBufferQueue.h"
 #include "utils/stats.h"
 #include "utils/types.h"
 
 #include <torch/torch.h>
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -22,23 +27,56 @@ struct BaseModInfo;
 class Read;
 
 struct Chunk {
-    Chunk(std::shared_ptr<Read> const& read,
-          size_t offset,
-          size_t chunk_in_read_idx,
-          size_t chunk_size)
+    Chunk(Read* read, size_t offset, size_t chunk_in_read_idx, size_t chunk_size)
             : source_read(read),
               input_offset(offset),
               idx_in_read(chunk_in_read_idx),
               raw_chunk_size(chunk_size) {}
 
-    std::weak_ptr<Read> source_read;
+    Read* source_read;      // Owns this chunk, via its ChunkArena
     size_t input_offset;    // Where does this chunk start in the input raw read data
     size_t idx_in_read;     // Just for tracking that the chunks don't go out of order
     size_t raw_chunk_size;  // Just for knowing the original chunk size
+};
+
+// A read's chunks and their calls while the read is being basecalled.
+// Calls for all chunks share one buffer each for sequence, qstring and moves, with a
+// fixed size slot per chunk, rather than several allocations per chunk.  Arenas are
+// recycled between reads, so in the steady state they allocate nothing.
+class ChunkArena {
+public:
+    // Sizes the call buffers for the current chunks, with room for calls of up to
+    // max_call_len moves per chunk.  Existing allocations are reused where big enough.
+    void init_calls(size_t max_call_len);
+    // Copies a chunk's calls into its slot.  Calls for different chunks may be set
+    // concurrently.
+    void set_calls(size_t chunk,
+                   const std::string& seq,
+                   const std::string& qstring,
+                   const std::vector<uint8_t>& moves);
+    // Empties the arena ready for another read, keeping its allocations.
+    void clear() { chunks.clear(); }
+    // Total bytes of the calls set so far.
+    size_t calls_size() const;
+
+    std::string_view seq(size_t chunk) const {
+        return {&m_seqs[chunk * m_max_call_len], m_seq_lens[chunk]};
+    }
+    std::string_view qstring(size_t chunk) const {
+        return {&m_qstrings[chunk * m_max_call_len], m_seq_lens[chunk]};
+    }
+    const uint8_t* moves(size_t chunk) const { return &m_moves[chunk * m_max_call_len]; }
+    size_t num_moves(size_t chunk) const { return m_num_moves[chunk]; }
 
-    std::string seq;
-    std::string qstring;
-    std::vector<uint8_t> moves;  // For stitching.
+    std::vector<Chunk> chunks;
+
+private:
+    size_t m_max_call_len{0};
+    std::vector<char> m_seqs;
+    std::vector<char> m_qstrings;
+    std::vector<uint8_t> m_moves;
+    std::vector<size_t> m_seq_lens;
+    std::vector<size_t> m_num_moves;
 };
 
 // Class representing a read, including raw data
@@ -73,7 +111,7 @@ public:
     float scaling;  // Scale factor applied to convert raw integers from sequencer into pore current values
 
     size_t num_chunks;  // Number of chunks in the read. Reads raw data is split into chunks for efficient basecalling.
-    std::vector<std::shared_ptr<Chunk>> called_chunks;  // Vector of basecalled chunks.
+    std::unique_ptr<ChunkArena> chunk_arena;  // Chunks being basecalled, and their calls.
     std::atomic_size_t num_chunks_called;  // Number of chunks which have been basecalled
 
     size_t num_modbase_chunks;
@@ -102,6 +140,11 @@ public:
     std::vector<Mapping> mappings;
     std::vector<BamPtr> extract_sam_lines(bool emit_moves, uint8_t modbase_threshold = 0) const;
 
+    // Number of samples in raw_data, which is remembered once the signal is released.
+    int64_t num_raw_samples() const;
+    // Frees raw_data, and its memory budget charge, once no node needs the signal.
+    void release_raw_data();
+
     uint64_t start_sample;
     uint64_t end_sample;
     uint64_t run_acquisition_start_time_ms;
@@ -116,8 +159,16 @@ public:
     uint64_t read_tag{0};
     // The id of the client to which this read belongs. -1 in standalone mode
     int32_t client_id{-1};
+    // Position in which the loader admitted the read, counting from 0.
+    uint64_t sequence_number{0};
+
+    // Bytes of signal and call results charged to the in-flight memory budget by the
+    // loader.  Released when the read is destroyed.
+    utils::MemoryCharge memory_charge;
 
 private:
+    int64_t m_num_released_raw_samples{0};
+
     void generate_duplex_read_tags(bam1_t*) const;
     void generate_read_tags(bam1_t* aln, bool emit_moves) const;
     void generate_modbase_string(bam1_t* aln, uint8_t threshold = 0) const;
@@ -147,20 +198,52 @@ using Message = std::variant<std::shared_ptr<Read>,
 
 // Base class for an object which consumes messages.
 // MessageSink is a node within a pipeline.
+// A node sends the messages it produces to its outputs, which are the nodes downstream
+// of it.  A node may have several outputs, with messages routed between them by type
+// or predicate, and several nodes may share an output.
 // NOTE: In order to prevent potential deadlocks when
 // the writer to the node doesn't exit cleanly, always
 // call terminate() in the destructor of a class derived
 // from MessageSink (and before worker thread join() calls
-// if there are any).
+// if there are any), and terminate_outputs() after them.
 class MessageSink {
 public:
-    MessageSink(size_t max_messages);
+    // Returns true if a message should be sent to an output.
+    using MessageRoute = std::function<bool(const Message&)>;
+
+    // Implementation of the queue holding messages pushed to this node.
+    enum class QueueBackend {
+        MUTEX,        // std::queue guarded by a single mutex (AsyncQueue).
+        RING_BUFFER,  // Lock-free bounded ring buffer (RingBufferQueue).
+    };
+
+    MessageSink(size_t max_messages, QueueBackend queue_backend = QueueBackend::MUTEX);
     virtual ~MessageSink() = default;
     // Pushed messages must be rvalues: the sink takes ownership.
     void push_message(
             Message&&
                     message);  // Push a message into message sink.  This can block if the sink's queue is full.
-    void terminate() { m_work_queue.terminate(); }
+    // Push a batch of messages into message sink, taking the queue lock once per batch rather
+    // than once per message where capacity allows.  messages is left empty.
+    void push_messages(std::vector<Message>&& messages);
+    void terminate() { m_work_queue->terminate(); }
+
+    // Adds a downstream node that this node sends messages to.  Each message goes to the
+    // first output, in the order they were added, whose route accepts it.  An output added
+    // without a route takes any message no routed output accepted.
+    // All outputs must be added before messages are pushed to this node.
+    void add_output(MessageSink& sink, MessageRoute route = {});
+    std::vector<MessageSink*> get_outputs() const;
+
+    // Called by an upstream node once it has sent its last message to this node.  Input
+    // is terminated once every node this was added as an output of has finished.
+    void input_finished();
+
+    // Whether this node reads Read::raw_data.  Once no node downstream of a read needs it,
+    // the signal can be released to save memory.
+    virtual bool needs_raw_data() const { return false; }
+    // Whether any node reachable from this one's outputs needs Read::raw_data.
+    bool downstream_needs_raw_data() const;
 
     // StatsSampler will ignore nodes with an empty name.
     virtual std::string get_name() const { return std::string(""); }
@@ -169,8 +252,51 @@ public:
     }
 
 protected:
+    // Send messages to the output which accepts them.  Throws if no output does.
+    void send_message_to_sink(Message&& message);
+    void send_messages_to_sink(std::vector<Message>&& messages);
+    // Tell each output that this node will send no more messages.  Only the first call
+    // has any effect, so this is safe to call from both worker threads and destructors.
+    void terminate_outputs();
+
+    // Maximum number of messages worker threads take from m_work_queue per pop.
+    static constexpr size_t kMaxMessageBatchSize = 32;
+
+    // Returns the messages to send on in place of message.  slot is as for
+    // WorkStealingExecutor::parallel_for.
+    using MessageProcessor = std::function<std::vector<Message>(size_t slot, Message&& message)>;
+    // Pops messages from m_work_queue until it's terminated, processing each with process on
+    // the shared executor, at most max_concurrency at once.  A message starts as soon as a
+    // slot is free rather than waiting for the rest of a batch, while the results are sent
+    // on in input order from a window of a few times max_concurrency messages, so a slow
+    // message only holds back those behind it once the window fills.  Returns once every
+    // message popped has been sent on.  If process throws, the first exception is rethrown
+    // here, and the messages that threw are dropped.
+    void process_messages_in_order(size_t max_concurrency, const MessageProcessor& process);
+
     // Queue of work items for this node.
-    AsyncQueue<Message> m_work_queue;
+    std::unique_ptr<AsyncQueueBase<Message>> m_work_queue;
+
+private:
+    struct Output {
+        MessageSink* sink;
+        MessageRoute route;
+    };
+    MessageSink& route_message(const Message& message) const;
+
+    // Routed outputs, in the order they were added.
+    std::vector<Output> m_routed_outputs;
+    // Output for messages no routed output accepts, if any.
+    MessageSink* m_default_output = nullptr;
+    // Number of upstream nodes yet to finish sending to this node.
+    std::atomic<int> m_num_active_inputs{0};
+    std::atomic<bool> m_outputs_terminated{false};
 };
 
+// Routes messages holding a particular type, e.g. route_by_type<BamPtr>().
+template <class T>
+MessageSink::MessageRoute route_by_type() {
+    return [](const Message& message) { return std::holds_alternative<T>(message); };
+}
+
 }  // namespace dorado
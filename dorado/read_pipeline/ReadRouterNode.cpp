@@ -0,0 +1,66 @@
+#include "ReadRouterNode.h"
+
+#include "utils/sequence_utils.h"
+
+namespace dorado {
+
+void ReadRouterNode::worker_thread() {
+    m_active_threads++;
+
+    std::vector<Message> messages;
+    while (m_work_queue->try_pop_batch(messages, kMaxMessageBatchSize)) {
+        // Reads are routed as they're sent on.
+        send_messages_to_sink(std::move(messages));
+        messages.clear();
+    }
+
+    auto num_active_threads = --m_active_threads;
+    if (num_active_threads == 0) {
+        terminate_outputs();
+    }
+}
+
+ReadRouterNode::ReadRouterNode(MessageSink& sink,
+                               MessageSink& routed_sink,
+                               ReadPredicate predicate,
+                               size_t num_worker_threads,
+                               size_t max_reads)
+        : MessageSink(max_reads), m_predicate(std::move(predicate)) {
+    add_output(routed_sink, [this](const Message& message) {
+        const auto* read = std::get_if<std::shared_ptr<Read>>(&message);
+        if (!read) {
+            return false;
+        }
+        const bool routed = m_predicate(**read);
+        ++(routed ? m_num_reads_routed : m_num_reads_passed);
+        return routed;
+    });
+    add_output(sink);
+    for (size_t i = 0; i < num_worker_threads; i++) {
+        m_workers.push_back(std::make_unique<std::thread>(&ReadRouterNode::worker_thread, this));
+    }
+}
+
+ReadRouterNode::~ReadRouterNode() {
+    terminate();
+    for (auto& m : m_workers) {
+        m->join();
+    }
+    terminate_outputs();
+}
+
+stats::NamedStats ReadRouterNode::sample_stats() const {
+    stats::NamedStats stats = stats::from_obj(*m_work_queue);
+    stats["reads_routed"] = m_num_reads_routed;
+    stats["reads_passed"] = m_num_reads_passed;
+    return stats;
+}
+
+ReadRouterNode::ReadPredicate ReadRouterNode::qscore_band(float min_qscore, float max_qscore) {
+    return [min_qscore, max_qscore](const Read& read) {
+        const float qscore = utils::mean_qscore_from_qstring(read.qstring);
+        return qscore >= min_qscore && qscore < max_qscore;
+    };
+}
+
+}  // namespace dorado
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ReadPipeline.h"
+#include "utils/stats.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dorado {
+
+/// Sends each read to one of two outputs according to a predicate, so that different reads
+/// can take different paths through a pipeline.  For example, reads which a fast model
+/// called with middling accuracy can be sent to a BasecallerNode running a more accurate
+/// model, while the rest go straight on.  Other messages go to the default output.
+class ReadRouterNode : public MessageSink {
+public:
+    // Returns true if a read should go to the routed output.
+    using ReadPredicate = std::function<bool(const Read&)>;
+
+    ReadRouterNode(MessageSink& sink,
+                   MessageSink& routed_sink,
+                   ReadPredicate predicate,
+                   size_t num_worker_threads = 1,
+                   size_t max_reads = 1000);
+    ~ReadRouterNode();
+    std::string get_name() const override { return "ReadRouterNode"; }
+    stats::NamedStats sample_stats() const override;
+
+    // Routes reads whose mean qscore is in [min_qscore, max_qscore).
+    static ReadPredicate qscore_band(float min_qscore, float max_qscore);
+
+private:
+    void worker_thread();
+
+    ReadPredicate m_predicate;
+
+    std::vector<std::unique_ptr<std::thread>> m_workers;
+    std::atomic<size_t> m_active_threads{0};
+
+    std::atomic<int64_t> m_num_reads_routed{0};
+    std::atomic<int64_t> m_num_reads_passed{0};
+};
+
+}  // namespace dorado
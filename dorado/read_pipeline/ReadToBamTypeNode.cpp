@@ -2,17 +2,17 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <chrono>
+#include <iterator>
 
 namespace dorado {
 
 void ReadToBamType::worker_thread() {
-    m_active_threads++;
-
-    Message message;
-    while (m_work_queue.try_pop(message)) {
+    // Records are sent on in input order.
+    process_messages_in_order(m_max_concurrency, [this](size_t, Message&& message) {
         // If this message isn't a read, we'll get a bad_variant_access exception.
-        auto read = std::get<std::shared_ptr<Read>>(message);
+        auto read = std::get<std::shared_ptr<Read>>(std::move(message));
 
         if (m_rna) {
             std::reverse(read->seq.begin(), read->seq.end());
@@ -20,15 +20,11 @@ void ReadToBamType::worker_thread() {
         }
 
         auto alns = read->extract_sam_lines(m_emit_moves, m_modbase_threshold);
-        for (auto& aln : alns) {
-            m_sink.push_message(std::move(aln));
-        }
-    }
+        return std::vector<Message>(std::make_move_iterator(alns.begin()),
+                                    std::make_move_iterator(alns.end()));
+    });
 
-    auto num_active_threads = --m_active_threads;
-    if (num_active_threads == 0) {
-        m_sink.terminate();
-    }
+    terminate_outputs();
 }
 
 ReadToBamType::ReadToBamType(MessageSink& sink,
@@ -36,26 +32,22 @@ ReadToBamType::ReadToBamType(MessageSink& sink,
                              bool rna,
                              size_t num_worker_threads,
                              float modbase_threshold_frac,
-                             size_t max_reads)
-        : MessageSink(max_reads),
-          m_sink(sink),
+                             size_t max_reads,
+                             QueueBackend queue_backend)
+        : MessageSink(max_reads, queue_backend),
           m_emit_moves(emit_moves),
           m_rna(rna),
           m_modbase_threshold(
                   static_cast<uint8_t>(std::min(modbase_threshold_frac * 256.0f, 255.0f))),
-          m_active_threads(0) {
-    for (size_t i = 0; i < num_worker_threads; i++) {
-        m_workers.push_back(
-                std::make_unique<std::thread>(std::thread(&ReadToBamType::worker_thread, this)));
-    }
+          m_max_concurrency(std::max<size_t>(num_worker_threads, 1)) {
+    add_output(sink);
+    m_worker = std::thread(&ReadToBamType::worker_thread, this);
 }
 
 ReadToBamType::~ReadToBamType() {
     terminate();
-    for (auto& m : m_workers) {
-        m->join();
-    }
-    m_sink.terminate();
+    m_worker.join();
+    terminate_outputs();
 }
 
 }  // namespace dorado
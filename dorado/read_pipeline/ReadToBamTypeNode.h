@@ -3,35 +3,36 @@
 #include "ReadPipeline.h"
 #include "utils/stats.h"
 
-#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace dorado {
 
 class ReadToBamType : public MessageSink {
 public:
+    // num_worker_threads is the most reads converted at once, on the shared executor.
     ReadToBamType(MessageSink& sink,
                   bool emit_moves,
                   bool rna,
                   size_t num_worker_threads,
                   float modbase_threshold_frac = 0,
-                  size_t max_reads = 1000);
+                  size_t max_reads = 1000,
+                  QueueBackend queue_backend = QueueBackend::MUTEX);
     ~ReadToBamType();
 
 private:
-    MessageSink& m_sink;
     void worker_thread();
 
     // Async worker for writing.
-    std::vector<std::unique_ptr<std::thread>> m_workers;
-    std::atomic<size_t> m_active_threads;
+    std::thread m_worker;
 
     bool m_emit_moves;
     bool m_rna;
     uint8_t m_modbase_threshold;
+    size_t m_max_concurrency;
 };
 
 }  // namespace dorado
@@ -0,0 +1,86 @@
+#include "ReorderNode.h"
+
+#include <algorithm>
+
+namespace dorado {
+
+void ReorderNode::release_in_order(std::vector<Message>& out, bool force) {
+    while (!m_held_reads.empty()) {
+        auto earliest = m_held_reads.begin();
+        if (earliest->first != m_next_sequence_number && !force) {
+            break;
+        }
+        // Any reads skipped over by a forced release will be late.
+        m_next_sequence_number = earliest->first + 1;
+        out.push_back(std::move(earliest->second));
+        m_held_reads.erase(earliest);
+        force = false;
+    }
+}
+
+void ReorderNode::worker_thread() {
+    std::vector<Message> messages;
+    std::vector<Message> ordered_messages;
+    while (m_work_queue->try_pop_batch(messages, kMaxMessageBatchSize)) {
+        for (auto& message : messages) {
+            if (!std::holds_alternative<std::shared_ptr<Read>>(message)) {
+                ordered_messages.push_back(std::move(message));
+                continue;
+            }
+
+            auto read = std::get<std::shared_ptr<Read>>(std::move(message));
+            if (read->sequence_number < m_next_sequence_number) {
+                // Its place has already been given up.
+                ++m_num_late_reads;
+                ordered_messages.push_back(std::move(read));
+                continue;
+            }
+
+            m_held_reads.emplace(read->sequence_number, std::move(read));
+            release_in_order(ordered_messages, false);
+            while (m_held_reads.size() > m_max_window_reads) {
+                release_in_order(ordered_messages, true);
+            }
+        }
+        messages.clear();
+
+        m_num_held_reads = m_held_reads.size();
+        m_peak_held_reads = std::max(m_peak_held_reads.load(), m_held_reads.size());
+        send_messages_to_sink(std::move(ordered_messages));
+    }
+
+    // No more reads are coming, so whatever is missing never will.
+    while (!m_held_reads.empty()) {
+        release_in_order(ordered_messages, true);
+    }
+    m_num_held_reads = 0;
+    send_messages_to_sink(std::move(ordered_messages));
+
+    terminate_outputs();
+}
+
+ReorderNode::ReorderNode(MessageSink& sink,
+                         size_t max_window_reads,
+                         size_t max_reads,
+                         QueueBackend queue_backend)
+        : MessageSink(max_reads, queue_backend),
+          m_max_window_reads(std::max<size_t>(max_window_reads, 1)) {
+    add_output(sink);
+    m_worker = std::thread(&ReorderNode::worker_thread, this);
+}
+
+ReorderNode::~ReorderNode() {
+    terminate();
+    m_worker.join();
+    terminate_outputs();
+}
+
+stats::NamedStats ReorderNode::sample_stats() const {
+    stats::NamedStats stats = stats::from_obj(*m_work_queue);
+    stats["held_reads"] = static_cast<double>(m_num_held_reads.load());
+    stats["peak_held_reads"] = static_cast<double>(m_peak_held_reads.load());
+    stats["late_reads"] = static_cast<double>(m_num_late_reads.load());
+    return stats;
+}
+
+}  // namespace dorado
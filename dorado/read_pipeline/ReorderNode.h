@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ReadPipeline.h"
+#include "utils/stats.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dorado {
+
+/// Puts reads back into the order the loader admitted them (Read::sequence_number),
+/// holding reads that arrive early until those before them have been sent on.
+/// At most max_window_reads reads are held.  Once the window is full the earliest held
+/// read is sent on regardless, skipping over any reads still outstanding.  Those are sent
+/// on as soon as they arrive, so ordering degrades rather than the pipeline stalling.
+/// Messages other than reads are passed straight through.
+class ReorderNode : public MessageSink {
+public:
+    ReorderNode(MessageSink& sink,
+                size_t max_window_reads,
+                size_t max_reads = 1000,
+                QueueBackend queue_backend = QueueBackend::MUTEX);
+    ~ReorderNode();
+    std::string get_name() const override { return "ReorderNode"; }
+    stats::NamedStats sample_stats() const override;
+
+private:
+    void worker_thread();
+    // Moves held reads which are next in sequence into out.  If force is true, the earliest
+    // held read is moved even if it isn't next.
+    void release_in_order(std::vector<Message>& out, bool force);
+
+    std::thread m_worker;
+    const size_t m_max_window_reads;
+
+    // Only touched by the worker thread.
+    std::map<uint64_t, std::shared_ptr<Read>> m_held_reads;
+    uint64_t m_next_sequence_number{0};
+
+    std::atomic<size_t> m_num_held_reads{0};
+    std::atomic<size_t> m_peak_held_reads{0};
+    // Reads sent on out of order, because the window filled before they arrived.
+    std::atomic<size_t> m_num_late_reads{0};
+};
+
+}  // namespace dorado
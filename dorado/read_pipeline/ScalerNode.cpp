@@ -1,9 +1,11 @@
 #include "ScalerNode.h"
 
+#include "utils/quantile_utils.h"
 #include "utils/tensor_utils.h"
 #include "utils/trim.h"
 
 #include <algorithm>
+#include <cassert>
 #include <chrono>
 #include <utility>
 
@@ -12,77 +14,75 @@ using Slice = torch::indexing::Slice;
 
 namespace dorado {
 
-std::pair<float, float> ScalerNode::normalisation(torch::Tensor& x) {
+std::pair<float, float> ScalerNode::normalisation(const int16_t* samples, size_t num_samples) {
     // Calculate shift and scale factors for normalisation.
-    auto quantiles = dorado::utils::quantile_counting(
-            x, torch::tensor({m_scaling_params.quantile_a, m_scaling_params.quantile_b}));
-    float q_a = quantiles[0].item<float>();
-    float q_b = quantiles[1].item<float>();
+    const float quantiles[] = {m_scaling_params.quantile_a, m_scaling_params.quantile_b};
+    float quantile_values[2];
+    utils::quantiles(samples, num_samples, quantiles, 2, quantile_values);
+    float q_a = quantile_values[0];
+    float q_b = quantile_values[1];
     float shift = std::max(10.0f, m_scaling_params.shift_multiplier * (q_a + q_b));
     float scale = std::max(1.0f, m_scaling_params.scale_multiplier * (q_b - q_a));
     return {shift, scale};
 }
 
+void ScalerNode::scale_read(Read& read) {
+    // raw_data comes from DataLoader with dtype int16.  We send it on as float16, shifted and
+    // scaled in float32 form a few samples at a time, so the only full length buffer written
+    // is the output.
+    assert(read.raw_data.dtype() == torch::kInt16);
+    const auto raw_data = read.raw_data.contiguous();
+    const auto num_samples = raw_data.size(0);
+    const int16_t* const samples = raw_data.data_ptr<int16_t>();
+    const auto [shift, scale] = normalisation(samples, num_samples);
+    auto scaled_data = torch::empty({num_samples}, torch::kFloat16);
+    utils::normalise_i16_to_f16(scaled_data.data_ptr<c10::Half>(), samples, num_samples, shift,
+                                scale);
+
+    // move the shift and scale into pA.
+    read.scale = read.scaling * scale;
+    read.shift = read.scaling * (shift + read.offset);
+
+    // 8000 value may be changed in future. Currently this is found to work well.
+    int max_samples = std::min(8000, static_cast<int>(num_samples / 2));
+    int trim_start = utils::trim(scaled_data.data_ptr<c10::Half>(), max_samples);
+
+    read.raw_data = scaled_data.index({Slice(trim_start, torch::indexing::None)});
+    read.num_trimmed_samples = trim_start;
+}
+
 void ScalerNode::worker_thread() {
-    Message message;
-    while (m_work_queue.try_pop(message)) {
-        // If this message isn't a read, we'll get a bad_variant_access exception.
-        auto read = std::get<std::shared_ptr<Read>>(message);
-
-        const auto [shift, scale] = normalisation(read->raw_data);
-        // raw_data comes from DataLoader with dtype int16.  We send it on as float16 after
-        // shifting/scaling in float32 form.
-        read->raw_data = ((read->raw_data.to(torch::kFloat) - shift) / scale).to(torch::kFloat16);
-
-        // move the shift and scale into pA.
-        read->scale = read->scaling * scale;
-        read->shift = read->scaling * (shift + read->offset);
-
-        // 8000 value may be changed in future. Currently this is found to work well.
-        int max_samples = std::min(8000, static_cast<int>(read->raw_data.size(0) / 2));
-        int trim_start =
-                utils::trim(read->raw_data.index({Slice(torch::indexing::None, max_samples)}));
-
-        read->raw_data = read->raw_data.index({Slice(trim_start, torch::indexing::None)});
-        read->num_trimmed_samples = trim_start;
-
-        // Pass the read to the next node
-        m_sink.push_message(read);
-    }
-
-    int num_worker_threads = --m_num_worker_threads;
-    if (num_worker_threads == 0) {
-        m_sink.terminate();
-    }
+    process_messages_in_order(m_max_concurrency, [this](size_t, Message&& message) {
+        // If a message isn't a read, we'll get a bad_variant_access exception.
+        scale_read(*std::get<std::shared_ptr<Read>>(message));
+        return std::vector<Message>{std::move(message)};
+    });
+
+    terminate_outputs();
 }
 
 ScalerNode::ScalerNode(MessageSink& sink,
                        const SignalNormalisationParams& config,
                        int num_worker_threads,
-                       size_t max_reads)
-        : MessageSink(max_reads),
-          m_sink(sink),
-          m_scaling_params(config),
-          m_num_worker_threads(num_worker_threads) {
-    for (int i = 0; i < m_num_worker_threads; i++) {
-        std::unique_ptr<std::thread> scaler_worker_thread =
-                std::make_unique<std::thread>(&ScalerNode::worker_thread, this);
-        worker_threads.push_back(std::move(scaler_worker_thread));
-    }
+                       size_t max_reads,
+                       QueueBackend queue_backend)
+        : MessageSink(max_reads, queue_backend),
+          m_max_concurrency(std::max(num_worker_threads, 1)),
+          m_scaling_params(config) {
+    add_output(sink);
+    m_worker_thread = std::thread(&ScalerNode::worker_thread, this);
 }
 
 ScalerNode::~ScalerNode() {
     terminate();
 
-    // Wait for all the Scaler Node's worker threads to terminate
-    for (auto& t : worker_threads) {
-        t->join();
-    }
+    // Wait for the Scaler Node's worker thread to terminate
+    m_worker_thread.join();
 
     // Notify the sink that the Scaler Node has terminated
-    m_sink.terminate();
+    terminate_outputs();
 }
 
-stats::NamedStats ScalerNode::sample_stats() const { return stats::from_obj(m_work_queue); }
+stats::NamedStats ScalerNode::sample_stats() const { return stats::from_obj(*m_work_queue); }
 
 }  // namespace dorado
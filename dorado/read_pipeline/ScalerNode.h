@@ -3,7 +3,8 @@
 #include "nn/CRFModel.h"
 #include "utils/stats.h"
 
-#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <thread>
 #include <vector>
@@ -12,24 +13,28 @@ namespace dorado {
 
 class ScalerNode : public MessageSink {
 public:
+    // num_worker_threads is the most reads scaled at once, on the shared executor.
     ScalerNode(MessageSink& sink,
                const SignalNormalisationParams& config,
                int num_worker_threads = 5,
-               size_t max_reads = 1000);
+               size_t max_reads = 1000,
+               QueueBackend queue_backend = QueueBackend::MUTEX);
     ~ScalerNode();
     std::string get_name() const override { return "ScalerNode"; }
     stats::NamedStats sample_stats() const override;
+    bool needs_raw_data() const override { return true; }
 
 private:
-    void worker_thread();  // Worker thread performs scaling and trimming asynchronously.
-    MessageSink&
-            m_sink;  // MessageSink to consume scaled reads. Typically this will be a Basecaller Node.
-    std::vector<std::unique_ptr<std::thread>> worker_threads;
-    std::atomic<int> m_num_worker_threads;
+    // Worker thread pops batches of reads and has them scaled and trimmed on the shared
+    // executor, then sends them on.
+    void worker_thread();
+    void scale_read(Read& read);
+    std::thread m_worker_thread;
+    size_t m_max_concurrency;
 
     SignalNormalisationParams m_scaling_params;
 
-    std::pair<float, float> normalisation(torch::Tensor& x);
+    std::pair<float, float> normalisation(const int16_t* samples, size_t num_samples);
 };
 
 }  // namespace dorado
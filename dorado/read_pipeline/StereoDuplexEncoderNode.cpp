@@ -267,6 +267,8 @@ std::shared_ptr<dorado::Read> StereoDuplexEncoderNode::stereo_encode(
     read->raw_data = tmp;  // use the encoded signal
     read->is_duplex = true;
     read->run_id = template_read->run_id;
+    // Charged to the budget its reads were admitted under, like their own signal.
+    read->memory_charge = template_read->memory_charge.derive(tmp.numel() * tmp.element_size());
 
     edlibFreeAlignResult(result);
 
@@ -274,57 +276,45 @@ std::shared_ptr<dorado::Read> StereoDuplexEncoderNode::stereo_encode(
 }
 
 void StereoDuplexEncoderNode::worker_thread() {
-    Message message;
-    while (m_work_queue.try_pop(message)) {
-        if (std::holds_alternative<std::shared_ptr<ReadPair>>(message)) {
-            auto read_pair = std::get<std::shared_ptr<ReadPair>>(message);
-            std::shared_ptr<Read> stereo_encoded_read =
-                    stereo_encode(read_pair->read_1, read_pair->read_2);
-
-            if (stereo_encoded_read->raw_data.ndimension() ==
-                2) {  // 2 dims for stereo encoding, 1 for simplex
-                m_sink.push_message(
-                        stereo_encoded_read);  // Stereo-encoded read created, send it to sink
-            } else {
-                // announce to downstream that we rejected a candidate pair
-                --read_pair->read_1->num_duplex_candidate_pairs;
-                m_sink.push_message(CandidatePairRejectedMessage{});
-            }
-        } else if (std::holds_alternative<std::shared_ptr<Read>>(message)) {
-            auto read = std::get<std::shared_ptr<Read>>(message);
-            m_sink.push_message(read);
+    // Each pair is replaced by its stereo-encoded read, or a rejection message.
+    // Anything else is passed on as is.
+    process_messages_in_order(m_max_concurrency, [this](size_t, Message&& message) {
+        if (!std::holds_alternative<std::shared_ptr<ReadPair>>(message)) {
+            return std::vector<Message>{std::move(message)};
         }
-    }
+        auto read_pair = std::get<std::shared_ptr<ReadPair>>(message);
+        std::shared_ptr<Read> stereo_encoded_read =
+                stereo_encode(read_pair->read_1, read_pair->read_2);
 
-    int num_worker_threads = --m_num_worker_threads;
-    if (num_worker_threads == 0) {
-        m_sink.terminate();
-    }
+        if (stereo_encoded_read->raw_data.ndimension() ==
+            2) {  // 2 dims for stereo encoding, 1 for simplex
+            return std::vector<Message>{std::move(stereo_encoded_read)};
+        }
+        // announce to downstream that we rejected a candidate pair
+        --read_pair->read_1->num_duplex_candidate_pairs;
+        return std::vector<Message>{CandidatePairRejectedMessage{}};
+    });
+
+    terminate_outputs();
 }
 
 StereoDuplexEncoderNode::StereoDuplexEncoderNode(MessageSink& sink, int input_signal_stride)
         : MessageSink(1000),
-          m_sink(sink),
-          m_num_worker_threads(std::thread::hardware_concurrency()),
+          m_max_concurrency(std::max(std::thread::hardware_concurrency(), 1u)),
           m_input_signal_stride(input_signal_stride) {
-    for (int i = 0; i < m_num_worker_threads; i++) {
-        std::unique_ptr<std::thread> stereo_encoder_worker_thread =
-                std::make_unique<std::thread>(&StereoDuplexEncoderNode::worker_thread, this);
-        worker_threads.push_back(std::move(stereo_encoder_worker_thread));
-    }
+    add_output(sink);
+    m_worker_thread = std::thread(&StereoDuplexEncoderNode::worker_thread, this);
 }
 
 StereoDuplexEncoderNode::~StereoDuplexEncoderNode() {
     terminate();
-    for (auto& t : worker_threads) {
-        t->join();
-    }
+    m_worker_thread.join();
 
-    m_sink.terminate();
+    terminate_outputs();
 }
 
 stats::NamedStats StereoDuplexEncoderNode::sample_stats() const {
-    stats::NamedStats stats = m_work_queue.sample_stats();
+    stats::NamedStats stats = m_work_queue->sample_stats();
     stats["discarded_pairs"] = m_num_discarded_pairs;
     return stats;
 }
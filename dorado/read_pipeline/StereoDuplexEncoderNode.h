@@ -5,6 +5,7 @@
 #include <atomic>
 #include <chrono>
 #include <memory>
+#include <thread>
 #include <vector>
 
 namespace dorado {
@@ -19,14 +20,14 @@ public:
     ~StereoDuplexEncoderNode();
     std::string get_name() const override { return "StereoDuplexEncoderNode"; }
     stats::NamedStats sample_stats() const override;
+    bool needs_raw_data() const override { return true; }
 
 private:
-    // Consume reads from input queue
+    // Consume reads from input queue, encoding them on the shared executor.
     void worker_thread();
-    MessageSink &m_sink;
 
-    std::vector<std::unique_ptr<std::thread>> worker_threads;
-    std::atomic<int> m_num_worker_threads;
+    std::thread m_worker_thread;
+    size_t m_max_concurrency;
 
     // The stride which was used to simplex call the data
     int m_input_signal_stride;
@@ -17,7 +17,6 @@ public:
 private:
     void worker_thread();
 
-    MessageSink& m_sink;
     std::vector<std::unique_ptr<std::thread>> worker_threads;
     std::atomic<int> m_num_worker_threads;
 
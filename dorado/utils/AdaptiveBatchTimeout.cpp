@@ -0,0 +1,64 @@
+#include "AdaptiveBatchTimeout.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+// Weight of each new gap in the moving average.
+constexpr double kGapWeight = 1.0 / 8;
+// Pause, in average gaps, taken to mean that chunks have stopped arriving.
+constexpr double kIdleGaps = 4.0;
+
+}  // namespace
+
+namespace dorado::utils {
+
+AdaptiveBatchTimeout::AdaptiveBatchTimeout(std::chrono::milliseconds latency_target,
+                                           std::chrono::milliseconds min_idle)
+        : m_latency_target(latency_target), m_min_idle(std::min(min_idle, latency_target)) {}
+
+void AdaptiveBatchTimeout::chunks_added(std::size_t num_chunks, Clock::time_point now) {
+    if (num_chunks == 0) {
+        return;
+    }
+    if (!m_batch_start) {
+        m_batch_start = now;
+    }
+    if (m_last_arrival) {
+        // Gaps longer than the latency target would only ever flush the batch anyway, and
+        // would otherwise skew the average for a long time after an idle period.
+        const auto gap = std::min(std::chrono::nanoseconds(now - *m_last_arrival),
+                                  m_latency_target);
+        const auto gap_ns = static_cast<double>(gap.count());
+        m_mean_gap_ns = m_mean_gap_ns ? *m_mean_gap_ns + kGapWeight * (gap_ns - *m_mean_gap_ns)
+                                      : gap_ns;
+    }
+    m_last_arrival = now;
+}
+
+AdaptiveBatchTimeout::Clock::time_point AdaptiveBatchTimeout::flush_deadline(
+        Clock::time_point now,
+        std::size_t num_pending_chunks) const {
+    if (!m_batch_start) {
+        return now + m_latency_target;
+    }
+    const auto latency_deadline = *m_batch_start + m_latency_target;
+    if (num_pending_chunks > 0) {
+        return latency_deadline;
+    }
+    return std::min(latency_deadline, *m_last_arrival + idle_timeout());
+}
+
+void AdaptiveBatchTimeout::batch_called() { m_batch_start.reset(); }
+
+std::chrono::nanoseconds AdaptiveBatchTimeout::idle_timeout() const {
+    // Until the arrival rate is known, wait for the whole latency target.
+    if (!m_mean_gap_ns) {
+        return m_latency_target;
+    }
+    const auto idle = std::chrono::nanoseconds(static_cast<int64_t>(kIdleGaps * *m_mean_gap_ns));
+    return std::clamp(idle, m_min_idle, m_latency_target);
+}
+
+}  // namespace dorado::utils
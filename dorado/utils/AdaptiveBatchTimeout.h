@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+namespace dorado::utils {
+
+// Decides when a partially filled batch of chunks should be called rather than waiting for
+// more chunks to fill it.
+//
+// The batch is called once its oldest chunk has waited latency_target, so no chunk is held
+// back longer than that.  It's called sooner if chunks stop arriving: arrivals are tracked as
+// a moving average of the gap between them, and a pause of several average gaps, but at
+// least min_idle, is taken to mean that no more are coming soon.  So steady streams fill
+// their batches up to the latency target, while the tail of a run, or a trickle of reads
+// when streaming, is called without waiting out the full timeout on a nearly empty batch.
+// A pause doesn't count as idling while the caller still has chunks pending, such as those
+// queued or being staged for the batch, since they're known to be coming.
+//
+// Not thread safe: each worker filling a batch has its own.
+class AdaptiveBatchTimeout {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    AdaptiveBatchTimeout(std::chrono::milliseconds latency_target,
+                         std::chrono::milliseconds min_idle = std::chrono::milliseconds(5));
+
+    // Records num_chunks chunks added to the batch at time now.
+    void chunks_added(std::size_t num_chunks, Clock::time_point now);
+    // When the batch should be called if no more chunks arrive, given num_pending_chunks
+    // chunks still on their way to it.  If the batch is empty, when to check again.
+    Clock::time_point flush_deadline(Clock::time_point now,
+                                     std::size_t num_pending_chunks = 0) const;
+    // Records the batch being called, so the next chunk starts a new one.
+    void batch_called();
+
+    // How long after the last arrival the batch is called, given the arrivals so far.
+    std::chrono::nanoseconds idle_timeout() const;
+
+private:
+    const std::chrono::nanoseconds m_latency_target;
+    const std::chrono::nanoseconds m_min_idle;
+    // Arrival time of the first chunk in the current batch.
+    std::optional<Clock::time_point> m_batch_start;
+    std::optional<Clock::time_point> m_last_arrival;
+    // Exponentially weighted moving average of the gaps between arrivals, in nanoseconds.
+    std::optional<double> m_mean_gap_ns;
+};
+
+}  // namespace dorado::utils
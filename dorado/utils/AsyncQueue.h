@@ -1,17 +1,83 @@
 #pragma once
 
+#include "LogHistogram.h"
+
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <optional>
 #include <queue>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+// Interface for queues used to pass items between producer and consumer threads.
+// Implementations agree on the following contract:
+// - Pushes block while the queue is full, and fail once terminate() has been called.
+// - Pops block while the queue is empty, and fail once terminate() has been called
+//   and the queue has been drained.
+template <class Item>
+class AsyncQueueBase {
+public:
+    virtual ~AsyncQueueBase() = default;
+
+    virtual bool try_push(Item&& item) = 0;
+    virtual bool try_pop(Item& item) = 0;
+    virtual bool try_push_batch(std::vector<Item>&& items) = 0;
+    virtual bool try_pop_batch(std::vector<Item>& items, size_t max_items) = 0;
+    virtual bool try_pop_batch_until(std::vector<Item>& items,
+                                     size_t max_items,
+                                     std::chrono::steady_clock::time_point deadline) = 0;
+    virtual void terminate() = 0;
+
+    virtual std::string get_name() const = 0;
+    virtual std::unordered_map<std::string, double> sample_stats() const = 0;
+
+protected:
+    using Clock = std::chrono::steady_clock;
+
+    static uint64_t elapsed_ns(Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+
+    // Adds summaries of the timing histograms over the latest sampling interval to stats.
+    // Reporters sampling at about the same time get the same interval, see LogHistogram.
+    // For each histogram, the 50th/90th/99th percentiles and max are given in us, and the
+    // total in ms.  The total time items spent in the queue divided by the sampling
+    // period gives the average number of items in it.
+    void add_timing_stats(std::unordered_map<std::string, double>& stats) const {
+        add_histogram_stats(stats, "dwell", m_dwell_time_ns.sample());
+        add_histogram_stats(stats, "push_blocked", m_push_blocked_ns.sample());
+        add_histogram_stats(stats, "pop_blocked", m_pop_blocked_ns.sample());
+    }
+
+    // Time from each item being pushed to it being popped.
+    dorado::utils::LogHistogram m_dwell_time_ns;
+    // Time spent waiting for space by pushes which found the queue full.
+    dorado::utils::LogHistogram m_push_blocked_ns;
+    // Time spent waiting for items by pops which found the queue empty.
+    dorado::utils::LogHistogram m_pop_blocked_ns;
+
+private:
+    static void add_histogram_stats(std::unordered_map<std::string, double>& stats,
+                                    const std::string& name,
+                                    const dorado::utils::LogHistogram::Summary& summary) {
+        constexpr double kNsPerUs = 1e3;
+        constexpr double kNsPerMs = 1e6;
+        stats[name + "_p50_us"] = summary.p50 / kNsPerUs;
+        stats[name + "_p90_us"] = summary.p90 / kNsPerUs;
+        stats[name + "_p99_us"] = summary.p99 / kNsPerUs;
+        stats[name + "_max_us"] = summary.max / kNsPerUs;
+        stats[name + "_total_ms"] = summary.sum / kNsPerMs;
+    }
+};
 
 // Asynchronous queue for producer/consumer use.
 // Items must be movable.
 template <class Item>
-class AsyncQueue {
+class AsyncQueue final : public AsyncQueueBase<Item> {
     // Guards the entire structure.  Should be held while adding/removing items,
     // or interacting with m_terminate.
     // Used for not-empty and not-full CV waits.
@@ -21,8 +87,13 @@ class AsyncQueue {
     std::condition_variable m_not_full_cv;
     // Signalled when an item has been added, and the queue therefore is not empty.
     std::condition_variable m_not_empty_cv;
-    // Holds the items.
-    std::queue<Item> m_items;
+    using Clock = typename AsyncQueueBase<Item>::Clock;
+    // Holds the items, with the time each was pushed.
+    struct Entry {
+        Item item;
+        typename Clock::time_point push_time;
+    };
+    std::queue<Entry> m_items;
     // Number of items that can be added before further additions block, pending
     // consumption of items.
     size_t m_capacity = 0;
@@ -37,7 +108,7 @@ public:
     // Attempts to push items beyond capacity will block.
     AsyncQueue(size_t capacity) : m_capacity(capacity) {}
 
-    ~AsyncQueue() {
+    ~AsyncQueue() override {
         // Ensure CV waits terminate before destruction.
         terminate();
     }
@@ -48,17 +119,17 @@ public:
     // If space was available and the item was added, true is returned.
     // If Terminate() was called, the item is not added and false is returned.
     // Items pushed must be rvalues, since we assume sole ownership.
-    bool try_push(Item&& item) {
+    bool try_push(Item&& item) override {
         std::unique_lock lock(m_mutex);
 
         // Ensure there is space for the new item, given our limit on capacity.
-        m_not_full_cv.wait(lock, [this] { return m_items.size() < m_capacity || m_terminate; });
+        wait_for_space(lock);
 
         // We hold the mutex, and either there is space in the queue, or we have been
         // asked to terminate.
         if (m_terminate)
             return false;
-        m_items.push(std::move(item));
+        m_items.push({std::move(item), Clock::now()});
         ++m_num_pushes;
 
         // Inform a waiting thread that there is now an item available.
@@ -71,17 +142,18 @@ public:
     // Obtains the next item in the queue, returning true on success.
     // If the queue is empty, and we are terminating, returns false.
     // Otherwise we block if the queue is empty.
-    bool try_pop(Item& item) {
+    bool try_pop(Item& item) override {
         std::unique_lock lock(m_mutex);
         // Wait until either an item is added, or we're asked to terminate.
-        m_not_empty_cv.wait(lock, [this] { return !m_items.empty() || m_terminate; });
+        wait_for_items(lock);
 
         // Termination takes effect once all items have been popped from the queue.
         if (m_terminate && m_items.empty()) {
             return false;
         }
 
-        item = std::move(m_items.front());
+        item = std::move(m_items.front().item);
+        this->m_dwell_time_ns.record(this->elapsed_ns(m_items.front().push_time, Clock::now()));
         m_items.pop();
         ++m_num_pops;
 
@@ -92,8 +164,88 @@ public:
         return true;
     }
 
+    // Attempts to add all of the given items to the queue under as few lock
+    // acquisitions as possible.
+    // If the queue cannot hold all of the items, as many as fit are added, waiting
+    // consumers are woken and we block until there is space for the remainder.
+    // Returns true if all items were added, or false if terminate() was called
+    // first, in which case items not yet added are discarded.
+    // items is left empty on return.
+    bool try_push_batch(std::vector<Item>&& items) override {
+        size_t num_pushed = 0;
+        while (num_pushed < items.size()) {
+            std::unique_lock lock(m_mutex);
+            wait_for_space(lock);
+            if (m_terminate) {
+                items.clear();
+                return false;
+            }
+
+            const size_t num_to_push =
+                    std::min(m_capacity - m_items.size(), items.size() - num_pushed);
+            const auto push_time = Clock::now();
+            for (size_t i = 0; i < num_to_push; ++i) {
+                m_items.push({std::move(items[num_pushed++]), push_time});
+            }
+            m_num_pushes += num_to_push;
+
+            // More than one consumer may now be able to make progress.
+            lock.unlock();
+            if (num_to_push == 1) {
+                m_not_empty_cv.notify_one();
+            } else {
+                m_not_empty_cv.notify_all();
+            }
+        }
+        items.clear();
+        return true;
+    }
+
+    // Obtains up to max_items items from the queue in a single lock acquisition,
+    // appending them to items.
+    // Blocks while the queue is empty, then returns whatever is available without
+    // waiting for a full batch.
+    // Returns false if the queue is empty and we are terminating.
+    bool try_pop_batch(std::vector<Item>& items, size_t max_items) override {
+        std::unique_lock lock(m_mutex);
+        wait_for_items(lock);
+
+        if (m_terminate && m_items.empty()) {
+            return false;
+        }
+
+        pop_batch_locked(items, max_items, lock);
+        return true;
+    }
+
+    // As try_pop_batch, but waits until either max_items items are available or
+    // the deadline passes, so that consumers which benefit from full batches can
+    // trade latency for batch size.
+    // If the deadline passes with the queue empty, true is returned with no items
+    // added.  Returns false if the queue is empty and we are terminating.
+    bool try_pop_batch_until(std::vector<Item>& items,
+                             size_t max_items,
+                             std::chrono::steady_clock::time_point deadline) override {
+        std::unique_lock lock(m_mutex);
+        const auto wait_start = Clock::now();
+        const bool was_empty = m_items.empty();
+        m_not_empty_cv.wait_until(lock, deadline, [this, max_items] {
+            return m_items.size() >= max_items || m_terminate;
+        });
+        if (was_empty) {
+            this->m_pop_blocked_ns.record(this->elapsed_ns(wait_start, Clock::now()));
+        }
+
+        if (m_terminate && m_items.empty()) {
+            return false;
+        }
+
+        pop_batch_locked(items, max_items, lock);
+        return true;
+    }
+
     // Tells the queue to terminate any CV waits.
-    void terminate() {
+    void terminate() override {
         {
             std::lock_guard lock(m_mutex);
             m_terminate = true;
@@ -107,14 +259,61 @@ public:
         m_not_empty_cv.notify_all();
     }
 
-    std::string get_name() const { return "queue"; }
+    std::string get_name() const override { return "queue"; }
 
-    std::unordered_map<std::string, double> sample_stats() const {
+    std::unordered_map<std::string, double> sample_stats() const override {
         std::unordered_map<std::string, double> stats;
         std::lock_guard<std::mutex> lock(m_mutex);
         stats["items"] = m_items.size();
         stats["pushes"] = m_num_pushes;
         stats["pops"] = m_num_pops;
+        this->add_timing_stats(stats);
         return stats;
     }
+
+private:
+    // Waits until there is space in the queue or we're terminating, recording the time
+    // spent waiting if the queue was full.
+    void wait_for_space(std::unique_lock<std::mutex>& lock) {
+        auto has_space = [this] { return m_items.size() < m_capacity || m_terminate; };
+        if (!has_space()) {
+            const auto wait_start = Clock::now();
+            m_not_full_cv.wait(lock, has_space);
+            this->m_push_blocked_ns.record(this->elapsed_ns(wait_start, Clock::now()));
+        }
+    }
+
+    // Waits until there are items in the queue or we're terminating, recording the time
+    // spent waiting if the queue was empty.
+    void wait_for_items(std::unique_lock<std::mutex>& lock) {
+        auto has_items = [this] { return !m_items.empty() || m_terminate; };
+        if (!has_items()) {
+            const auto wait_start = Clock::now();
+            m_not_empty_cv.wait(lock, has_items);
+            this->m_pop_blocked_ns.record(this->elapsed_ns(wait_start, Clock::now()));
+        }
+    }
+
+    // Moves up to max_items from the front of the queue into items, then releases
+    // the lock and wakes producers waiting for space.
+    void pop_batch_locked(std::vector<Item>& items,
+                          size_t max_items,
+                          std::unique_lock<std::mutex>& lock) {
+        const size_t num_to_pop = std::min(max_items, m_items.size());
+        items.reserve(items.size() + num_to_pop);
+        const auto pop_time = Clock::now();
+        for (size_t i = 0; i < num_to_pop; ++i) {
+            items.push_back(std::move(m_items.front().item));
+            this->m_dwell_time_ns.record(this->elapsed_ns(m_items.front().push_time, pop_time));
+            m_items.pop();
+        }
+        m_num_pops += num_to_pop;
+
+        lock.unlock();
+        if (num_to_pop == 1) {
+            m_not_full_cv.notify_one();
+        } else if (num_to_pop > 1) {
+            m_not_full_cv.notify_all();
+        }
+    }
 };
\ No newline at end of file
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+namespace dorado::utils {
+
+// Histogram of non-negative integer values, such as durations in nanoseconds.
+// Each power of 2 range of values is split into kSubBuckets equally sized buckets, so
+// quantiles are reported to within 1 / kSubBuckets of the true value while the whole
+// 64 bit range fits in a few hundred counters.
+// Recording is a handful of relaxed atomic operations, so is cheap enough to do from
+// many threads on a hot path.  Summaries cover an interval between samples, as found from
+// the difference of the bucket counts at either end of it.
+class LogHistogram {
+public:
+    struct Summary {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        // Quantiles of the recorded values.  All 0 if nothing was recorded.
+        uint64_t p50 = 0;
+        uint64_t p90 = 0;
+        uint64_t p99 = 0;
+    };
+
+    void record(uint64_t value) {
+        m_buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t max = m_max.load(std::memory_order_relaxed);
+        while (value > max &&
+               !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Values recorded within kMinSampleInterval of each other are summarised together.
+    static constexpr std::chrono::milliseconds kMinSampleInterval{100};
+
+    explicit LogHistogram(std::chrono::milliseconds min_sample_interval = kMinSampleInterval)
+            : m_min_sample_interval(min_sample_interval) {}
+
+    // Summarises the values recorded in the latest sampling interval.  A call ends the
+    // interval if it's at least the minimum sample interval since the previous interval
+    // ended, and otherwise gets the same summary as the call which did, so sampling doesn't
+    // take values away from other callers sampling at about the same time.
+    // Values recorded concurrently with this call are counted in either this interval or
+    // the next one.
+    Summary sample() const {
+        std::lock_guard lock(m_sample_mutex);
+        const auto now = std::chrono::steady_clock::now();
+        if (!m_last_summary || now - m_interval_start >= m_min_sample_interval) {
+            Snapshot snapshot;
+            for (size_t i = 0; i < kNumBuckets; ++i) {
+                snapshot.counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+            }
+            snapshot.sum = m_sum.load(std::memory_order_relaxed);
+            snapshot.max = m_max.load(std::memory_order_relaxed);
+            m_last_summary = summarise(m_interval_snapshot, snapshot);
+            m_interval_snapshot = snapshot;
+            m_interval_start = now;
+        }
+        return *m_last_summary;
+    }
+
+private:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr uint64_t kSubBuckets = uint64_t(1) << kSubBucketBits;
+    // Values below kSubBuckets get a bucket each, then every power of 2 from
+    // kSubBuckets up to 2^63 gets kSubBuckets buckets.
+    static constexpr size_t kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    // Totals recorded up to some point.  Those up to the end of an interval, less those up
+    // to its start, give the interval's values.
+    struct Snapshot {
+        std::array<uint64_t, kNumBuckets> counts{};
+        uint64_t sum = 0;
+        uint64_t max = 0;  // The largest value recorded up to this point.
+    };
+
+    static Summary summarise(const Snapshot& start, const Snapshot& end) {
+        Summary summary;
+        std::array<uint64_t, kNumBuckets> counts;
+        size_t max_bucket = 0;
+        for (size_t i = 0; i < kNumBuckets; ++i) {
+            counts[i] = end.counts[i] - start.counts[i];
+            summary.count += counts[i];
+            if (counts[i] > 0) {
+                max_bucket = i;
+            }
+        }
+        if (summary.count == 0) {
+            return summary;
+        }
+        summary.sum = end.sum - start.sum;
+        // The largest value of the interval is taken to be the largest so far if that's in the
+        // interval's top bucket, and otherwise the midpoint of that bucket, like the quantiles.
+        summary.max = bucket_index(end.max) == max_bucket ? end.max : bucket_midpoint(max_bucket);
+
+        // Reports the midpoint of the bucket holding the value of the given rank, or the
+        // largest value if that's in the same bucket.
+        auto quantile = [&](double q) {
+            const auto rank = std::max<uint64_t>(
+                    1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(summary.count))));
+            uint64_t num_seen = 0;
+            for (size_t i = 0; i < max_bucket; ++i) {
+                num_seen += counts[i];
+                if (num_seen >= rank) {
+                    return bucket_midpoint(i);
+                }
+            }
+            return summary.max;
+        };
+        summary.p50 = quantile(0.5);
+        summary.p90 = quantile(0.9);
+        summary.p99 = quantile(0.99);
+        return summary;
+    }
+
+    static int floor_log2(uint64_t value) {
+        int result = 0;
+        for (int shift = 32; shift > 0; shift /= 2) {
+            if (value >> shift) {
+                value >>= shift;
+                result += shift;
+            }
+        }
+        return result;
+    }
+
+    static size_t bucket_index(uint64_t value) {
+        if (value < kSubBuckets) {
+            return value;
+        }
+        const int msb = floor_log2(value);
+        const auto sub_bucket = (value >> (msb - kSubBucketBits)) & (kSubBuckets - 1);
+        return (msb - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+    }
+
+    static uint64_t bucket_midpoint(size_t index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        const auto group = index / kSubBuckets;
+        const auto sub_bucket = index % kSubBuckets;
+        const auto lower_bound = (kSubBuckets + sub_bucket) << (group - 1);
+        const auto width = uint64_t(1) << (group - 1);
+        return lower_bound + width / 2;
+    }
+
+    std::array<std::atomic<uint64_t>, kNumBuckets> m_buckets{};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+
+    const std::chrono::milliseconds m_min_sample_interval;
+    mutable std::mutex m_sample_mutex;
+    // Guarded by m_sample_mutex.
+    mutable Snapshot m_interval_snapshot;  // As of the end of the latest interval.
+    mutable std::chrono::steady_clock::time_point m_interval_start;
+    mutable std::optional<Summary> m_last_summary;
+};
+
+}  // namespace dorado::utils
@@ -0,0 +1,134 @@
+#include "MemoryBudget.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace dorado::utils {
+
+MemoryCharge::MemoryCharge(MemoryCharge&& other) noexcept
+        : m_budget(other.m_budget),
+          m_bytes(other.m_bytes.exchange(0)),
+          m_suspended_bytes(other.m_suspended_bytes.exchange(0)) {
+    other.m_budget = nullptr;
+}
+
+MemoryCharge& MemoryCharge::operator=(MemoryCharge&& other) noexcept {
+    if (this != &other) {
+        reset();
+        m_budget = other.m_budget;
+        m_bytes = other.m_bytes.exchange(0);
+        m_suspended_bytes = other.m_suspended_bytes.exchange(0);
+        other.m_budget = nullptr;
+    }
+    return *this;
+}
+
+void MemoryCharge::add(uint64_t bytes) {
+    if (m_budget) {
+        m_budget->charge(bytes);
+        m_bytes += bytes;
+    }
+}
+
+void MemoryCharge::remove(uint64_t bytes) {
+    if (m_budget) {
+        bytes = std::min(bytes, m_bytes.load());
+        m_bytes -= bytes;
+        m_budget->release(bytes);
+    }
+}
+
+void MemoryCharge::reset() {
+    if (m_budget) {
+        m_budget->release(m_bytes.exchange(0));
+        m_suspended_bytes = 0;
+        m_budget = nullptr;
+    }
+}
+
+void MemoryCharge::suspend() {
+    if (m_budget) {
+        const auto bytes = m_bytes.exchange(0);
+        m_suspended_bytes += bytes;
+        m_budget->release(bytes);
+    }
+}
+
+void MemoryCharge::resume() {
+    if (m_budget) {
+        const auto bytes = m_suspended_bytes.exchange(0);
+        m_budget->charge(bytes);
+        m_bytes += bytes;
+    }
+}
+
+MemoryCharge MemoryCharge::derive(uint64_t bytes) const {
+    if (!m_budget) {
+        return MemoryCharge();
+    }
+    m_budget->charge(bytes);
+    return MemoryCharge(*m_budget, bytes);
+}
+
+MemoryBudget& MemoryBudget::global() {
+    static MemoryBudget budget;
+    return budget;
+}
+
+void MemoryBudget::set_limit(uint64_t limit_bytes) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_limit_bytes = limit_bytes;
+    }
+    m_released_cv.notify_all();
+}
+
+uint64_t MemoryBudget::limit() const {
+    std::lock_guard lock(m_mutex);
+    return m_limit_bytes;
+}
+
+bool MemoryBudget::has_room(uint64_t bytes) const {
+    const auto current = m_current_bytes.load();
+    return m_limit_bytes == 0 || current == 0 || current + bytes <= m_limit_bytes;
+}
+
+MemoryCharge MemoryBudget::acquire(uint64_t bytes) {
+    std::unique_lock lock(m_mutex);
+    if (!has_room(bytes)) {
+        const auto wait_start = std::chrono::steady_clock::now();
+        m_released_cv.wait(lock, [this, bytes] { return has_room(bytes); });
+        m_blocked_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - wait_start)
+                                .count();
+    }
+    // Charged under the lock so concurrent acquires can't both see room for themselves.
+    charge(bytes);
+    return MemoryCharge(*this, bytes);
+}
+
+void MemoryBudget::charge(uint64_t bytes) {
+    const auto current = m_current_bytes += bytes;
+    auto peak = m_peak_bytes.load();
+    while (current > peak && !m_peak_bytes.compare_exchange_weak(peak, current)) {
+    }
+}
+
+void MemoryBudget::release(uint64_t bytes) {
+    m_current_bytes -= bytes;
+    // Taking the mutex ensures a waiter is either inside wait(), or has yet to check
+    // for room, so the notification can't be lost.
+    { std::lock_guard lock(m_mutex); }
+    m_released_cv.notify_all();
+}
+
+stats::NamedStats MemoryBudget::sample_stats() const {
+    stats::NamedStats stats;
+    stats["current_bytes"] = static_cast<double>(current_bytes());
+    stats["peak_bytes"] = static_cast<double>(peak_bytes());
+    stats["limit_bytes"] = static_cast<double>(limit());
+    stats["blocked_ms"] = static_cast<double>(m_blocked_ns.load()) / 1e6;
+    return stats;
+}
+
+}  // namespace dorado::utils
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "stats.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace dorado::utils {
+
+class MemoryBudget;
+
+// Bytes charged to a MemoryBudget, which are released when this is destroyed.
+// Move only.  Safe to add to from several threads at once.
+class MemoryCharge {
+public:
+    MemoryCharge() = default;
+    // Takes ownership of bytes already charged to budget.
+    MemoryCharge(MemoryBudget& budget, uint64_t bytes) : m_budget(&budget), m_bytes(bytes) {}
+    MemoryCharge(MemoryCharge&& other) noexcept;
+    MemoryCharge& operator=(MemoryCharge&& other) noexcept;
+    ~MemoryCharge() { reset(); }
+
+    // Charges more bytes to the budget without blocking, e.g. as results accumulate for
+    // something that has already been admitted.  Does nothing if this is empty.
+    void add(uint64_t bytes);
+    // Releases up to bytes of the charge early, e.g. when part of what was charged for
+    // has been freed.
+    void remove(uint64_t bytes);
+    // Releases the charged bytes back to the budget.
+    void reset();
+
+    // Releases the charged bytes while what was charged for is held somewhere that mustn't
+    // hold back admissions, keeping track of them so that resume() can charge them again
+    // without blocking.  Bytes added in between are charged as usual.
+    void suspend();
+    void resume();
+
+    // A charge of bytes to the same budget, made without blocking, e.g. for a read derived
+    // from the one this charge is for.  Empty if this is.
+    MemoryCharge derive(uint64_t bytes) const;
+
+    uint64_t bytes() const { return m_bytes.load(std::memory_order_relaxed); }
+
+private:
+    MemoryBudget* m_budget{nullptr};
+    std::atomic<uint64_t> m_bytes{0};
+    // Bytes released by suspend().
+    std::atomic<uint64_t> m_suspended_bytes{0};
+};
+
+// Accounts for the bytes held by reads in flight through a pipeline, so that loaders
+// can stop admitting reads once a limit is reached, however long the reads are.
+// Limits are soft: an admission that would exceed the limit waits until enough has been
+// released, except when nothing is in flight, so a single read bigger than the whole
+// budget can't stall the pipeline.  Bytes added after admission never wait.
+class MemoryBudget {
+public:
+    // A limit of 0 means unlimited.
+    explicit MemoryBudget(uint64_t limit_bytes = 0) : m_limit_bytes(limit_bytes) {}
+
+    // Process-wide budget, unlimited until set_limit is called.
+    static MemoryBudget& global();
+
+    void set_limit(uint64_t limit_bytes);
+    uint64_t limit() const;
+
+    // Blocks until bytes fit within the limit, then charges them.
+    MemoryCharge acquire(uint64_t bytes);
+
+    // Non-blocking charge and release, for callers managing their own accounting.
+    void charge(uint64_t bytes);
+    void release(uint64_t bytes);
+
+    uint64_t current_bytes() const { return m_current_bytes.load(); }
+    uint64_t peak_bytes() const { return m_peak_bytes.load(); }
+
+    std::string get_name() const { return "MemoryBudget"; }
+    stats::NamedStats sample_stats() const;
+
+private:
+    bool has_room(uint64_t bytes) const;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_released_cv;
+    uint64_t m_limit_bytes;  // Guarded by m_mutex.
+
+    std::atomic<uint64_t> m_current_bytes{0};
+    std::atomic<uint64_t> m_peak_bytes{0};
+    // Total time spent waiting in acquire.
+    std::atomic<uint64_t> m_blocked_ns{0};
+};
+
+}  // namespace dorado::utils
@@ -0,0 +1,328 @@
+#pragma once
+
+#include "AsyncQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Bounded multi-producer/multi-consumer queue implemented as a ring buffer of
+// sequence-numbered slots, after Dmitry Vyukov's bounded MPMC queue.
+// Pushes and pops are lock free: each claims a position with a CAS on a shared
+// counter, and a slot's sequence number says whether it is ready to be written
+// or read at that position.  For position pos, a slot with sequence 2 * pos is
+// free to be written, and one with sequence 2 * pos + 1 holds an item to be read.
+// (Vyukov uses pos and pos + 1, which can't distinguish the two states when
+// capacity is 1.)
+// Threads that find the queue full/empty spin briefly before parking on a
+// condition variable, so the mutexes are only touched when a thread actually
+// has to sleep, or when waking a sleeping thread.
+// Items must be default constructible and movable.
+template <class Item>
+class RingBufferQueue final : public AsyncQueueBase<Item> {
+    using Clock = typename AsyncQueueBase<Item>::Clock;
+
+    // Each slot sits on its own cache line so that producers and consumers working
+    // on adjacent positions don't contend.
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence;
+        Item item;
+        typename Clock::time_point push_time;
+    };
+
+    // Number of failed attempts at a push/pop before a thread parks.
+    static constexpr int kSpinCount = 64;
+
+    const size_t m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+
+    // Next position to push to / pop from.  Each counts the number of successful
+    // operations of its type, since a claimed position is always completed.
+    alignas(64) std::atomic<size_t> m_enqueue_pos{0};
+    alignas(64) std::atomic<size_t> m_dequeue_pos{0};
+
+    // If true, parked threads should wake, and pushes fail.  Pops still succeed
+    // while there are items left.
+    alignas(64) std::atomic<bool> m_terminate{false};
+
+    // Parking state for producers waiting for space.
+    std::mutex m_not_full_mutex;
+    std::condition_variable m_not_full_cv;
+    std::atomic<int> m_num_waiting_producers{0};
+
+    // Parking state for consumers waiting for items.
+    std::mutex m_not_empty_mutex;
+    std::condition_variable m_not_empty_cv;
+    std::atomic<int> m_num_waiting_consumers{0};
+
+    // Non-blocking push.  On success the item is moved from and true is returned.
+    bool enqueue(Item& item, typename Clock::time_point push_time) {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = m_slots[pos % m_capacity];
+            const size_t seq = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - 2 * pos);
+            if (diff == 0) {
+                // Slot is free at this position: try to claim it.
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                        std::memory_order_relaxed)) {
+                    slot.item = std::move(item);
+                    slot.push_time = push_time;
+                    slot.sequence.store(2 * pos + 1, std::memory_order_release);
+                    return true;
+                }
+                // CAS failure reloaded pos.
+            } else if (diff < 0) {
+                // The slot still holds the item from the previous lap: the queue is full.
+                return false;
+            } else {
+                // Another producer got here first.
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Non-blocking pop.  On success the item is moved into item, the time it was pushed
+    // into push_time, and true is returned.
+    bool dequeue(Item& item, typename Clock::time_point& push_time) {
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = m_slots[pos % m_capacity];
+            const size_t seq = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - (2 * pos + 1));
+            if (diff == 0) {
+                // Slot has been written at this position: try to claim it.
+                if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                                        std::memory_order_relaxed)) {
+                    item = std::move(slot.item);
+                    push_time = slot.push_time;
+                    // Mark the slot as free for the producer one lap ahead.
+                    slot.sequence.store(2 * (pos + m_capacity), std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // Nothing has been written here yet: the queue is empty.
+                return false;
+            } else {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Wakes parked threads, if there are any.  The fence pairs with the one taken
+    // before parking, so that either the waker sees the waiter's count, or the
+    // waiter sees the state change that prompted the wake.
+    static void wake(std::mutex& mutex,
+                     std::condition_variable& cv,
+                     const std::atomic<int>& num_waiting,
+                     bool wake_all = false) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (num_waiting.load(std::memory_order_relaxed) > 0) {
+            // Taking the mutex ensures the waiter is either inside wait(), or has
+            // yet to evaluate its predicate, so the notification can't be lost.
+            { std::lock_guard lock(mutex); }
+            if (wake_all) {
+                cv.notify_all();
+            } else {
+                cv.notify_one();
+            }
+        }
+    }
+
+    // Repeatedly attempts op until it succeeds or should_stop returns true,
+    // spinning for a while before parking on cv.  Returns true if op succeeded.
+    // If the first attempt fails, the time until returning is recorded in blocked_ns.
+    template <class Op, class ShouldStop>
+    bool spin_then_park(Op&& op,
+                        ShouldStop&& should_stop,
+                        std::mutex& mutex,
+                        std::condition_variable& cv,
+                        std::atomic<int>& num_waiting,
+                        dorado::utils::LogHistogram& blocked_ns) {
+        if (op()) {
+            return true;
+        }
+        const auto wait_start = Clock::now();
+        auto record_blocked = [&] {
+            blocked_ns.record(this->elapsed_ns(wait_start, Clock::now()));
+        };
+
+        for (int i = 0; i < kSpinCount; ++i) {
+            if (should_stop()) {
+                record_blocked();
+                return false;
+            }
+            if (op()) {
+                record_blocked();
+                return true;
+            }
+        }
+
+        bool success = false;
+        ++num_waiting;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [&] { return (success = op()) || should_stop(); });
+        }
+        --num_waiting;
+        record_blocked();
+        return success;
+    }
+
+    bool push_one(Item& item, typename Clock::time_point push_time) {
+        const bool success = spin_then_park(
+                [this, &item, push_time] {
+                    return !m_terminate.load() && enqueue(item, push_time);
+                },
+                [this] { return m_terminate.load(); }, m_not_full_mutex, m_not_full_cv,
+                m_num_waiting_producers, this->m_push_blocked_ns);
+        if (success) {
+            wake(m_not_empty_mutex, m_not_empty_cv, m_num_waiting_consumers);
+        }
+        return success;
+    }
+
+    bool pop_one(Item& item) {
+        // Termination takes effect once all items have been popped from the queue.
+        typename Clock::time_point push_time;
+        const bool success = spin_then_park(
+                [this, &item, &push_time] { return dequeue(item, push_time); },
+                [this] { return m_terminate.load() && empty(); }, m_not_empty_mutex,
+                m_not_empty_cv, m_num_waiting_consumers, this->m_pop_blocked_ns);
+        if (success) {
+            this->m_dwell_time_ns.record(this->elapsed_ns(push_time, Clock::now()));
+            wake(m_not_full_mutex, m_not_full_cv, m_num_waiting_producers);
+        }
+        return success;
+    }
+
+    bool empty() const {
+        return m_dequeue_pos.load(std::memory_order_acquire) >=
+               m_enqueue_pos.load(std::memory_order_acquire);
+    }
+
+public:
+    // Attempts to push items beyond capacity will block.
+    RingBufferQueue(size_t capacity)
+            : m_capacity(std::max<size_t>(capacity, 1)), m_slots(new Slot[m_capacity]) {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            m_slots[i].sequence.store(2 * i, std::memory_order_relaxed);
+        }
+    }
+
+    ~RingBufferQueue() override {
+        // Ensure parked threads wake before destruction.
+        terminate();
+    }
+
+    bool try_push(Item&& item) override { return push_one(item, Clock::now()); }
+
+    bool try_pop(Item& item) override { return pop_one(item); }
+
+    // Pushes are lock free, so this is a convenience for parity with AsyncQueue.
+    bool try_push_batch(std::vector<Item>&& items) override {
+        const auto push_time = Clock::now();
+        for (auto& item : items) {
+            if (!push_one(item, push_time)) {
+                items.clear();
+                return false;
+            }
+        }
+        items.clear();
+        return true;
+    }
+
+    // Blocks for the first item, then takes whatever else is immediately available,
+    // up to max_items in total.
+    bool try_pop_batch(std::vector<Item>& items, size_t max_items) override {
+        if (max_items == 0) {
+            return true;
+        }
+        Item item;
+        if (!pop_one(item)) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        size_t num_popped = 1;
+        typename Clock::time_point push_time;
+        while (num_popped < max_items && dequeue(item, push_time)) {
+            items.push_back(std::move(item));
+            this->m_dwell_time_ns.record(this->elapsed_ns(push_time, Clock::now()));
+            ++num_popped;
+        }
+        if (num_popped > 1) {
+            // Several slots were freed, so several producers may be able to proceed.
+            wake(m_not_full_mutex, m_not_full_cv, m_num_waiting_producers, true);
+        }
+        return true;
+    }
+
+    bool try_pop_batch_until(std::vector<Item>& items,
+                             size_t max_items,
+                             std::chrono::steady_clock::time_point deadline) override {
+        size_t num_popped = 0;
+        Item item;
+        typename Clock::time_point push_time;
+        while (num_popped < max_items) {
+            if (dequeue(item, push_time)) {
+                items.push_back(std::move(item));
+                this->m_dwell_time_ns.record(this->elapsed_ns(push_time, Clock::now()));
+                ++num_popped;
+                wake(m_not_full_mutex, m_not_full_cv, m_num_waiting_producers);
+                continue;
+            }
+            if (m_terminate.load() || std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+
+            // Park until more items arrive, we're terminated, or the deadline passes.
+            const auto wait_start = Clock::now();
+            ++m_num_waiting_consumers;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            {
+                std::unique_lock lock(m_not_empty_mutex);
+                m_not_empty_cv.wait_until(lock, deadline,
+                                          [this] { return !empty() || m_terminate.load(); });
+            }
+            --m_num_waiting_consumers;
+            this->m_pop_blocked_ns.record(this->elapsed_ns(wait_start, Clock::now()));
+        }
+
+        if (num_popped == 0 && m_terminate.load() && empty()) {
+            return false;
+        }
+        return true;
+    }
+
+    // Tells the queue to terminate any parked waits.
+    void terminate() override {
+        m_terminate.store(true);
+        // Take each mutex so parked threads are guaranteed to observe the flag.
+        { std::lock_guard lock(m_not_full_mutex); }
+        m_not_full_cv.notify_all();
+        { std::lock_guard lock(m_not_empty_mutex); }
+        m_not_empty_cv.notify_all();
+    }
+
+    std::string get_name() const override { return "queue"; }
+
+    std::unordered_map<std::string, double> sample_stats() const override {
+        std::unordered_map<std::string, double> stats;
+        // Pops are read first so that items can't appear negative.
+        const auto num_pops = m_dequeue_pos.load();
+        const auto num_pushes = m_enqueue_pos.load();
+        stats["items"] = static_cast<double>(num_pushes - num_pops);
+        stats["pushes"] = static_cast<double>(num_pushes);
+        stats["pops"] = static_cast<double>(num_pops);
+        this->add_timing_stats(stats);
+        return stats;
+    }
+};
@@ -0,0 +1,167 @@
+#include "WorkStealingExecutor.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace {
+
+// The executor and worker index of the current thread, if it's a worker.
+thread_local const dorado::utils::WorkStealingExecutor* t_executor = nullptr;
+thread_local size_t t_worker_index = 0;
+
+}  // namespace
+
+namespace dorado::utils {
+
+WorkStealingExecutor::WorkStealingExecutor(size_t num_threads) {
+    num_threads = std::max<size_t>(num_threads, 1);
+    for (size_t i = 0; i < num_threads; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+        m_threads.emplace_back(&WorkStealingExecutor::worker_thread, this, i);
+    }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+    {
+        std::lock_guard lock(m_sleep_mutex);
+        m_terminate = true;
+    }
+    m_sleep_cv.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+WorkStealingExecutor& WorkStealingExecutor::global() {
+    static WorkStealingExecutor executor(std::thread::hardware_concurrency());
+    return executor;
+}
+
+void WorkStealingExecutor::submit(Task task) {
+    const size_t index = (t_executor == this)
+                                 ? t_worker_index
+                                 : m_next_worker.fetch_add(1, std::memory_order_relaxed) %
+                                           m_workers.size();
+    {
+        std::lock_guard lock(m_workers[index]->mutex);
+        m_workers[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // Taking the mutex ensures a worker about to sleep sees the new count.
+        std::lock_guard lock(m_sleep_mutex);
+        ++m_num_queued;
+    }
+    m_sleep_cv.notify_one();
+}
+
+bool WorkStealingExecutor::pop_task(size_t index, Task& task) {
+    // Most recently queued task from our own deque, since its data is likely to still
+    // be in cache.
+    {
+        auto& worker = *m_workers[index];
+        std::lock_guard lock(worker.mutex);
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            return true;
+        }
+    }
+    // Otherwise the oldest task from someone else's.
+    for (size_t offset = 1; offset < m_workers.size(); ++offset) {
+        auto& victim = *m_workers[(index + offset) % m_workers.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingExecutor::worker_thread(size_t index) {
+    t_executor = this;
+    t_worker_index = index;
+
+    Task task;
+    while (true) {
+        if (pop_task(index, task)) {
+            --m_num_queued;
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock lock(m_sleep_mutex);
+        m_sleep_cv.wait(lock, [this] { return m_num_queued > 0 || m_terminate; });
+        if (m_terminate && m_num_queued == 0) {
+            return;
+        }
+    }
+}
+
+void WorkStealingExecutor::parallel_for(size_t num_items,
+                                        size_t max_concurrency,
+                                        const std::function<void(size_t, size_t)>& fn) {
+    const size_t num_slots = std::min(max_concurrency, num_items);
+    if (num_slots <= 1) {
+        for (size_t item = 0; item < num_items; ++item) {
+            fn(0, item);
+        }
+        return;
+    }
+
+    // Shared with the tasks, which may not start until after we've returned.  By then
+    // all items have been claimed, so they won't touch fn.
+    struct State {
+        const std::function<void(size_t, size_t)>* fn;
+        size_t num_items;
+        std::atomic<size_t> next_item{0};
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        size_t num_items_done = 0;
+        std::exception_ptr exception;
+    };
+    auto state = std::make_shared<State>();
+    state->fn = &fn;
+    state->num_items = num_items;
+
+    // Claims and runs items until there are none left.
+    auto run_slot = [](State& state, size_t slot) {
+        size_t num_done = 0;
+        for (size_t item = state.next_item++; item < state.num_items;
+             item = state.next_item++) {
+            try {
+                (*state.fn)(slot, item);
+            } catch (...) {
+                std::lock_guard lock(state.mutex);
+                if (!state.exception) {
+                    state.exception = std::current_exception();
+                }
+            }
+            ++num_done;
+        }
+        if (num_done > 0) {
+            std::lock_guard lock(state.mutex);
+            state.num_items_done += num_done;
+            if (state.num_items_done == state.num_items) {
+                state.done_cv.notify_all();
+            }
+        }
+    };
+
+    for (size_t slot = 1; slot < num_slots; ++slot) {
+        submit([state, slot, run_slot] { run_slot(*state, slot); });
+    }
+    run_slot(*state, 0);
+
+    std::unique_lock lock(state->mutex);
+    state->done_cv.wait(lock, [&state] { return state->num_items_done == state->num_items; });
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+}
+
+}  // namespace dorado::utils
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dorado::utils {
+
+// Pool of worker threads shared by everything that has CPU work to farm out, so that
+// the total number of runnable threads tracks the number of cores however many
+// pipeline nodes there are, and idle nodes' capacity goes to busy ones.
+// Each worker has its own deque of tasks.  Tasks submitted from a worker go on its own
+// deque, others are spread round robin.  Workers take tasks from the back of their own
+// deque and, when that's empty, steal from the front of others'.
+class WorkStealingExecutor {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingExecutor(size_t num_threads);
+    // Runs any tasks still queued, then joins the workers.
+    ~WorkStealingExecutor();
+
+    WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+    WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+    // Process-wide executor with a worker per core, created on first use.
+    static WorkStealingExecutor& global();
+
+    size_t num_threads() const { return m_threads.size(); }
+
+    // Queues a task to be run on a worker.
+    void submit(Task task);
+
+    // Calls fn(slot, i) for each i in [0, num_items), with at most max_concurrency calls
+    // in progress at once, and returns once all have completed.
+    // slot is in [0, max_concurrency) and no two calls of fn from the same parallel_for
+    // run at once with the same slot, so it can index per-thread state such as scratch
+    // buffers.
+    // The calling thread takes part, so this makes progress even if every worker is
+    // busy.  fn must not block waiting on other tasks.  If any call throws, the first
+    // exception is rethrown here once the others have completed.
+    void parallel_for(size_t num_items,
+                      size_t max_concurrency,
+                      const std::function<void(size_t slot, size_t item)>& fn);
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void worker_thread(size_t index);
+    bool pop_task(size_t index, Task& task);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    // Workers with nothing to do sleep on m_sleep_cv until tasks are queued.
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep_cv;
+    // Tasks submitted but not yet taken by a worker.  Incremented under m_sleep_mutex.
+    std::atomic<size_t> m_num_queued{0};
+    bool m_terminate{false};
+
+    // Where the next task submitted from outside the pool goes.
+    std::atomic<size_t> m_next_worker{0};
+};
+
+}  // namespace dorado::utils
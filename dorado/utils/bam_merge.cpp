@@ -0,0 +1,394 @@
+#include "bam_merge.h"
+
+#include "Version.h"
+#include "htslib/bgzf.h"
+#include "htslib/sam.h"
+#include "utils/types.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+// The empty block which ends a BGZF file.
+constexpr char kBgzfEofMarker[28] = {'\x1f', '\x8b', '\x08', '\x04', '\x00', '\x00', '\x00',
+                                     '\x00', '\x00', '\xff', '\x06', '\x00', '\x42', '\x43',
+                                     '\x02', '\x00', '\x1b', '\x00', '\x03', '\x00', '\x00',
+                                     '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00'};
+
+struct HtsFileDestructor {
+    void operator()(htsFile* file) { hts_close(file); }
+};
+using HtsFilePtr = std::unique_ptr<htsFile, HtsFileDestructor>;
+
+struct SamHdrDestructor {
+    void operator()(sam_hdr_t* hdr) { sam_hdr_destroy(hdr); }
+};
+using SamHdrPtr = std::unique_ptr<sam_hdr_t, SamHdrDestructor>;
+
+// Value of a tag in a tab separated header line, or empty if it isn't there.
+std::string get_tag(const std::string& line, const std::string& tag) {
+    const auto field = "\t" + tag + ":";
+    const auto start = line.find(field);
+    if (start == std::string::npos) {
+        return {};
+    }
+    const auto value_start = start + field.size();
+    return line.substr(value_start, line.find('\t', value_start) - value_start);
+}
+
+// line with the value of tag replaced, or added if it isn't there.
+std::string set_tag(const std::string& line, const std::string& tag, const std::string& value) {
+    const auto field = "\t" + tag + ":";
+    const auto start = line.find(field);
+    if (start == std::string::npos) {
+        return line + field + value;
+    }
+    const auto value_start = start + field.size();
+    const auto value_end = line.find('\t', value_start);
+    return line.substr(0, value_start) + value +
+           (value_end == std::string::npos ? "" : line.substr(value_end));
+}
+
+std::vector<std::string> split_lines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            lines.push_back(std::move(line));
+        }
+    }
+    return lines;
+}
+
+struct Input {
+    std::string path;
+    HtsFilePtr file;
+    SamHdrPtr header;
+};
+
+Input open_input(const std::string& path) {
+    Input input{path, HtsFilePtr(sam_open(path.c_str(), "r")), nullptr};
+    if (!input.file) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    input.header.reset(sam_hdr_read(input.file.get()));
+    if (!input.header) {
+        throw std::runtime_error("Could not read header from file: " + path);
+    }
+    return input;
+}
+
+bool is_coordinate_sorted(sam_hdr_t* header) {
+    kstring_t sort_order = {0, 0, nullptr};
+    const bool sorted = sam_hdr_find_tag_hd(header, "SO", &sort_order) == 0 &&
+                        std::strcmp(sort_order.s, "coordinate") == 0;
+    free(sort_order.s);
+    return sorted;
+}
+
+bool is_bam(htsFile* file) {
+    const auto format = hts_get_format(file);
+    return format->format == bam && format->compression == bgzf;
+}
+
+void write_record(htsFile* out, sam_hdr_t* header, const bam1_t* record) {
+    if (sam_write1(out, header, record) < 0) {
+        throw std::runtime_error("Failed to write merged record");
+    }
+}
+
+// Appends the records of a BAM to out by copying its compressed blocks, which is only valid
+// because the merged header has the same references as the input's.
+void append_bam_blocks(Input& input, BGZF* out) {
+    BGZF* in = input.file->fp.bgzf;
+    // Records which share the last block of the header are re-encoded, until the input is
+    // at a block boundary, where the offset within the block is 0.  htslib flushes the block
+    // after the header, so there usually aren't any.
+    dorado::BamPtr record(bam_init1());
+    while ((bgzf_tell(in) & 0xffff) != 0) {
+        const int res = bam_read1(in, record.get());
+        if (res == -1) {
+            return;
+        } else if (res < -1) {
+            throw std::runtime_error("Failed to read record from " + input.path);
+        }
+        if (bam_write1(out, record.get()) < 0) {
+            throw std::runtime_error("Failed to write merged record");
+        }
+    }
+    if (bgzf_flush(out) < 0 || bgzf_seek(in, bgzf_tell(in), SEEK_SET) < 0) {
+        throw std::runtime_error("Failed to copy records from " + input.path);
+    }
+
+    // The rest of the input is copied as is, except for its end of file marker, so the last
+    // bytes read are held back until it's known whether they are the marker.
+    constexpr size_t kMarkerSize = sizeof(kBgzfEofMarker);
+    constexpr size_t kCopySize = 4 << 20;
+    std::vector<char> buffer(kMarkerSize + kCopySize);
+    size_t num_held = 0;
+    while (true) {
+        const auto num_read = bgzf_raw_read(in, buffer.data() + num_held, kCopySize);
+        if (num_read < 0) {
+            throw std::runtime_error("Failed to copy records from " + input.path);
+        } else if (num_read == 0) {
+            break;
+        }
+        num_held += num_read;
+        if (num_held > kMarkerSize) {
+            const size_t num_to_write = num_held - kMarkerSize;
+            if (bgzf_raw_write(out, buffer.data(), num_to_write) < 0) {
+                throw std::runtime_error("Failed to write merged records");
+            }
+            std::memmove(buffer.data(), buffer.data() + num_to_write, kMarkerSize);
+            num_held = kMarkerSize;
+        }
+    }
+    const bool ends_with_marker =
+            num_held == kMarkerSize && std::memcmp(buffer.data(), kBgzfEofMarker, kMarkerSize) == 0;
+    if (!ends_with_marker && num_held > 0 && bgzf_raw_write(out, buffer.data(), num_held) < 0) {
+        throw std::runtime_error("Failed to write merged records");
+    }
+}
+
+void merge_by_blocks(std::vector<Input>& inputs, sam_hdr_t* header, const std::string& path) {
+    BGZF* out = bgzf_open(path.c_str(), "w");
+    if (!out) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    try {
+        if (bam_hdr_write(out, header) < 0) {
+            throw std::runtime_error("Failed to write merged header");
+        }
+        for (auto& input : inputs) {
+            append_bam_blocks(input, out);
+            input.file.reset();
+        }
+    } catch (...) {
+        bgzf_close(out);
+        throw;
+    }
+    // Closing writes the end of file marker.
+    if (bgzf_close(out) < 0) {
+        throw std::runtime_error("Failed to write merged file");
+    }
+}
+
+void merge_records(std::vector<Input>& inputs,
+                   sam_hdr_t* header,
+                   htsFile* out,
+                   bool coordinate_sorted) {
+    if (!coordinate_sorted) {
+        dorado::BamPtr record(bam_init1());
+        for (auto& input : inputs) {
+            int res;
+            while ((res = sam_read1(input.file.get(), input.header.get(), record.get())) >= 0) {
+                write_record(out, header, record.get());
+            }
+            if (res < -1) {
+                throw std::runtime_error("Failed to read record from " + input.path);
+            }
+        }
+        return;
+    }
+
+    // k-way merge on (reference, position), with unmapped reads last, and ties taken in input
+    // order so that the merge is stable.
+    using Key = std::tuple<uint32_t, int64_t, size_t>;
+    std::priority_queue<Key, std::vector<Key>, std::greater<Key>> heap;
+    std::vector<dorado::BamPtr> records;
+    auto read_next = [&](size_t index) {
+        auto& record = records[index];
+        const int res = sam_read1(inputs[index].file.get(), inputs[index].header.get(),
+                                  record.get());
+        if (res >= 0) {
+            heap.emplace(static_cast<uint32_t>(record->core.tid), record->core.pos, index);
+        } else if (res < -1) {
+            throw std::runtime_error("Failed to read record from " + inputs[index].path);
+        }
+    };
+    for (size_t index = 0; index < inputs.size(); ++index) {
+        records.emplace_back(bam_init1());
+        read_next(index);
+    }
+    while (!heap.empty()) {
+        const size_t index = std::get<2>(heap.top());
+        heap.pop();
+        write_record(out, header, records[index].get());
+        read_next(index);
+    }
+}
+
+}  // namespace
+
+namespace dorado::utils {
+
+std::string merge_header_text(const std::vector<std::string>& header_texts, bool sorted) {
+    std::string hd_line;
+    std::vector<std::string> sq_lines, rg_lines, pg_lines, co_lines;
+    std::vector<std::pair<std::string, std::string>> references;
+    bool have_references = false;
+    std::unordered_map<std::string, std::string> rg_by_id, pg_by_id;
+    std::unordered_set<std::string> co_set;
+
+    for (size_t input = 0; input < header_texts.size(); ++input) {
+        std::vector<std::pair<std::string, std::string>> input_references;
+        std::vector<std::string> input_sq_lines;
+        // PG IDs renamed in this header, so its PP tags can follow them.
+        std::unordered_map<std::string, std::string> pg_renames;
+
+        for (const auto& line : split_lines(header_texts[input])) {
+            const auto type = line.substr(0, 3);
+            if (type == "@HD") {
+                if (hd_line.empty()) {
+                    hd_line = line;
+                }
+            } else if (type == "@SQ") {
+                input_references.emplace_back(get_tag(line, "SN"), get_tag(line, "LN"));
+                input_sq_lines.push_back(line);
+            } else if (type == "@RG") {
+                const auto id = get_tag(line, "ID");
+                auto [it, inserted] = rg_by_id.emplace(id, line);
+                if (inserted) {
+                    rg_lines.push_back(line);
+                } else if (it->second != line) {
+                    throw std::runtime_error("Inputs have different read groups with ID " + id);
+                }
+            } else if (type == "@PG") {
+                auto pg_line = line;
+                const auto pp = get_tag(pg_line, "PP");
+                if (auto rename = pg_renames.find(pp); rename != pg_renames.end()) {
+                    pg_line = set_tag(pg_line, "PP", rename->second);
+                }
+                const auto id = get_tag(pg_line, "ID");
+                auto existing = pg_by_id.find(id);
+                if (existing != pg_by_id.end() && existing->second == pg_line) {
+                    continue;
+                }
+                if (existing != pg_by_id.end()) {
+                    std::string new_id;
+                    for (int suffix = 1; new_id.empty() || pg_by_id.count(new_id); ++suffix) {
+                        new_id = id + "." + std::to_string(suffix);
+                    }
+                    pg_renames[id] = new_id;
+                    pg_line = set_tag(pg_line, "ID", new_id);
+                }
+                pg_by_id.emplace(get_tag(pg_line, "ID"), pg_line);
+                pg_lines.push_back(pg_line);
+            } else if (type == "@CO") {
+                if (co_set.insert(line).second) {
+                    co_lines.push_back(line);
+                }
+            }
+        }
+
+        if (!have_references) {
+            references = std::move(input_references);
+            sq_lines = std::move(input_sq_lines);
+            have_references = true;
+        } else if (input_references != references) {
+            throw std::runtime_error(
+                    "Inputs have different @SQ lines, so were aligned to different references");
+        }
+    }
+
+    if (hd_line.empty()) {
+        hd_line = "@HD\tVN:1.6";
+    }
+    hd_line = set_tag(hd_line, "SO", sorted ? "coordinate" : "unknown");
+
+    std::string text = hd_line + "\n";
+    for (const auto* lines : {&sq_lines, &rg_lines, &pg_lines, &co_lines}) {
+        for (const auto& line : *lines) {
+            text += line + "\n";
+        }
+    }
+    return text;
+}
+
+BamMergeMode merge_bams(const std::vector<std::string>& input_paths,
+                        const std::string& output_path,
+                        int threads,
+                        const std::vector<std::string>& args) {
+    if (input_paths.empty()) {
+        throw std::runtime_error("No files to merge");
+    }
+
+    std::vector<Input> inputs;
+    std::vector<std::string> header_texts;
+    bool all_sorted = true, all_bam = true;
+    for (const auto& path : input_paths) {
+        inputs.push_back(open_input(path));
+        header_texts.emplace_back(sam_hdr_str(inputs.back().header.get()));
+        all_sorted &= is_coordinate_sorted(inputs.back().header.get());
+        all_bam &= is_bam(inputs.back().file.get());
+    }
+
+    const auto text = merge_header_text(header_texts, all_sorted);
+    SamHdrPtr header(sam_hdr_init());
+    std::string command_line = "dorado";
+    for (const auto& arg : args) {
+        command_line += " " + arg;
+    }
+    if (sam_hdr_add_lines(header.get(), text.c_str(), text.size()) < 0 ||
+        sam_hdr_add_pg(header.get(), "dorado", "VN", DORADO_VERSION, "CL", command_line.c_str(),
+                       NULL) < 0) {
+        throw std::runtime_error("Failed to create merged header");
+    }
+
+    if (all_bam && !all_sorted) {
+        spdlog::debug("> Concatenating {} BAM files by block", inputs.size());
+        merge_by_blocks(inputs, header.get(), output_path);
+        return BamMergeMode::BLOCK_COPY;
+    }
+
+    // Records have to be decoded, so (de)compression is shared out between threads.
+    htsThreadPool pool = {hts_tpool_init(std::max(threads, 1)), 0};
+    if (!pool.pool) {
+        throw std::runtime_error("Failed to create thread pool");
+    }
+    try {
+        HtsFilePtr out(sam_open(output_path.c_str(), "wb"));
+        if (!out) {
+            throw std::runtime_error("Could not open file: " + output_path);
+        }
+        for (auto& input : inputs) {
+            hts_set_thread_pool(input.file.get(), &pool);
+        }
+        hts_set_thread_pool(out.get(), &pool);
+        if (sam_hdr_write(out.get(), header.get()) < 0) {
+            throw std::runtime_error("Failed to write merged header");
+        }
+        spdlog::debug("> Merging {} files by record, sorted: {}", inputs.size(), all_sorted);
+        merge_records(inputs, header.get(), out.get(), all_sorted);
+        // Files using the pool are closed before it's destroyed.
+        inputs.clear();
+        if (hts_close(out.release()) < 0) {
+            throw std::runtime_error("Failed to write merged file");
+        }
+    } catch (...) {
+        inputs.clear();
+        hts_tpool_destroy(pool.pool);
+        throw;
+    }
+    hts_tpool_destroy(pool.pool);
+    return all_sorted ? BamMergeMode::SORTED : BamMergeMode::RECORD_COPY;
+}
+
+}  // namespace dorado::utils
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace dorado::utils {
+
+// How merge_bams combined its inputs.
+enum class BamMergeMode {
+    BLOCK_COPY,   // BAM inputs concatenated by copying their compressed blocks.
+    RECORD_COPY,  // Inputs concatenated record by record, e.g. because some are SAM.
+    SORTED,       // Coordinate sorted inputs merged into coordinate order.
+};
+
+/**
+ * Combines the text of several SAM headers into one header for their merged records.
+ *
+ * @SQ lines must name the same references in the same order, so that records' reference
+ * ids are valid in the merged file.  @RG lines are combined, and an @RG ID may only be
+ * repeated by an identical line.  @PG lines are combined, and an ID used by a different
+ * program line in an earlier header is renamed with a numeric suffix, as are references to
+ * it from later PP tags in the same header.
+ *
+ * @param header_texts The text of each header, in input order.
+ * @param sorted Whether the merged records are coordinate sorted, for the @HD SO tag.
+ * @return The merged header text.
+ * @throws std::runtime_error if the headers can't be reconciled.
+ */
+std::string merge_header_text(const std::vector<std::string>& header_texts, bool sorted);
+
+/**
+ * Merges SAM/BAM files, e.g. from sharded or resumed basecalling runs, into one BAM.
+ *
+ * If every input is coordinate sorted the records are merged into coordinate order,
+ * otherwise they are concatenated in input order.  Unsorted BAM inputs are concatenated
+ * without decompressing their records.
+ *
+ * @param input_paths Files to merge, in order.
+ * @param output_path Where to write the merged BAM, or "-" for stdout.
+ * @param threads Threads for compression and decompression when records are decoded.
+ * @param args Command line, recorded in an @PG line.
+ * @return How the inputs were merged.
+ * @throws std::runtime_error if an input can't be read, or the headers can't be reconciled.
+ */
+BamMergeMode merge_bams(const std::vector<std::string>& input_paths,
+                        const std::string& output_path,
+                        int threads,
+                        const std::vector<std::string>& args);
+
+}  // namespace dorado::utils
@@ -136,6 +136,26 @@ inline uint64_t parse_string_to_size(const std::string& num_str) {
     return size_num * multiplier;
 }
 
+// Parses a shard given as "i/N", for shard i of N numbered from 0, into (i, N).
+inline std::pair<size_t, size_t> parse_shard(const std::string& shard_str) {
+    const auto slash = shard_str.find('/');
+    auto is_number = [](const std::string& str) {
+        return !str.empty() && std::all_of(str.begin(), str.end(),
+                                           [](unsigned char c) { return std::isdigit(c); });
+    };
+    if (slash == std::string::npos || !is_number(shard_str.substr(0, slash)) ||
+        !is_number(shard_str.substr(slash + 1))) {
+        throw std::runtime_error("Shard " + shard_str + " isn't of the form i/N");
+    }
+    const auto index = std::stoul(shard_str.substr(0, slash));
+    const auto count = std::stoul(shard_str.substr(slash + 1));
+    if (index >= count) {
+        throw std::runtime_error("Shard " + shard_str + " is out of range, shards are numbered "
+                                 "from 0 to N-1");
+    }
+    return {index, count};
+}
+
 inline std::vector<std::string> extract_token_from_cli(const std::string& cmd) {
     std::stringstream ss(cmd);
     std::string token;
@@ -25,6 +25,7 @@ struct DefaultParameters {
 #endif
     int remora_threads{4};
     int remora_runners_per_caller{2};
+    int cpu_decode_threads{4};
     float methylation_threshold{0.05f};
 
     // Minimum length for a sequence to be outputted.
@@ -0,0 +1,281 @@
+#include "quantile_utils.h"
+
+#include "simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using dorado::utils::QuantileInterpolation;
+
+// Samples counted into each of several histograms in turn, so that runs of equal samples,
+// which are common in signal, don't serialise on incrementing the same counter.
+constexpr size_t kNumHistograms = 4;
+
+// The samples a quantile lies between, and how far it is from the lower one.
+struct QuantilePosition {
+    size_t lower;
+    size_t upper;
+    float t;
+};
+
+// Buffers reused by each thread's calls.
+struct QuantileScratch {
+    std::vector<QuantilePosition> positions;
+    std::vector<size_t> ranks;
+    std::vector<float> rank_values;
+    std::vector<uint32_t> counts;
+    std::vector<float> samples;
+};
+
+QuantileScratch& get_scratch() {
+    thread_local QuantileScratch scratch;
+    return scratch;
+}
+
+// Positions are computed in float, as torch and utils::quantiles do, so that results match
+// theirs exactly.
+QuantilePosition quantile_position(float q, size_t count, QuantileInterpolation interpolation) {
+    const size_t last = count - 1;
+    const float pos = q * static_cast<float>(last);
+    if (interpolation == QuantileInterpolation::LOWER) {
+        const auto rank = std::min(static_cast<size_t>(std::max(pos, 0.f)), last);
+        return {rank, rank, 0.f};
+    }
+    const auto lower = std::min(static_cast<size_t>(std::max(std::floor(pos), 0.f)), last);
+    const auto upper = std::min(static_cast<size_t>(std::max(std::ceil(pos), 0.f)), last);
+    return {lower, upper, pos - lower};
+}
+
+// Computes the quantiles from the values of the samples at the ranks they need, which
+// resolve_ranks provides given the sorted, unique ranks.
+template <typename ResolveRanks>
+void compute_quantiles(size_t count,
+                       const float* const q,
+                       size_t num_quantiles,
+                       float* const res,
+                       QuantileInterpolation interpolation,
+                       ResolveRanks&& resolve_ranks) {
+    if (count == 0) {
+        std::fill_n(res, num_quantiles, 0.f);
+        return;
+    }
+
+    auto& scratch = get_scratch();
+    scratch.positions.clear();
+    scratch.ranks.clear();
+    for (size_t i = 0; i < num_quantiles; ++i) {
+        const auto position = quantile_position(q[i], count, interpolation);
+        scratch.positions.push_back(position);
+        scratch.ranks.push_back(position.lower);
+        scratch.ranks.push_back(position.upper);
+    }
+    std::sort(scratch.ranks.begin(), scratch.ranks.end());
+    scratch.ranks.erase(std::unique(scratch.ranks.begin(), scratch.ranks.end()),
+                        scratch.ranks.end());
+
+    scratch.rank_values.resize(scratch.ranks.size());
+    resolve_ranks(scratch, scratch.ranks, scratch.rank_values.data());
+
+    auto rank_value = [&scratch](size_t rank) {
+        const auto it = std::lower_bound(scratch.ranks.begin(), scratch.ranks.end(), rank);
+        return scratch.rank_values[it - scratch.ranks.begin()];
+    };
+    for (size_t i = 0; i < num_quantiles; ++i) {
+        const auto& position = scratch.positions[i];
+        const float lower = rank_value(position.lower);
+        const float upper = rank_value(position.upper);
+        res[i] = interpolation == QuantileInterpolation::LOWER
+                         ? lower
+                         : (1 - position.t) * lower + position.t * upper;
+    }
+}
+
+// Finds the samples at each of the sorted ranks by successive partial sorts of a copy of the
+// samples, each starting where the last left off.
+template <typename T>
+void resolve_ranks_by_selection(QuantileScratch& scratch,
+                                const T* const samples,
+                                size_t count,
+                                const std::vector<size_t>& ranks,
+                                float* const values) {
+    auto& copy = scratch.samples;
+    copy.resize(count);
+    std::transform(samples, samples + count, copy.begin(),
+                   [](T sample) { return static_cast<float>(sample); });
+    auto start = copy.begin();
+    for (size_t i = 0; i < ranks.size(); ++i) {
+        const auto nth = copy.begin() + ranks[i];
+        std::nth_element(start, nth, copy.end());
+        values[i] = *nth;
+        start = nth;
+    }
+}
+
+// Maps int16 samples to themselves, and the bits of float16 samples, via key_mask 0x7fff, to
+// int16 keys which are ordered as the samples' values are.  The mapping is its own inverse.
+inline int sample_key(int sample, int key_mask) { return sample ^ ((sample >> 15) & key_mask); }
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+std::pair<int, int>
+key_range_impl(const int16_t* const samples, size_t count, int key_mask) {
+    int min_key = sample_key(samples[0], key_mask);
+    int max_key = min_key;
+    for (size_t i = 1; i < count; ++i) {
+        const int key = sample_key(samples[i], key_mask);
+        min_key = std::min(min_key, key);
+        max_key = std::max(max_key, key);
+    }
+    return {min_key, max_key};
+}
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("avx2"))) inline __m256i load_keys(const int16_t* const samples,
+                                                         __m256i key_mask) {
+    const __m256i elems = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples));
+    return _mm256_xor_si256(elems, _mm256_and_si256(_mm256_srai_epi16(elems, 15), key_mask));
+}
+
+// Finds the smallest and largest keys 16 samples at a time.
+__attribute__((target("avx2"))) std::pair<int, int> key_range_impl(const int16_t* const samples,
+                                                                   size_t count,
+                                                                   int key_mask) {
+    static constexpr size_t kUnroll = 16;
+    if (count < kUnroll) {
+        int min_key = sample_key(samples[0], key_mask);
+        int max_key = min_key;
+        for (size_t i = 1; i < count; ++i) {
+            const int key = sample_key(samples[i], key_mask);
+            min_key = std::min(min_key, key);
+            max_key = std::max(max_key, key);
+        }
+        return {min_key, max_key};
+    }
+
+    const __m256i mask_vec = _mm256_set1_epi16(static_cast<int16_t>(key_mask));
+    __m256i min_keys = load_keys(samples, mask_vec);
+    __m256i max_keys = min_keys;
+    const size_t num_chunks = count / kUnroll;
+    for (size_t chunk_i = 1; chunk_i < num_chunks; ++chunk_i) {
+        const __m256i keys = load_keys(samples + chunk_i * kUnroll, mask_vec);
+        min_keys = _mm256_min_epi16(min_keys, keys);
+        max_keys = _mm256_max_epi16(max_keys, keys);
+    }
+    // The final 0-15 samples are covered by an overlapping load of the last 16.
+    if (count % kUnroll) {
+        const __m256i keys = load_keys(samples + count - kUnroll, mask_vec);
+        min_keys = _mm256_min_epi16(min_keys, keys);
+        max_keys = _mm256_max_epi16(max_keys, keys);
+    }
+
+    alignas(32) int16_t min_lanes[kUnroll], max_lanes[kUnroll];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(min_lanes), min_keys);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(max_lanes), max_keys);
+    return {*std::min_element(min_lanes, min_lanes + kUnroll),
+            *std::max_element(max_lanes, max_lanes + kUnroll)};
+}
+#endif
+
+// Finds the samples at each of the sorted ranks from a histogram of the keys of 16 bit
+// samples, or by selection if the keys are spread over a wider range than there are samples.
+template <typename T, typename KeyToValue>
+void resolve_ranks_16bit(QuantileScratch& scratch,
+                         const T* const samples,
+                         size_t count,
+                         int key_mask,
+                         const std::vector<size_t>& ranks,
+                         float* const values,
+                         KeyToValue key_to_value) {
+    const auto* const bits = reinterpret_cast<const int16_t*>(samples);
+    const auto [min_key, max_key] = key_range_impl(bits, count, key_mask);
+    const size_t num_buckets = static_cast<size_t>(max_key - min_key) + 1;
+    if (num_buckets > count) {
+        resolve_ranks_by_selection(scratch, samples, count, ranks, values);
+        return;
+    }
+
+    auto& counts = scratch.counts;
+    counts.assign(kNumHistograms * num_buckets, 0);
+    uint32_t* histograms[kNumHistograms];
+    for (size_t h = 0; h < kNumHistograms; ++h) {
+        histograms[h] = counts.data() + h * num_buckets;
+    }
+    size_t i = 0;
+    for (; i + kNumHistograms <= count; i += kNumHistograms) {
+        for (size_t h = 0; h < kNumHistograms; ++h) {
+            ++histograms[h][sample_key(bits[i + h], key_mask) - min_key];
+        }
+    }
+    for (; i < count; ++i) {
+        ++histograms[0][sample_key(bits[i], key_mask) - min_key];
+    }
+
+    for (size_t h = 1; h < kNumHistograms; ++h) {
+        for (size_t b = 0; b < num_buckets; ++b) {
+            histograms[0][b] += histograms[h][b];
+        }
+    }
+
+    // One sweep of the cumulative counts finds every rank, as they're in ascending order.
+    size_t bucket = 0;
+    size_t cumulative_count = 0;
+    for (size_t r = 0; r < ranks.size(); ++r) {
+        while (cumulative_count + histograms[0][bucket] <= ranks[r]) {
+            cumulative_count += histograms[0][bucket++];
+        }
+        values[r] = key_to_value(static_cast<int>(bucket) + min_key);
+    }
+}
+
+}  // namespace
+
+namespace dorado::utils {
+
+void quantiles(const int16_t* const samples,
+               std::size_t count,
+               const float* const q,
+               std::size_t num_quantiles,
+               float* const res,
+               QuantileInterpolation interpolation) {
+    compute_quantiles(count, q, num_quantiles, res, interpolation,
+                      [=](QuantileScratch& scratch, const auto& ranks, float* values) {
+                          resolve_ranks_16bit(scratch, samples, count, 0, ranks, values,
+                                              [](int key) { return static_cast<float>(key); });
+                      });
+}
+
+void quantiles(const c10::Half* const samples,
+               std::size_t count,
+               const float* const q,
+               std::size_t num_quantiles,
+               float* const res,
+               QuantileInterpolation interpolation) {
+    static_assert(sizeof(c10::Half) == sizeof(int16_t));
+    compute_quantiles(
+            count, q, num_quantiles, res, interpolation,
+            [=](QuantileScratch& scratch, const auto& ranks, float* values) {
+                resolve_ranks_16bit(scratch, samples, count, 0x7fff, ranks, values, [](int key) {
+                    const auto bits = static_cast<uint16_t>(sample_key(key, 0x7fff));
+                    return static_cast<float>(c10::Half(bits, c10::Half::from_bits()));
+                });
+            });
+}
+
+void quantiles(const float* const samples,
+               std::size_t count,
+               const float* const q,
+               std::size_t num_quantiles,
+               float* const res,
+               QuantileInterpolation interpolation) {
+    compute_quantiles(count, q, num_quantiles, res, interpolation,
+                      [=](QuantileScratch& scratch, const auto& ranks, float* values) {
+                          resolve_ranks_by_selection(scratch, samples, count, ranks, values);
+                      });
+}
+
+}  // namespace dorado::utils
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <torch/torch.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dorado::utils {
+
+// How a quantile falling between two samples is computed.
+enum class QuantileInterpolation {
+    LOWER,   // The lower sample, as torch::quantile with interpolation='lower'.
+    LINEAR,  // Linear interpolation between the two samples, as utils::quantiles.
+};
+
+// Computes the num_quantiles quantiles q of count samples, writing them to res.
+//
+// All the quantiles are answered from one pass over the samples: int16 and large half
+// precision inputs are counted into a histogram of their values, and the quantiles read from
+// a single sweep of its cumulative counts, otherwise successive partial sorts over a copy
+// of the samples each narrow the range searched for the next quantile.  q is best given in
+// ascending order, though any order is answered correctly.  Histograms and copies are held
+// in per-thread buffers which are reused from call to call.
+//
+// If count is zero, every quantile is zero.
+void quantiles(const int16_t* samples,
+               std::size_t count,
+               const float* q,
+               std::size_t num_quantiles,
+               float* res,
+               QuantileInterpolation interpolation = QuantileInterpolation::LOWER);
+void quantiles(const c10::Half* samples,
+               std::size_t count,
+               const float* q,
+               std::size_t num_quantiles,
+               float* res,
+               QuantileInterpolation interpolation = QuantileInterpolation::LOWER);
+void quantiles(const float* samples,
+               std::size_t count,
+               const float* q,
+               std::size_t num_quantiles,
+               float* res,
+               QuantileInterpolation interpolation = QuantileInterpolation::LOWER);
+
+}  // namespace dorado::utils
@@ -1,69 +1,85 @@
 #include "../read_pipeline/ReadPipeline.h"
 #include "math_utils.h"
 
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
 namespace dorado::utils {
 
 void stitch_chunks(std::shared_ptr<Read> read) {
+    const auto& arena = *read->chunk_arena;
+    const auto& chunks = arena.chunks;
+
     // Calculate the chunk down sampling, round to closest int.
-    read->model_stride = div_round_closest(read->called_chunks[0]->raw_chunk_size,
-                                           read->called_chunks[0]->moves.size());
+    read->model_stride = div_round_closest(chunks[0].raw_chunk_size, arena.num_moves(0));
 
-    int start_pos = 0;
-    int mid_point_front = 0;
+    // Each chunk contributes its calls less the overlap, so this is an upper bound.
+    size_t max_moves = 0;
+    size_t max_seq_len = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        max_moves += arena.num_moves(i);
+        max_seq_len += arena.seq(i).size();
+    }
+
+    std::string seq;
+    std::string qstring;
     std::vector<uint8_t> moves;
-    std::vector<std::string> sequences;
-    std::vector<std::string> qstrings;
+    seq.reserve(max_seq_len);
+    qstring.reserve(max_seq_len);
+    moves.reserve(max_moves);
 
+    int start_pos = 0;
+    int mid_point_front = 0;
     for (int i = 0; i < read->num_chunks - 1; i++) {
-        auto current_chunk = read->called_chunks[i];
-        auto next_chunk = read->called_chunks[i + 1];
-        int overlap_size = (current_chunk->raw_chunk_size + current_chunk->input_offset) -
-                           (next_chunk->input_offset);
+        const auto& current_chunk = chunks[i];
+        const auto& next_chunk = chunks[i + 1];
+        int overlap_size = (current_chunk.raw_chunk_size + current_chunk.input_offset) -
+                           (next_chunk.input_offset);
         assert(overlap_size % read->model_stride == 0);
         int overlap_down_sampled = overlap_size / read->model_stride;
         int mid_point_rear = overlap_down_sampled / 2;
 
+        const uint8_t* current_moves = arena.moves(i);
+        const uint8_t* current_moves_end = current_moves + arena.num_moves(i);
         int current_chunk_bases_to_trim =
-                std::accumulate(std::prev(current_chunk->moves.end(), mid_point_rear),
-                                current_chunk->moves.end(), 0);
+                std::accumulate(current_moves_end - mid_point_rear, current_moves_end, 0);
 
-        int current_chunk_seq_len = current_chunk->seq.size();
-        int end_pos = current_chunk_seq_len - current_chunk_bases_to_trim;
+        const auto current_seq = arena.seq(i);
+        int end_pos = static_cast<int>(current_seq.size()) - current_chunk_bases_to_trim;
         int trimmed_len = end_pos - start_pos;
-        sequences.push_back(current_chunk->seq.substr(start_pos, trimmed_len));
-        qstrings.push_back(current_chunk->qstring.substr(start_pos, trimmed_len));
-        moves.insert(moves.end(), std::next(current_chunk->moves.begin(), mid_point_front),
-                     std::prev(current_chunk->moves.end(), mid_point_rear));
+        seq.append(current_seq.substr(start_pos, trimmed_len));
+        qstring.append(arena.qstring(i).substr(start_pos, trimmed_len));
+        moves.insert(moves.end(), current_moves + mid_point_front,
+                     current_moves_end - mid_point_rear);
 
         mid_point_front = overlap_down_sampled - mid_point_rear;
 
-        start_pos = 0;
-        for (int i = 0; i < mid_point_front; i++) {
-            start_pos += (int)next_chunk->moves[i];
-        }
+        const uint8_t* next_moves = arena.moves(i + 1);
+        start_pos = std::accumulate(next_moves, next_moves + mid_point_front, 0);
     }
 
     // Append the final chunk
-    auto& last_chunk = read->called_chunks[read->num_chunks - 1];
-    moves.insert(moves.end(), std::next(last_chunk->moves.begin(), mid_point_front),
-                 last_chunk->moves.end());
+    const size_t last_chunk = read->num_chunks - 1;
+    const uint8_t* last_moves = arena.moves(last_chunk);
+    moves.insert(moves.end(), last_moves + mid_point_front,
+                 last_moves + arena.num_moves(last_chunk));
 
     if (read->num_chunks == 1) {
         // shorten the sequence, qstring & moves where the read is shorter than chunksize
-        int last_index_in_moves_to_keep = read->raw_data.size(0) / read->model_stride;
-        moves = std::vector<uint8_t>(moves.begin(), moves.begin() + last_index_in_moves_to_keep);
+        size_t last_index_in_moves_to_keep = read->raw_data.size(0) / read->model_stride;
+        moves.resize(std::min(moves.size(), last_index_in_moves_to_keep));
         int end = std::accumulate(moves.begin(), moves.end(), 0);
-        sequences.push_back(last_chunk->seq.substr(start_pos, end));
-        qstrings.push_back(last_chunk->qstring.substr(start_pos, end));
-
+        seq.append(arena.seq(last_chunk).substr(start_pos, end));
+        qstring.append(arena.qstring(last_chunk).substr(start_pos, end));
     } else {
-        sequences.push_back(last_chunk->seq.substr(start_pos));
-        qstrings.push_back(last_chunk->qstring.substr(start_pos));
+        seq.append(arena.seq(last_chunk).substr(start_pos));
+        qstring.append(arena.qstring(last_chunk).substr(start_pos));
     }
 
     // Set the read seq and qstring
-    read->seq = std::accumulate(sequences.begin(), sequences.end(), std::string(""));
-    read->qstring = std::accumulate(qstrings.begin(), qstrings.end(), std::string(""));
+    read->seq = std::move(seq);
+    read->qstring = std::move(qstring);
     read->moves = std::move(moves);
 
     // remove partial stride overhang
@@ -1,11 +1,14 @@
 #include "tensor_utils.h"
 
+#include "quantile_utils.h"
 #include "simd.h"
 
 #include <torch/csrc/jit/serialization/pickle.h>
 #include <torch/torch.h>
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
 #include <vector>
@@ -63,6 +66,100 @@ __attribute__((target("avx2,f16c"))) void convert_f32_to_f16_impl(c10::Half* con
 }
 #endif
 
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+void convert_f16_to_f32_impl(float* const dest, const c10::Half* const src, std::size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = static_cast<float>(src[i]);
+    }
+}
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("avx2,f16c"))) void convert_f16_to_f32_impl(float* const dest,
+                                                                  const c10::Half* const src,
+                                                                  std::size_t count) {
+    // Unroll to AVX register size: 8 floats.
+    static constexpr size_t kUnroll = 8;
+
+    // Main vectorised loop: 8 elements per iteration.
+    const auto* src_ptr = src;
+    auto* dest_ptr = dest;
+    for (size_t chunk_i = 0; chunk_i < count / kUnroll; ++chunk_i) {
+        const __m128i elems_f16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr));
+        _mm256_storeu_ps(dest_ptr, _mm256_cvtph_ps(elems_f16));
+        src_ptr += kUnroll;
+        dest_ptr += kUnroll;
+    }
+
+    // Loop for final 0-7 elements.
+    const size_t remaining_count = count % kUnroll;
+    for (size_t i = 0; i < remaining_count; ++i) {
+        const __m128i elem_f16 = _mm_cvtsi32_si128(*reinterpret_cast<const uint16_t*>(src_ptr));
+        *dest_ptr = _mm_cvtss_f32(_mm_cvtph_ps(elem_f16));
+        ++src_ptr;
+        ++dest_ptr;
+    }
+}
+#endif
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+void normalise_i16_to_f16_impl(c10::Half* const dest,
+                               const int16_t* const src,
+                               std::size_t count,
+                               float shift,
+                               float scale) {
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] = c10::Half((static_cast<float>(src[i]) - shift) / scale);
+    }
+}
+
+#if ENABLE_AVX2_IMPL
+// Widens 8 samples at a time to float32, normalises them and narrows them to float16 in
+// registers, so the signal is only read and written once.
+__attribute__((target("avx2,f16c"))) void normalise_i16_to_f16_impl(c10::Half* const dest,
+                                                                    const int16_t* const src,
+                                                                    std::size_t count,
+                                                                    float shift,
+                                                                    float scale) {
+    static constexpr size_t kUnroll = 8;
+
+    // Matches torch behaviour.
+    const int kRoundNearestEven = 0;
+
+    const __m256 shift_vec = _mm256_set1_ps(shift);
+    const __m256 scale_vec = _mm256_set1_ps(scale);
+
+    // Main vectorised loop: 8 samples per iteration.
+    const auto* src_ptr = src;
+    auto* dest_ptr = dest;
+    for (size_t chunk_i = 0; chunk_i < count / kUnroll; ++chunk_i) {
+        const __m128i elems_i16 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr));
+        const __m256 elems_f32 = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(elems_i16));
+        // Division rather than multiplication by the reciprocal, so results are identical to
+        // normalising with torch.
+        const __m256 normalised = _mm256_div_ps(_mm256_sub_ps(elems_f32, shift_vec), scale_vec);
+        const __m128i elems_f16 = _mm256_cvtps_ph(normalised, kRoundNearestEven);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest_ptr), elems_f16);
+        src_ptr += kUnroll;
+        dest_ptr += kUnroll;
+    }
+
+    // Loop for final 0-7 samples.
+    const size_t remaining_count = count % kUnroll;
+    for (size_t i = 0; i < remaining_count; ++i) {
+        const __m256 elem_f32 = _mm256_set1_ps((static_cast<float>(*src_ptr) - shift) / scale);
+        const __m128i elem_f16 = _mm256_cvtps_ph(elem_f32, kRoundNearestEven);
+        *(reinterpret_cast<std::int16_t*>(dest_ptr)) =
+                static_cast<std::int16_t>(_mm_extract_epi16(elem_f16, 0));
+        ++src_ptr;
+        ++dest_ptr;
+    }
+}
+#endif
+
 }  // namespace
 
 namespace dorado::utils {
@@ -87,52 +184,21 @@ std::vector<torch::Tensor> load_tensors(const std::filesystem::path& dir,
 
 torch::Tensor quantile(const torch::Tensor t, const torch::Tensor q) {
     assert(q.dtype() == torch::kF32);
+    assert(t.is_contiguous() && q.is_contiguous());
 
-    auto tmp = t.clone();
-    auto [qval, qidx] = q.sort();
     auto res = torch::empty_like(q);
-
-    auto start = tmp.data_ptr<float>();
-    auto end = tmp.data_ptr<float>() + tmp.size(0);
-
-    for (int i = 0; i < q.size(0); i++) {
-        auto m = tmp.data_ptr<float>() +
-                 static_cast<size_t>((tmp.size(0) - 1) * qval[i].item<float>());
-        std::nth_element(start, m, end);
-        res[qidx[i]] = *m;
-        start = m;
-    }
-
+    quantiles(t.data_ptr<float>(), t.size(0), q.data_ptr<float>(), q.numel(),
+              res.data_ptr<float>());
     return res;
 }
 
 torch::Tensor quantile_counting(const torch::Tensor t, const torch::Tensor q) {
     assert(q.dtype() == torch::kF32);
-
-    auto p = t.data_ptr<int16_t>();
-    auto range_min = t.min().item<int16_t>();
-    auto range_max = t.max().item<int16_t>();
-
-    int size = t.size(0);
-
-    std::vector<int> counts(range_max - range_min + 1, 0);
-    for (int i = 0; i < size; ++i) {
-        counts[p[i] - range_min]++;
-    }
-    std::partial_sum(counts.begin(), counts.end(), counts.begin());
+    assert(t.is_contiguous() && q.is_contiguous());
 
     auto res = torch::empty_like(q);
-
-    for (size_t idx = 0; idx < q.numel(); idx++) {
-        int threshold = q[idx].item<float>() * (size - 1);
-        for (int i = 0; i < counts.size(); ++i) {
-            if (counts[i] > threshold) {
-                res[idx] = i + range_min;
-                break;
-            }
-        }
-    }
-
+    quantiles(t.data_ptr<int16_t>(), t.size(0), q.data_ptr<float>(), q.numel(),
+              res.data_ptr<float>());
     return res;
 }
 
@@ -143,6 +209,24 @@ void convert_f32_to_f16(c10::Half* const dest, const float* const src, std::size
     return convert_f32_to_f16_impl(dest, src, count);
 }
 
+// Multiversioned function dispatch doesn't work across the dorado_lib linking
+// boundary.  Without this wrapper, AVX machines still only execute the default
+// version.
+void convert_f16_to_f32(float* const dest, const c10::Half* const src, std::size_t count) {
+    return convert_f16_to_f32_impl(dest, src, count);
+}
+
+// Multiversioned function dispatch doesn't work across the dorado_lib linking
+// boundary.  Without this wrapper, AVX machines still only execute the default
+// version.
+void normalise_i16_to_f16(c10::Half* const dest,
+                          const int16_t* const src,
+                          std::size_t count,
+                          float shift,
+                          float scale) {
+    return normalise_i16_to_f16_impl(dest, src, count, shift, scale);
+}
+
 void copy_tensor_elems(torch::Tensor& dest_tensor,
                        std::size_t dest_offset,
                        const torch::Tensor& src_tensor,
@@ -174,4 +258,44 @@ void copy_tensor_elems(torch::Tensor& dest_tensor,
     }
 }
 
+void copy_signal_rows(torch::Tensor& dest_tensor,
+                      std::size_t dest_offset,
+                      std::size_t dest_row_len,
+                      const c10::Half* const src,
+                      std::size_t num_rows,
+                      std::size_t src_row_stride,
+                      std::size_t len,
+                      bool repeat_pad) {
+    assert(dest_tensor.is_contiguous());
+    assert(dest_tensor.dtype() == torch::kFloat16 || dest_tensor.dtype() == torch::kFloat32);
+    assert(dest_offset + num_rows * dest_row_len <= dest_tensor.numel());
+
+    const bool convert = dest_tensor.dtype() == torch::kFloat32;
+    const size_t elem_size = dest_tensor.element_size();
+    auto* const dest_ptr = reinterpret_cast<std::byte*>(dest_tensor.data_ptr());
+    const size_t copy_len = std::min(len, dest_row_len);
+    for (size_t row = 0; row < num_rows; ++row) {
+        auto* const row_ptr = &dest_ptr[(dest_offset + row * dest_row_len) * elem_size];
+        const auto* const src_row = &src[row * src_row_stride];
+        if (convert) {
+            convert_f16_to_f32_impl(reinterpret_cast<float*>(row_ptr), src_row, copy_len);
+        } else {
+            std::memcpy(row_ptr, src_row, copy_len * elem_size);
+        }
+
+        if (!repeat_pad || copy_len == 0) {
+            std::memset(&row_ptr[copy_len * elem_size], 0, (dest_row_len - copy_len) * elem_size);
+            continue;
+        }
+        // Repeat in place, doubling the filled length each time.  The filled length stays a
+        // multiple of copy_len, so each copy continues the repeating pattern.
+        size_t filled = copy_len;
+        while (filled < dest_row_len) {
+            const size_t count = std::min(filled, dest_row_len - filled);
+            std::memcpy(&row_ptr[filled * elem_size], row_ptr, count * elem_size);
+            filled += count;
+        }
+    }
+}
+
 }  // namespace dorado::utils
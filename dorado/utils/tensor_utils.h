@@ -3,6 +3,7 @@
 #include <torch/torch.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -18,6 +19,7 @@ std::vector<torch::Tensor> load_tensors(const std::filesystem::path& dir,
 // Computes the q-th quantiles of each row of the input tensor `t`
 // using a partial sort as opposed a full sort per torch::quantiles
 // Only `interpolation='lower'` is currently implemented.
+// See quantile_utils.h for quantiles of raw samples.
 torch::Tensor quantile(const torch::Tensor t, const torch::Tensor q);
 
 // Computes the q-th quantiles of each row of the input tensor `t`
@@ -29,6 +31,19 @@ torch::Tensor quantile_counting(const torch::Tensor t, const torch::Tensor q);
 // the result pointed to by dest.
 void convert_f32_to_f16(c10::Half* dest, const float* src, std::size_t count);
 
+// Converts count half precision elements pointed to by src to float, with
+// the result pointed to by dest.
+void convert_f16_to_f32(float* dest, const c10::Half* src, std::size_t count);
+
+// Writes (src[i] - shift) / scale for count int16 samples to dest in half precision, in one
+// pass.  Results are identical to converting to float32, normalising and converting to
+// float16 with torch.
+void normalise_i16_to_f16(c10::Half* dest,
+                          const int16_t* src,
+                          std::size_t count,
+                          float shift,
+                          float scale);
+
 // Copies count elements from src_offset elements into src to
 // dest_elements into dst.  The tensors must be contiguous.
 void copy_tensor_elems(torch::Tensor& dest_tensor,
@@ -37,4 +52,18 @@ void copy_tensor_elems(torch::Tensor& dest_tensor,
                        std::size_t src_offset,
                        std::size_t count);
 
+// Copies num_rows rows of len half precision samples, the rows src_row_stride elements
+// apart in src, to consecutive rows of dest_row_len elements starting dest_offset elements
+// into dest_tensor, which must be contiguous float16 or float32.  Samples beyond len in each
+// row are filled by repeating the row's samples from its start if repeat_pad is set, or with
+// zeros otherwise.
+void copy_signal_rows(torch::Tensor& dest_tensor,
+                      std::size_t dest_offset,
+                      std::size_t dest_row_len,
+                      const c10::Half* src,
+                      std::size_t num_rows,
+                      std::size_t src_row_stride,
+                      std::size_t len,
+                      bool repeat_pad);
+
 }  // namespace dorado::utils
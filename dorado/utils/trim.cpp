@@ -2,32 +2,32 @@
 
 #include <algorithm>
 
-namespace dorado::utils {
+namespace {
 
-int trim(const torch::Tensor &signal, float threshold, int window_size, int min_elements) {
+template <typename T>
+int trim_impl(const T *const signal,
+              int signal_len,
+              float threshold,
+              int window_size,
+              int min_elements) {
     const int min_trim = 10;
-    const int num_samples = static_cast<int>(signal.size(0)) - min_trim;
+    const int num_samples = signal_len - min_trim;
     const int num_windows = num_samples / window_size;
 
-    // Access via raw pointers because of torch indexing overhead.
-    const auto signal_f32 = signal.to(torch::kFloat32);
-    assert(signal_f32.is_contiguous());
-    const float *const signal_f32_ptr = signal_f32.data_ptr<float>();
-
     bool seen_peak = false;
     for (int pos = 0; pos < num_windows; ++pos) {
         const int start = pos * window_size + min_trim;
         const int end = start + window_size;
-        assert(start < signal.size(0));
-        assert(end <= signal.size(0));  // end is exclusive
+        assert(start < signal_len);
+        assert(end <= signal_len);  // end is exclusive
 
-        const auto num_large_enough =
-                std::count_if(&signal_f32_ptr[start], &signal_f32_ptr[end],
-                              [threshold](float elem) { return elem > threshold; });
+        const auto num_large_enough = std::count_if(
+                &signal[start], &signal[end],
+                [threshold](T elem) { return static_cast<float>(elem) > threshold; });
 
         if (num_large_enough > min_elements || seen_peak) {
             seen_peak = true;
-            if (signal_f32_ptr[end - 1] > threshold) {
+            if (static_cast<float>(signal[end - 1]) > threshold) {
                 continue;
             }
             if (end >= num_samples) {
@@ -41,4 +41,24 @@ int trim(const torch::Tensor &signal, float threshold, int window_size, int min_
     return min_trim;
 }
 
-}  // namespace dorado::utils
\ No newline at end of file
+}  // namespace
+
+namespace dorado::utils {
+
+int trim(const torch::Tensor &signal, float threshold, int window_size, int min_elements) {
+    // Access via raw pointers because of torch indexing overhead.
+    const auto signal_f32 = signal.to(torch::kFloat32);
+    assert(signal_f32.is_contiguous());
+    return trim_impl(signal_f32.data_ptr<float>(), static_cast<int>(signal.size(0)), threshold,
+                     window_size, min_elements);
+}
+
+int trim(const c10::Half *signal,
+         int signal_len,
+         float threshold,
+         int window_size,
+         int min_elements) {
+    return trim_impl(signal, signal_len, threshold, window_size, min_elements);
+}
+
+}  // namespace dorado::utils
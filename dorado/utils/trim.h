@@ -9,4 +9,12 @@ int trim(const torch::Tensor &signal,
          int window_size = 40,
          int min_elements = 3);
 
-}  // namespace dorado::utils
\ No newline at end of file
+// As above, for the first signal_len samples of a half precision signal, such as the
+// normalised signal written by normalise_i16_to_f16, without converting it to float32.
+int trim(const c10::Half *signal,
+         int signal_len,
+         float threshold = 2.4,
+         int window_size = 40,
+         int min_elements = 3);
+
+}  // namespace dorado::utils
@@ -0,0 +1,98 @@
+#include "utils/AdaptiveBatchTimeout.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+
+#define TEST_GROUP "[utils][AdaptiveBatchTimeout]"
+
+using dorado::utils::AdaptiveBatchTimeout;
+using namespace std::chrono_literals;
+
+TEST_CASE("AdaptiveBatchTimeout: Empty batches wait for the latency target", TEST_GROUP) {
+    AdaptiveBatchTimeout timeout(100ms);
+    const auto now = AdaptiveBatchTimeout::Clock::now();
+    CHECK(timeout.flush_deadline(now) == now + 100ms);
+}
+
+TEST_CASE("AdaptiveBatchTimeout: Unknown arrival rates wait for the latency target",
+          TEST_GROUP) {
+    AdaptiveBatchTimeout timeout(100ms);
+    const auto start = AdaptiveBatchTimeout::Clock::now();
+    timeout.chunks_added(4, start);
+    CHECK(timeout.idle_timeout() == 100ms);
+    CHECK(timeout.flush_deadline(start) == start + 100ms);
+}
+
+TEST_CASE("AdaptiveBatchTimeout: Frequent arrivals flush soon after they stop", TEST_GROUP) {
+    AdaptiveBatchTimeout timeout(100ms, 5ms);
+    const auto start = AdaptiveBatchTimeout::Clock::now();
+    auto now = start;
+    for (int i = 0; i < 10; ++i) {
+        timeout.chunks_added(1, now);
+        now += 2ms;
+    }
+    // 4 gaps of 2ms.
+    CHECK(timeout.idle_timeout() == 8ms);
+    CHECK(timeout.flush_deadline(now) == now - 2ms + 8ms);
+}
+
+TEST_CASE("AdaptiveBatchTimeout: Pending chunks hold off flushing on idling", TEST_GROUP) {
+    AdaptiveBatchTimeout timeout(100ms, 5ms);
+    const auto start = AdaptiveBatchTimeout::Clock::now();
+    auto now = start;
+    for (int i = 0; i < 10; ++i) {
+        timeout.chunks_added(1, now);
+        now += 2ms;
+    }
+    CHECK(timeout.flush_deadline(now, 3) == start + 100ms);
+    // Once they've arrived, the batch flushes on idling again.
+    timeout.chunks_added(3, now);
+    CHECK(timeout.flush_deadline(now, 0) == now + timeout.idle_timeout());
+    CHECK(timeout.flush_deadline(now, 0) < start + 100ms);
+    // An empty batch checks again after the latency target either way.
+    timeout.batch_called();
+    CHECK(timeout.flush_deadline(now, 3) == now + 100ms);
+}
+
+TEST_CASE("AdaptiveBatchTimeout: The idle timeout is at least min_idle", TEST_GROUP) {
+    AdaptiveBatchTimeout timeout(100ms, 5ms);
+    const auto start = AdaptiveBatchTimeout::Clock::now();
+    for (int i = 0; i < 10; ++i) {
+        timeout.chunks_added(1, start + i * 1us);
+    }
+    CHECK(timeout.idle_timeout() == 5ms);
+}
+
+TEST_CASE("AdaptiveBatchTimeout: No chunk waits longer than the latency target", TEST_GROUP) {
+    AdaptiveBatchTimeout timeout(100ms, 5ms);
+    const auto start = AdaptiveBatchTimeout::Clock::now();
+    auto now = start;
+    // A steady trickle never pauses for long enough to flush on idling.
+    for (int i = 0; i < 200; ++i) {
+        timeout.chunks_added(1, now);
+        now += 1ms;
+    }
+    CHECK(timeout.flush_deadline(now) == start + 100ms);
+
+    // The next batch starts with the next chunk.
+    timeout.batch_called();
+    CHECK(timeout.flush_deadline(now) == now + 100ms);
+    timeout.chunks_added(1, now);
+    CHECK(timeout.flush_deadline(now) == now + timeout.idle_timeout());
+}
+
+TEST_CASE("AdaptiveBatchTimeout: Idle periods don't swamp the arrival rate", TEST_GROUP) {
+    AdaptiveBatchTimeout timeout(100ms, 1ms);
+    const auto start = AdaptiveBatchTimeout::Clock::now();
+    auto now = start;
+    for (int i = 0; i < 50; ++i) {
+        timeout.chunks_added(1, now);
+        now += 2ms;
+    }
+    timeout.batch_called();
+    // A pause of a minute counts as one gap of the latency target.
+    now += std::chrono::minutes(1);
+    timeout.chunks_added(1, now);
+    CHECK(timeout.idle_timeout() < 100ms);
+}
@@ -1,12 +1,16 @@
 #include "utils/AsyncQueue.h"
+#include "utils/RingBufferQueue.h"
 
 #include <catch2/catch.hpp>
 
 #define TEST_GROUP "AsyncQueue "
 
 #include <atomic>
+#include <chrono>
 #include <iostream>
+#include <numeric>
 #include <thread>
+#include <vector>
 
 TEST_CASE(TEST_GROUP ": InputsMatchOutputs") {
     const int n = 10;
@@ -90,4 +94,148 @@ TEST_CASE(TEST_GROUP ": TerminateFromOtherThread") {
 
     // This will fail, since the wait is terminated.
     REQUIRE(!try_pop_result);
-}
\ No newline at end of file
+}
+
+TEST_CASE(TEST_GROUP ": BatchInputsMatchOutputs") {
+    const int n = 10;
+    AsyncQueue<int> queue(n);
+
+    std::vector<int> items(n);
+    std::iota(items.begin(), items.end(), 0);
+    const bool push_success = queue.try_push_batch(std::move(items));
+    REQUIRE(push_success);
+    REQUIRE(items.empty());
+
+    // Popping is limited to the requested batch size.
+    std::vector<int> popped;
+    REQUIRE(queue.try_pop_batch(popped, 4));
+    REQUIRE(popped.size() == 4);
+    REQUIRE(queue.try_pop_batch(popped, 100));
+    REQUIRE(popped.size() == n);
+    for (int i = 0; i < n; ++i) {
+        REQUIRE(popped[i] == i);
+    }
+}
+
+TEST_CASE(TEST_GROUP ": BatchPushFailsIfTerminating") {
+    AsyncQueue<int> queue(1);
+    queue.terminate();
+    const bool success = queue.try_push_batch({1, 2, 3});
+    REQUIRE(!success);
+}
+
+TEST_CASE(TEST_GROUP ": BatchPopFailsIfTerminating") {
+    AsyncQueue<int> queue(1);
+    queue.terminate();
+    std::vector<int> items;
+    const bool success = queue.try_pop_batch(items, 10);
+    REQUIRE(!success);
+    REQUIRE(items.empty());
+}
+
+// A batch larger than the queue's capacity is pushed in pieces as the
+// consumer frees up space.
+TEST_CASE(TEST_GROUP ": BatchLargerThanCapacity") {
+    const int n = 100;
+    AsyncQueue<int> queue(3);
+    std::vector<int> popped;
+
+    auto popping_thread = std::thread([&]() {
+        std::vector<int> items;
+        while (popped.size() < n && queue.try_pop_batch(items, 2)) {
+            popped.insert(popped.end(), items.begin(), items.end());
+            items.clear();
+        }
+    });
+
+    std::vector<int> items(n);
+    std::iota(items.begin(), items.end(), 0);
+    const bool success = queue.try_push_batch(std::move(items));
+    popping_thread.join();
+
+    REQUIRE(success);
+    REQUIRE(popped.size() == n);
+    for (int i = 0; i < n; ++i) {
+        REQUIRE(popped[i] == i);
+    }
+}
+
+// If the batch doesn't fill, the pop returns what is available once the deadline passes.
+TEST_CASE(TEST_GROUP ": BatchPopUntilDeadline") {
+    AsyncQueue<int> queue(10);
+    REQUIRE(queue.try_push(42));
+
+    std::vector<int> items;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+    const bool success = queue.try_pop_batch_until(items, 5, deadline);
+    REQUIRE(success);
+    REQUIRE(std::chrono::steady_clock::now() >= deadline);
+    REQUIRE(items.size() == 1);
+    REQUIRE(items[0] == 42);
+
+    // Nothing left: the deadline passes and no items are added.
+    REQUIRE(queue.try_pop_batch_until(items, 5, std::chrono::steady_clock::now()));
+    REQUIRE(items.size() == 1);
+}
+
+// A full batch is returned as soon as it is available, without waiting for the deadline.
+TEST_CASE(TEST_GROUP ": BatchPopUntilFull") {
+    AsyncQueue<int> queue(10);
+    REQUIRE(queue.try_push_batch({1, 2, 3}));
+
+    std::vector<int> items;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::hours(1);
+    REQUIRE(queue.try_pop_batch_until(items, 3, deadline));
+    REQUIRE(items == std::vector<int>{1, 2, 3});
+}
+
+// Both queue implementations report the same timing stats, which cover the latest
+// sampling interval.
+TEMPLATE_TEST_CASE(TEST_GROUP ": TimingStats", "", AsyncQueue<int>, RingBufferQueue<int>) {
+    const auto kDelay = std::chrono::milliseconds(20);
+    const double kDelayUs = 20000;
+    TestType queue(1);
+
+    // Item sits in the queue for kDelay.
+    REQUIRE(queue.try_push(1));
+    std::this_thread::sleep_for(kDelay);
+    int val = -1;
+    REQUIRE(queue.try_pop(val));
+    auto stats = queue.sample_stats();
+    CHECK(stats.at("dwell_max_us") >= kDelayUs);
+    CHECK(stats.at("dwell_p50_us") == stats.at("dwell_max_us"));
+    CHECK(stats.at("dwell_total_ms") >= kDelayUs / 1000);
+    CHECK(stats.at("push_blocked_max_us") == 0);
+    CHECK(stats.at("pop_blocked_max_us") == 0);
+
+    // Producer waits kDelay for space, consumer kDelay for an item.
+    REQUIRE(queue.try_push(2));
+    auto producer = std::thread([&queue] { queue.try_push(3); });
+    std::this_thread::sleep_for(kDelay);
+    REQUIRE(queue.try_pop(val));
+    REQUIRE(queue.try_pop(val));
+    producer.join();
+    auto consumer = std::thread([&queue, &val] { queue.try_pop(val); });
+    std::this_thread::sleep_for(kDelay);
+    REQUIRE(queue.try_push(4));
+    consumer.join();
+    REQUIRE(val == 4);
+
+    std::this_thread::sleep_for(dorado::utils::LogHistogram::kMinSampleInterval);
+    stats = queue.sample_stats();
+    CHECK(stats.at("dwell_max_us") >= kDelayUs);
+    CHECK(stats.at("push_blocked_max_us") >= kDelayUs);
+    CHECK(stats.at("pop_blocked_max_us") >= kDelayUs);
+    CHECK(stats.at("pushes") == 4);
+
+    // Sampling again within the interval gives the same stats, so any number of reporters
+    // can sample them.
+    CHECK(queue.sample_stats() == stats);
+
+    // Nothing happened in the next interval.
+    std::this_thread::sleep_for(dorado::utils::LogHistogram::kMinSampleInterval);
+    stats = queue.sample_stats();
+    CHECK(stats.at("dwell_max_us") == 0);
+    CHECK(stats.at("push_blocked_p99_us") == 0);
+    CHECK(stats.at("pop_blocked_total_ms") == 0);
+}
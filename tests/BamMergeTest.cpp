@@ -0,0 +1,147 @@
+#include "TestUtils.h"
+#include "htslib/sam.h"
+#include "read_pipeline/HtsReader.h"
+#include "utils/bam_merge.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define TEST_GROUP "[bam_utils][bam_merge]"
+
+namespace fs = std::filesystem;
+using namespace dorado;
+
+namespace {
+
+std::vector<BamPtr> read_records(const std::string& path) {
+    HtsReader reader(path);
+    std::vector<BamPtr> records;
+    while (reader.read()) {
+        records.emplace_back(bam_dup1(reader.record.get()));
+    }
+    return records;
+}
+
+// Writes every stride'th record of the small test SAM, starting from offset, to a BAM.
+void write_bam(const fs::path& path, size_t offset, size_t stride, bool sorted) {
+    const auto in_path = fs::path(get_data_dir("bam_reader")) / "small.sam";
+    auto records = read_records(in_path.string());
+    if (sorted) {
+        std::stable_sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+            return std::make_pair(uint32_t(a->core.tid), a->core.pos) <
+                   std::make_pair(uint32_t(b->core.tid), b->core.pos);
+        });
+    }
+
+    auto header = sam_hdr_dup(HtsReader(in_path.string()).header);
+    sam_hdr_update_hd(header, "SO", sorted ? "coordinate" : "unsorted");
+    auto out = sam_open(path.string().c_str(), "wb");
+    REQUIRE(sam_hdr_write(out, header) == 0);
+    for (size_t i = offset; i < records.size(); i += stride) {
+        REQUIRE(sam_write1(out, header, records[i].get()) >= 0);
+    }
+    hts_close(out);
+    sam_hdr_destroy(header);
+}
+
+struct MergeTestDir {
+    MergeTestDir() : path(fs::temp_directory_path() / "dorado_bam_merge_test") {
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~MergeTestDir() { fs::remove_all(path); }
+
+    fs::path path;
+};
+
+}  // namespace
+
+TEST_CASE("BamMergeTest: Merge header text", TEST_GROUP) {
+    const std::string sq = "@SQ\tSN:chr1\tLN:100\n@SQ\tSN:chr2\tLN:50\n";
+    const std::string header1 = "@HD\tVN:1.6\tSO:coordinate\n" + sq +
+                                "@RG\tID:run1_model\tPU:flowcell\n"
+                                "@PG\tID:basecaller\tPN:dorado\tVN:0.3.0\n"
+                                "@PG\tID:aligner\tPN:dorado\tPP:basecaller\n";
+    const std::string header2 = "@HD\tVN:1.6\tSO:coordinate\n" + sq +
+                                "@RG\tID:run1_model\tPU:flowcell\n"
+                                "@RG\tID:run2_model\tPU:flowcell\n"
+                                "@PG\tID:basecaller\tPN:dorado\tVN:0.3.1\n"
+                                "@PG\tID:aligner\tPN:dorado\tPP:basecaller\n";
+
+    CHECK(utils::merge_header_text({header1, header2}, true) ==
+          "@HD\tVN:1.6\tSO:coordinate\n" + sq +
+                  "@RG\tID:run1_model\tPU:flowcell\n"
+                  "@RG\tID:run2_model\tPU:flowcell\n"
+                  "@PG\tID:basecaller\tPN:dorado\tVN:0.3.0\n"
+                  "@PG\tID:aligner\tPN:dorado\tPP:basecaller\n"
+                  "@PG\tID:basecaller.1\tPN:dorado\tVN:0.3.1\n"
+                  "@PG\tID:aligner.1\tPN:dorado\tPP:basecaller.1\n");
+
+    // Identical headers merge to themselves, other than the sort order.
+    CHECK(utils::merge_header_text({header1, header1}, false) ==
+          "@HD\tVN:1.6\tSO:unknown\n" + header1.substr(header1.find("@SQ")));
+
+    SECTION("Different references") {
+        const std::string other_sq = "@HD\tVN:1.6\n@SQ\tSN:chr1\tLN:101\n";
+        CHECK_THROWS(utils::merge_header_text({header1, other_sq}, false));
+    }
+
+    SECTION("Conflicting read groups") {
+        const std::string other_rg = sq + "@RG\tID:run1_model\tPU:other_flowcell\n";
+        CHECK_THROWS(utils::merge_header_text({header1, other_rg}, false));
+    }
+}
+
+TEST_CASE("BamMergeTest: Merge BAMs", TEST_GROUP) {
+    MergeTestDir dir;
+    const auto in_path = fs::path(get_data_dir("bam_reader")) / "small.sam";
+    const auto num_records = read_records(in_path.string()).size();
+    const auto out_path = (dir.path / "merged.bam").string();
+
+    SECTION("Unsorted BAMs are concatenated by block") {
+        write_bam(dir.path / "a.bam", 0, 2, false);
+        write_bam(dir.path / "b.bam", 1, 2, false);
+        const std::vector<std::string> inputs = {(dir.path / "a.bam").string(),
+                                                 (dir.path / "b.bam").string()};
+        CHECK(utils::merge_bams(inputs, out_path, 1, {"merge"}) ==
+              utils::BamMergeMode::BLOCK_COPY);
+
+        const auto records = read_records(out_path);
+        REQUIRE(records.size() == num_records);
+        const auto a_records = read_records(inputs[0]);
+        CHECK(std::string(bam_get_qname(records[0])) == bam_get_qname(a_records[0]));
+        CHECK(std::string(bam_get_qname(records[a_records.size()])) ==
+              bam_get_qname(read_records(inputs[1])[0]));
+    }
+
+    SECTION("SAM inputs are concatenated by record") {
+        CHECK(utils::merge_bams({in_path.string(), in_path.string()}, out_path, 2, {"merge"}) ==
+              utils::BamMergeMode::RECORD_COPY);
+        CHECK(read_records(out_path).size() == 2 * num_records);
+    }
+
+    SECTION("Sorted BAMs are merged in order") {
+        write_bam(dir.path / "a.bam", 0, 2, true);
+        write_bam(dir.path / "b.bam", 1, 2, true);
+        CHECK(utils::merge_bams({(dir.path / "a.bam").string(), (dir.path / "b.bam").string()},
+                                out_path, 2, {"merge"}) == utils::BamMergeMode::SORTED);
+
+        const auto records = read_records(out_path);
+        REQUIRE(records.size() == num_records);
+        CHECK(std::is_sorted(records.begin(), records.end(), [](const auto& a, const auto& b) {
+            return std::make_pair(uint32_t(a->core.tid), a->core.pos) <
+                   std::make_pair(uint32_t(b->core.tid), b->core.pos);
+        }));
+        HtsReader reader(out_path);
+        kstring_t sort_order = {0, 0, nullptr};
+        REQUIRE(sam_hdr_find_tag_hd(reader.header, "SO", &sort_order) == 0);
+        CHECK(std::string(sort_order.s) == "coordinate");
+        free(sort_order.s);
+    }
+}
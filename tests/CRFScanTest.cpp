@@ -0,0 +1,149 @@
+#include "decode/CPUDecoder.h"
+#include "decode/crf_scan.h"
+
+#include <catch2/catch.hpp>
+#include <torch/torch.h>
+
+#define CUT_TAG "[CRFScan]"
+
+namespace {
+
+// The scans as CPUDecoder used to compute them, a timestep at a time with torch ops, giving
+// scores as [T + 1, N, num_states].
+torch::Tensor torch_scan(const torch::Tensor& Ms,
+                         const float fixed_stay_score,
+                         const torch::Tensor& idx,
+                         const torch::Tensor& v0) {
+    const int T = Ms.size(0);
+    const int N = Ms.size(1);
+    const int C = Ms.size(2);
+
+    torch::Tensor alpha = Ms.new_full({T + 1, N, C}, -1E38);
+    alpha[0] = v0;
+
+    for (int t = 0; t < T; t++) {
+        auto scored_steps = torch::add(alpha.index({t, torch::indexing::Slice(), idx}), Ms[t]);
+        auto scored_stay = torch::add(alpha.index({t, torch::indexing::Slice()}), fixed_stay_score)
+                                   .unsqueeze(-1);
+        auto scored_transitions = torch::cat({scored_stay, scored_steps}, -1);
+
+        alpha[t + 1] = torch::logsumexp(scored_transitions, -1);
+    }
+
+    return alpha;
+}
+
+// For each state, the indices of the 4 states that could precede it via a step transition.
+torch::Tensor predecessors(int num_states) {
+    return torch::arange(num_states)
+            .repeat_interleave(4)
+            .reshape({4, -1})
+            .t()
+            .contiguous();
+}
+
+torch::Tensor torch_forward_scores(const torch::Tensor& scores, const float fixed_stay_score) {
+    const int T = scores.size(0);
+    const int N = scores.size(1);
+    const int num_states = scores.size(2) / 4;
+    const torch::Tensor Ms = scores.reshape({T, N, -1, 4});
+    const auto v0 = Ms.new_full({{N, num_states}}, 0.0f);
+    return torch_scan(Ms, fixed_stay_score, predecessors(num_states), v0);
+}
+
+torch::Tensor torch_backward_scores(const torch::Tensor& scores, const float fixed_stay_score) {
+    const int N = scores.size(1);
+    const int num_states = scores.size(2) / 4;
+    const torch::Tensor vT = scores.new_full({N, num_states}, 0.0f);
+    const auto idx = predecessors(num_states);
+    auto idx_T = idx.flatten().argsort().reshape(idx.sizes());
+    const auto Ms_T = scores.index({torch::indexing::Slice(), torch::indexing::Slice(), idx_T});
+    // For each state, the indices of the 4 states that could succeed it via a step transition.
+    idx_T = torch::bitwise_right_shift(idx_T, 2);
+    return torch_scan(Ms_T.flip(0), fixed_stay_score, idx_T.to(torch::kInt64), vT).flip(0);
+}
+
+// Checks scores from a scan, as [N, T + 1, num_states], against the torch scan's, allowing for
+// the different order and approximations of their log-sum-exps.
+void check_scores(const torch::Tensor& scores, const torch::Tensor& expected) {
+    const auto expected_t = expected.transpose(0, 1).contiguous();
+    REQUIRE(scores.sizes() == expected_t.sizes());
+    const auto diff = (scores - expected_t).abs();
+    const auto tolerance = 1e-5f * expected_t.abs().clamp_min(1.f);
+    CHECK((diff <= tolerance).all().item<bool>());
+}
+
+}  // namespace
+
+TEST_CASE(CUT_TAG ": scans match torch", CUT_TAG) {
+    torch::manual_seed(42);
+    const float kStayScore = 2.f;
+    const int kNumTimesteps = 100;
+
+    // Partial and several blocks of chunks, for state lengths 1 to 4.
+    auto num_chunks = GENERATE(1, 5, 8, 19);
+    auto num_states = GENERATE(4, 16, 64, 256);
+    CAPTURE(num_chunks, num_states);
+
+    const auto scores = torch::randn({kNumTimesteps, num_chunks, num_states * 4}) * 2;
+
+    auto fwd = torch::empty({num_chunks, kNumTimesteps + 1, num_states});
+    dorado::crf_forward_scan(scores.data_ptr<float>(), kNumTimesteps, scores.stride(0), num_chunks,
+                             num_states, kStayScore, fwd.data_ptr<float>());
+    check_scores(fwd, torch_forward_scores(scores, kStayScore));
+
+    auto bwd = torch::empty({num_chunks, kNumTimesteps + 1, num_states});
+    dorado::crf_backward_scan(scores.data_ptr<float>(), kNumTimesteps, scores.stride(0),
+                              num_chunks, num_states, kStayScore, bwd.data_ptr<float>());
+    check_scores(bwd, torch_backward_scores(scores, kStayScore));
+}
+
+TEST_CASE(CUT_TAG ": scans read chunks from a slice of the batch", CUT_TAG) {
+    torch::manual_seed(42);
+    const float kStayScore = 2.f;
+    const int kNumTimesteps = 50;
+    const int kNumStates = 64;
+    using torch::indexing::Slice;
+
+    // CPUDecoder's tasks each scan a range of the batch's chunks.
+    const auto scores = torch::randn({kNumTimesteps, 12, kNumStates * 4});
+    const auto slice = scores.index({Slice(), Slice(3, 10)});
+
+    auto fwd = torch::empty({7, kNumTimesteps + 1, kNumStates});
+    dorado::crf_forward_scan(slice.data_ptr<float>(), kNumTimesteps, slice.stride(0), 7,
+                             kNumStates, kStayScore, fwd.data_ptr<float>());
+    check_scores(fwd, torch_forward_scores(slice.contiguous(), kStayScore));
+
+    auto bwd = torch::empty({7, kNumTimesteps + 1, kNumStates});
+    dorado::crf_backward_scan(slice.data_ptr<float>(), kNumTimesteps, slice.stride(0), 7,
+                              kNumStates, kStayScore, bwd.data_ptr<float>());
+    check_scores(bwd, torch_backward_scores(slice.contiguous(), kStayScore));
+
+    // The guides at either end are zero.
+    CHECK(torch::all(fwd.index({Slice(), 0}) == 0).item<bool>());
+    CHECK(torch::all(bwd.index({Slice(), kNumTimesteps}) == 0).item<bool>());
+}
+
+TEST_CASE(CUT_TAG ": CPUDecoder calls are the same with any number of decode threads", CUT_TAG) {
+    torch::manual_seed(42);
+    const int kNumChunks = 19;
+    // Scores for a batch with padding after the chunks to be decoded.
+    const auto scores = torch::randn({100, kNumChunks + 5, 256});
+
+    dorado::CPUDecoder decoder;
+    dorado::DecoderOptions options;
+    options.num_threads = 1;
+    const auto expected = decoder.beam_search(scores, kNumChunks, options);
+    REQUIRE(expected.size() == kNumChunks);
+
+    auto num_threads = GENERATE(2, 4, 32);
+    CAPTURE(num_threads);
+    options.num_threads = num_threads;
+    const auto chunks = decoder.beam_search(scores, kNumChunks, options);
+    REQUIRE(chunks.size() == kNumChunks);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        CHECK(chunks[i].sequence == expected[i].sequence);
+        CHECK(chunks[i].qstring == expected[i].qstring);
+        CHECK(chunks[i].moves == expected[i].moves);
+    }
+}
@@ -39,6 +39,16 @@ TEST_CASE("CliUtils: Check number string to unsigned long conversion", TEST_GROU
     SECTION("convert not a number") { CHECK_THROWS(parse_string_to_size("abcd")); }
 }
 
+TEST_CASE("CliUtils: Parse shards", TEST_GROUP) {
+    CHECK(parse_shard("0/4") == std::make_pair<size_t, size_t>(0, 4));
+    CHECK(parse_shard("3/4") == std::make_pair<size_t, size_t>(3, 4));
+    CHECK_THROWS(parse_shard("4/4"));
+    CHECK_THROWS(parse_shard("0/0"));
+    CHECK_THROWS(parse_shard("1"));
+    CHECK_THROWS(parse_shard("-1/4"));
+    CHECK_THROWS(parse_shard("a/b"));
+}
+
 TEST_CASE("CliUtils: Extract tokens from dorado cmdline", TEST_GROUP) {
     std::string cmdline = "dorado basecaller model_path dataset --option1 blah";
     std::vector<std::string> expected_tokens = {"dorado",  "basecaller", "model_path",
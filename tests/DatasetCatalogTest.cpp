@@ -0,0 +1,108 @@
+#include "TestUtils.h"
+#include "data_loader/DatasetCatalog.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+
+#define TEST_GROUP "[DatasetCatalog]"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A copy of the multi read POD5 test data, so that an index can be written alongside it.
+struct CatalogTestDir {
+    CatalogTestDir() : path(fs::temp_directory_path() / "dorado_dataset_catalog_test") {
+        fs::remove_all(path);
+        fs::create_directories(path);
+        fs::copy(get_data_dir("multi_read_pod5"), path);
+    }
+    ~CatalogTestDir() { fs::remove_all(path); }
+
+    fs::path path;
+};
+
+}  // namespace
+
+TEST_CASE("DatasetCatalog: Catalogs POD5 files", TEST_GROUP) {
+    dorado::DatasetCatalog catalog(get_data_dir("multi_read_pod5"), false, false);
+
+    REQUIRE(catalog.files().size() == 1);
+    const auto& file = catalog.files().front();
+    CHECK(file.is_pod5);
+    CHECK(file.scanned);
+    CHECK(file.num_reads() == 4);
+    CHECK(file.channels.size() == 4);
+    CHECK(file.start_samples.size() == 4);
+    CHECK(std::accumulate(file.batch_num_rows.begin(), file.batch_num_rows.end(), 0u) == 4);
+    REQUIRE(!file.run_infos.empty());
+    CHECK(file.run_infos.front().sample_rate == 4000);
+    CHECK(catalog.num_pod5_reads() == 4);
+    CHECK(catalog.num_reused_entries() == 0);
+}
+
+TEST_CASE("DatasetCatalog: Reuses a valid index", TEST_GROUP) {
+    CatalogTestDir dir;
+    const auto data_path = dir.path.string();
+
+    dorado::DatasetCatalog scanned(data_path, false, true);
+    REQUIRE(fs::exists(dir.path / dorado::DatasetCatalog::kIndexFileName));
+    CHECK(scanned.num_reused_entries() == 0);
+
+    dorado::DatasetCatalog reused(data_path, false, true);
+    CHECK(reused.num_reused_entries() == 1);
+    REQUIRE(reused.files().size() == 1);
+    CHECK(reused.files()[0].read_ids == scanned.files()[0].read_ids);
+    CHECK(reused.files()[0].channels == scanned.files()[0].channels);
+    CHECK(reused.files()[0].start_samples == scanned.files()[0].start_samples);
+    CHECK(reused.files()[0].batch_num_rows == scanned.files()[0].batch_num_rows);
+    CHECK(reused.files()[0].run_infos.size() == scanned.files()[0].run_infos.size());
+
+    SECTION("Modified files are scanned again") {
+        const auto pod5_path = dir.path / "filtered.pod5";
+        fs::last_write_time(pod5_path, fs::last_write_time(pod5_path) + std::chrono::hours(1));
+        dorado::DatasetCatalog rescanned(data_path, false, true);
+        CHECK(rescanned.num_reused_entries() == 0);
+    }
+
+    SECTION("Corrupt indexes are ignored") {
+        std::ofstream(dir.path / dorado::DatasetCatalog::kIndexFileName, std::ios::trunc)
+                << "not an index";
+        dorado::DatasetCatalog rescanned(data_path, false, true);
+        CHECK(rescanned.num_reused_entries() == 0);
+        CHECK(rescanned.num_pod5_reads() == 4);
+    }
+}
+
+TEST_CASE("DatasetCatalog: Ignores an index with a corrupt count", TEST_GROUP) {
+    CatalogTestDir dir;
+    const auto data_path = dir.path.string();
+    const auto index_path = dir.path / dorado::DatasetCatalog::kIndexFileName;
+    dorado::DatasetCatalog scanned(data_path, false, true);
+    REQUIRE(fs::exists(index_path));
+
+    // Offsets in the index of the file count, and of the only file's run info count, which
+    // follows its path, size and modification time.
+    const std::streamoff kNumEntriesOffset = 8 + 4;
+    const std::streamoff kNumRunInfosOffset =
+            kNumEntriesOffset + 8 + 4 + std::string("filtered.pod5").size() + 8 + 8;
+    auto [offset, count] = GENERATE_COPY(
+            std::make_pair(kNumEntriesOffset, uint64_t(fs::file_size(index_path))),
+            std::make_pair(kNumRunInfosOffset, uint64_t(0xffffffff)));
+    CAPTURE(offset, count);
+    {
+        std::fstream index(index_path, std::ios::binary | std::ios::in | std::ios::out);
+        index.seekp(offset);
+        const auto count_size = offset == kNumEntriesOffset ? sizeof(uint64_t) : sizeof(uint32_t);
+        index.write(reinterpret_cast<const char*>(&count), count_size);
+        REQUIRE(index);
+    }
+
+    dorado::DatasetCatalog rescanned(data_path, false, true);
+    CHECK(rescanned.num_reused_entries() == 0);
+    CHECK(rescanned.num_pod5_reads() == 4);
+}
@@ -0,0 +1,85 @@
+#include "MessageSinkUtils.h"
+#include "TestUtils.h"
+#include "data_loader/DataLoader.h"
+#include "data_loader/DatasetCatalog.h"
+#include "data_loader/DatasetShard.h"
+#include "read_pipeline/ReadPipeline.h"
+
+#include <catch2/catch.hpp>
+
+#include <filesystem>
+#include <set>
+#include <string>
+
+#define TEST_GROUP "[DatasetShard]"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::set<std::string> load_shard(const std::string& data_path, const dorado::InputShard& shard) {
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+    dorado::DataLoader loader(sink, "cpu", 1, 0);
+    loader.set_shard(shard);
+    loader.load_reads(data_path, false);
+
+    std::set<std::string> read_ids;
+    for (auto& read : sink.get_messages()) {
+        CHECK(read_ids.insert(read->read_id).second);
+    }
+    return read_ids;
+}
+
+}  // namespace
+
+TEST_CASE("DatasetShard: Shards of a single file split its reads", TEST_GROUP) {
+    const auto data_path = get_data_dir("multi_read_pod5");
+    dorado::DatasetCatalog catalog(data_path, false, false);
+    const auto all_reads = load_shard(data_path, {});
+    REQUIRE(all_reads.size() == 4);
+
+    for (bool by_channel : {false, true}) {
+        CAPTURE(by_channel);
+        std::set<std::string> sharded_reads;
+        size_t num_sharded_reads = 0;
+        for (size_t index = 0; index < 3; ++index) {
+            const dorado::InputShard shard{index, 3, by_channel};
+            dorado::DatasetShard dataset_shard(catalog, shard);
+            CHECK(dataset_shard.mode() == (by_channel ? dorado::DatasetShard::Mode::CHANNELS
+                                                      : dorado::DatasetShard::Mode::READ_IDS));
+
+            const auto shard_reads = load_shard(data_path, shard);
+            CHECK(shard_reads.size() == dataset_shard.num_pod5_reads(catalog));
+            num_sharded_reads += shard_reads.size();
+            sharded_reads.insert(shard_reads.begin(), shard_reads.end());
+        }
+        // Every read is in exactly one shard.
+        CHECK(num_sharded_reads == all_reads.size());
+        CHECK(sharded_reads == all_reads);
+    }
+}
+
+TEST_CASE("DatasetShard: Many files are sharded whole", TEST_GROUP) {
+    const auto path = fs::temp_directory_path() / "dorado_dataset_shard_test";
+    fs::remove_all(path);
+    fs::create_directories(path);
+    const auto pod5_path = fs::path(get_data_dir("multi_read_pod5")) / "filtered.pod5";
+    for (size_t i = 0; i < 2 * dorado::DatasetShard::kMinFilesPerShard; ++i) {
+        fs::copy_file(pod5_path, path / ("file_" + std::to_string(i) + ".pod5"));
+    }
+
+    dorado::DatasetCatalog catalog(path.string(), false, false);
+    for (size_t index = 0; index < 2; ++index) {
+        dorado::DatasetShard shard(catalog, {index, 2});
+        CHECK(shard.mode() == dorado::DatasetShard::Mode::FILES);
+        size_t num_files = 0;
+        for (const auto& file : catalog.files()) {
+            num_files += shard.contains_file(file.path) ? 1 : 0;
+        }
+        CHECK(num_files == dorado::DatasetShard::kMinFilesPerShard);
+        CHECK(shard.num_pod5_reads(catalog) == 4 * dorado::DatasetShard::kMinFilesPerShard);
+    }
+    CHECK_THROWS(dorado::DatasetShard(catalog, {2, 2}));
+
+    fs::remove_all(path);
+}
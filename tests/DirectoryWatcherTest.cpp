@@ -0,0 +1,127 @@
+#include "TestUtils.h"
+#include "data_loader/DatasetCatalog.h"
+#include "data_loader/DirectoryWatcher.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define TEST_GROUP "[DirectoryWatcher]"
+
+namespace fs = std::filesystem;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct WatchTestDir {
+    WatchTestDir() : path(fs::temp_directory_path() / "dorado_directory_watcher_test") {
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~WatchTestDir() { fs::remove_all(path); }
+
+    fs::path path;
+};
+
+// Only the signatures at either end are looked at, not what's between them.
+void write_pod5(const fs::path& path, bool complete) {
+    const std::string signature("\x8bPOD\r\n\x1a\n", 8);
+    std::ofstream out(path, std::ios::binary);
+    out << signature << "contents";
+    if (complete) {
+        out << signature;
+    }
+}
+
+dorado::DirectoryWatcher::Options test_options() {
+    dorado::DirectoryWatcher::Options options;
+    options.settle_time = 0ms;
+    options.poll_interval = 10ms;
+    options.idle_timeout = 0ms;
+    options.stop_file = "stop";
+    return options;
+}
+
+}  // namespace
+
+TEST_CASE("DirectoryWatcher: Recognises complete POD5 files", TEST_GROUP) {
+    WatchTestDir dir;
+    write_pod5(dir.path / "complete.pod5", true);
+    write_pod5(dir.path / "incomplete.pod5", false);
+
+    CHECK(dorado::is_complete_pod5_file((dir.path / "complete.pod5").string()));
+    CHECK_FALSE(dorado::is_complete_pod5_file((dir.path / "incomplete.pod5").string()));
+    CHECK_FALSE(dorado::is_complete_pod5_file((dir.path / "missing.pod5").string()));
+    CHECK(dorado::is_complete_pod5_file(get_data_dir("pod5") + "/single_na24385.pod5"));
+}
+
+TEST_CASE("DirectoryWatcher: Returns each complete file once", TEST_GROUP) {
+    WatchTestDir dir;
+    write_pod5(dir.path / "b.pod5", true);
+    write_pod5(dir.path / "a.pod5", true);
+    write_pod5(dir.path / "incomplete.pod5", false);
+    std::ofstream(dir.path / "other.txt") << "not a POD5 file";
+
+    dorado::DirectoryWatcher watcher(dir.path.string(), test_options());
+    CHECK(watcher.next_files() == std::vector<std::string>{(dir.path / "a.pod5").string(),
+                                                           (dir.path / "b.pod5").string()});
+
+    // The incomplete file is finished, and a new one appears.
+    write_pod5(dir.path / "incomplete.pod5", true);
+    write_pod5(dir.path / "c.pod5", true);
+    CHECK(watcher.next_files() == std::vector<std::string>{(dir.path / "c.pod5").string(),
+                                                           (dir.path / "incomplete.pod5").string()});
+
+    std::ofstream(dir.path / "stop");
+    CHECK(watcher.next_files().empty());
+    CHECK_FALSE(watcher.wait_for_files());
+}
+
+TEST_CASE("DirectoryWatcher: Files completed before the stop file are returned", TEST_GROUP) {
+    WatchTestDir dir;
+    auto options = test_options();
+    options.settle_time = std::chrono::hours(1);
+    write_pod5(dir.path / "a.pod5", true);
+    write_pod5(dir.path / "incomplete.pod5", false);
+    std::ofstream(dir.path / "stop");
+
+    // Without the stop file, a.pod5 would be waiting to settle.
+    dorado::DirectoryWatcher watcher(dir.path.string(), options);
+    CHECK(watcher.next_files() == std::vector<std::string>{(dir.path / "a.pod5").string()});
+    CHECK(watcher.next_files().empty());
+}
+
+TEST_CASE("DirectoryWatcher: Stops when idle", TEST_GROUP) {
+    WatchTestDir dir;
+    auto options = test_options();
+    options.idle_timeout = 50ms;
+    write_pod5(dir.path / "a.pod5", true);
+
+    dorado::DirectoryWatcher watcher(dir.path.string(), options);
+    CHECK(watcher.next_files().size() == 1);
+    CHECK(watcher.next_files().empty());
+}
+
+TEST_CASE("DirectoryWatcher: Time between calls doesn't count as idle", TEST_GROUP) {
+    WatchTestDir dir;
+    auto options = test_options();
+    options.idle_timeout = 50ms;
+    write_pod5(dir.path / "0.pod5", true);
+
+    dorado::DirectoryWatcher watcher(dir.path.string(), options);
+    CHECK(watcher.next_files() == std::vector<std::string>{(dir.path / "0.pod5").string()});
+
+    // As if loading each file took longer than the idle timeout, while more kept arriving.
+    for (int i = 1; i < 4; ++i) {
+        std::this_thread::sleep_for(150ms);
+        const auto path = dir.path / (std::to_string(i) + ".pod5");
+        write_pod5(path, true);
+        CHECK(watcher.next_files() == std::vector<std::string>{path.string()});
+    }
+    CHECK(watcher.next_files().empty());
+}
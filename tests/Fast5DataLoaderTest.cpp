@@ -19,7 +19,7 @@ public:
 size_t MockSink::get_read_count() {
     size_t read_count = 0;
     dorado::Message read;
-    while (m_work_queue.try_pop(read))
+    while (m_work_queue->try_pop(read))
         ++read_count;
     return read_count;
 }
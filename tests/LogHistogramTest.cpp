@@ -0,0 +1,109 @@
+#include "utils/LogHistogram.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#define TEST_GROUP "[utils][LogHistogram]"
+
+using dorado::utils::LogHistogram;
+
+TEST_CASE("LogHistogram: Empty", TEST_GROUP) {
+    LogHistogram histogram;
+    const auto summary = histogram.sample();
+    CHECK(summary.count == 0);
+    CHECK(summary.max == 0);
+    CHECK(summary.p50 == 0);
+    CHECK(summary.p99 == 0);
+}
+
+TEST_CASE("LogHistogram: Small values are exact", TEST_GROUP) {
+    LogHistogram histogram;
+    for (uint64_t value : {0, 1, 2, 3, 4, 5, 6, 7, 7, 7}) {
+        histogram.record(value);
+    }
+    const auto summary = histogram.sample();
+    CHECK(summary.count == 10);
+    CHECK(summary.sum == 42);
+    CHECK(summary.max == 7);
+    CHECK(summary.p50 == 4);
+    CHECK(summary.p90 == 7);
+}
+
+TEST_CASE("LogHistogram: Quantiles within bucket precision", TEST_GROUP) {
+    LogHistogram histogram;
+    const uint64_t num_values = 100000;
+    for (uint64_t value = 1; value <= num_values; ++value) {
+        histogram.record(value * 1000);
+    }
+    const auto summary = histogram.sample();
+    CHECK(summary.count == num_values);
+    CHECK(summary.max == num_values * 1000);
+    // Buckets are 1/8 of a power of 2 wide.
+    CHECK(summary.p50 == Approx(50000000).epsilon(0.07));
+    CHECK(summary.p90 == Approx(90000000).epsilon(0.07));
+    CHECK(summary.p99 == Approx(99000000).epsilon(0.07));
+}
+
+TEST_CASE("LogHistogram: Large values", TEST_GROUP) {
+    LogHistogram histogram;
+    histogram.record(UINT64_MAX);
+    const auto summary = histogram.sample();
+    CHECK(summary.max == UINT64_MAX);
+    CHECK(summary.p50 == UINT64_MAX);
+}
+
+TEST_CASE("LogHistogram: Samples cover an interval", TEST_GROUP) {
+    LogHistogram histogram(std::chrono::milliseconds(0));
+    histogram.record(100);
+    CHECK(histogram.sample().count == 1);
+    histogram.record(200);
+    histogram.record(50);
+    auto summary = histogram.sample();
+    CHECK(summary.count == 2);
+    CHECK(summary.sum == 250);
+    CHECK(summary.max == 200);
+    histogram.record(60);
+    summary = histogram.sample();
+    CHECK(summary.count == 1);
+    CHECK(summary.max == Approx(60).epsilon(0.07));
+    CHECK(histogram.sample().count == 0);
+}
+
+TEST_CASE("LogHistogram: Samples within the min interval are the same", TEST_GROUP) {
+    LogHistogram histogram;
+    histogram.record(100);
+    const auto summary = histogram.sample();
+    CHECK(summary.count == 1);
+    histogram.record(200);
+    CHECK(histogram.sample().count == 1);
+    CHECK(histogram.sample().max == summary.max);
+
+    std::this_thread::sleep_for(LogHistogram::kMinSampleInterval);
+    const auto next_summary = histogram.sample();
+    CHECK(next_summary.count == 1);
+    CHECK(next_summary.max == 200);
+}
+
+TEST_CASE("LogHistogram: Concurrent recording", TEST_GROUP) {
+    LogHistogram histogram;
+    const int num_threads = 8;
+    const uint64_t values_per_thread = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&histogram, values_per_thread] {
+            for (uint64_t i = 0; i < values_per_thread; ++i) {
+                histogram.record(i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const auto summary = histogram.sample();
+    CHECK(summary.count == num_threads * values_per_thread);
+    CHECK(summary.max == values_per_thread - 1);
+}
@@ -0,0 +1,106 @@
+#include "utils/MemoryBudget.h"
+
+#include <catch2/catch.hpp>
+
+#define TEST_GROUP "MemoryBudget "
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+using dorado::utils::MemoryBudget;
+using dorado::utils::MemoryCharge;
+
+TEST_CASE(TEST_GROUP ": ChargesReleasedOnDestruction") {
+    MemoryBudget budget(1000);
+    {
+        auto charge = budget.acquire(100);
+        CHECK(budget.current_bytes() == 100);
+        charge.add(50);
+        CHECK(charge.bytes() == 150);
+        CHECK(budget.current_bytes() == 150);
+
+        // Moving transfers the charge rather than duplicating it.
+        MemoryCharge moved = std::move(charge);
+        CHECK(moved.bytes() == 150);
+        CHECK(budget.current_bytes() == 150);
+    }
+    CHECK(budget.current_bytes() == 0);
+    CHECK(budget.peak_bytes() == 150);
+}
+
+TEST_CASE(TEST_GROUP ": EmptyChargeIgnoresAdds") {
+    MemoryCharge charge;
+    charge.add(100);
+    CHECK(charge.bytes() == 0);
+}
+
+TEST_CASE(TEST_GROUP ": SuspendedChargesAreRestoredOnResume") {
+    MemoryBudget budget(100);
+    auto charge = budget.acquire(80);
+    charge.suspend();
+    CHECK(charge.bytes() == 0);
+    CHECK(budget.current_bytes() == 0);
+
+    // Others can be admitted while the charge is suspended, and adds still count.
+    auto other = budget.acquire(60);
+    charge.add(10);
+    CHECK(budget.current_bytes() == 70);
+
+    // Resuming doesn't wait for room.
+    charge.resume();
+    CHECK(charge.bytes() == 90);
+    CHECK(budget.current_bytes() == 150);
+    charge.reset();
+    CHECK(budget.current_bytes() == 60);
+}
+
+TEST_CASE(TEST_GROUP ": DerivedChargesUseTheSameBudget") {
+    MemoryBudget budget(100);
+    auto charge = budget.acquire(80);
+    {
+        auto derived = charge.derive(50);
+        CHECK(derived.bytes() == 50);
+        CHECK(budget.current_bytes() == 130);
+    }
+    CHECK(budget.current_bytes() == 80);
+    CHECK(MemoryCharge().derive(50).bytes() == 0);
+}
+
+TEST_CASE(TEST_GROUP ": OversizeAdmittedWhenNothingInFlight") {
+    MemoryBudget budget(100);
+    auto charge = budget.acquire(1000);
+    CHECK(budget.current_bytes() == 1000);
+}
+
+TEST_CASE(TEST_GROUP ": AcquireBlocksUntilReleased") {
+    MemoryBudget budget(100);
+    auto first = budget.acquire(80);
+
+    std::atomic<bool> admitted{false};
+    std::thread loader([&] {
+        auto second = budget.acquire(50);
+        admitted = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK(!admitted);
+
+    first.reset();
+    loader.join();
+    CHECK(admitted);
+    CHECK(budget.current_bytes() == 0);
+
+    const auto stats = budget.sample_stats();
+    CHECK(stats.at("peak_bytes") == 80);
+    CHECK(stats.at("limit_bytes") == 100);
+    CHECK(stats.at("blocked_ms") > 0);
+}
+
+TEST_CASE(TEST_GROUP ": UnlimitedNeverBlocks") {
+    MemoryBudget budget;
+    auto first = budget.acquire(uint64_t(1) << 40);
+    auto second = budget.acquire(uint64_t(1) << 40);
+    CHECK(budget.current_bytes() == uint64_t(1) << 41);
+}
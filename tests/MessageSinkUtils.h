@@ -10,7 +10,7 @@ public:
     std::vector<T> get_messages() {
         std::vector<T> vec;
         dorado::Message message;
-        while (m_work_queue.try_pop(message)) {
+        while (m_work_queue->try_pop(message)) {
             vec.push_back(std::get<T>(std::move(message)));
         }
         return vec;
@@ -21,7 +21,7 @@ public:
         std::vector<T> msgs(count);
         for (T &msg : msgs) {
             dorado::Message message;
-            if (!m_work_queue.try_pop(message)) {
+            if (!m_work_queue->try_pop(message)) {
                 throw std::runtime_error("Sink was terminated early");
             }
             msg = std::get<T>(std::move(message));
@@ -40,7 +40,7 @@ public:
     std::vector<dorado::Message> get_messages() {
         std::vector<dorado::Message> vec;
         dorado::Message message;
-        while (m_work_queue.try_pop(message)) {
+        while (m_work_queue->try_pop(message)) {
             vec.push_back(std::move(message));
         }
         return vec;
@@ -51,7 +51,7 @@ public:
         std::vector<dorado::Message> msgs(count);
         for (dorado::Message &msg : msgs) {
             dorado::Message message;
-            if (!m_work_queue.try_pop(message)) {
+            if (!m_work_queue->try_pop(message)) {
                 throw std::runtime_error("Sink was terminated early");
             }
             msg = std::move(message);
@@ -27,6 +27,7 @@
 #include <filesystem>
 #include <functional>
 #include <random>
+#include <set>
 
 namespace {
 
@@ -81,8 +82,9 @@ protected:
         return *m_sink;
     }
 
+    // Returns the messages the node sent on.
     template <typename Node>
-    void run_smoke_test(Node& node) {
+    std::vector<MessageT> run_smoke_test(Node& node) {
         // Throw some reads at it
         for (std::size_t i = 0; i < m_num_reads; i++) {
             auto read = make_test_read("read_" + std::to_string(i));
@@ -93,7 +95,7 @@ protected:
         }
 
         // Wait for them to complete
-        m_sink->wait_for_messages(m_num_reads);
+        return m_sink->wait_for_messages(m_num_reads);
     }
 };
 
@@ -166,6 +168,12 @@ DEFINE_TEST(NodeSmokeTestRead, "BasecallerNode") {
     auto gpu = GENERATE(true, false);
     CAPTURE(gpu);
 
+    // Reads arriving at the basecaller haven't been called yet.
+    set_read_mutator([](std::unique_ptr<dorado::Read>& read) {
+        read->seq.clear();
+        read->qstring.clear();
+    });
+
     const int kBatchTimeoutMS = 100;
     auto const& default_params = dorado::utils::default_parameters;
     char const model_name[] = "dna_r10.4.1_e8.2_400bps_fast@v4.2.0";
@@ -212,6 +220,77 @@ DEFINE_TEST(NodeSmokeTestRead, "BasecallerNode") {
     run_smoke_test(basecaller_node);
 }
 
+DEFINE_TEST(NodeSmokeTestRead, "BasecallerNode with several chunk sizes") {
+    // Reads arriving at the basecaller haven't been called yet.
+    set_read_mutator([](std::unique_ptr<dorado::Read>& read) {
+        read->seq.clear();
+        read->qstring.clear();
+    });
+
+    const int kBatchTimeoutMS = 100;
+    auto const& default_params = dorado::utils::default_parameters;
+    char const model_name[] = "dna_r10.4.1_e8.2_400bps_fast@v4.2.0";
+    auto const model_dir = download_model(model_name);
+    auto const model_path = (model_dir.m_path / model_name).string();
+
+    // Reads go to whichever runners' chunk size suits them.
+    const std::size_t batch_size = 128;
+    std::vector<dorado::Runner> runners;
+    for (int chunk_size : {default_params.chunksize, 3000}) {
+        runners.push_back(std::make_shared<dorado::ModelRunner<dorado::CPUDecoder>>(
+                model_path, "cpu", chunk_size, batch_size));
+    }
+
+    dorado::BasecallerNode basecaller_node(get_sink(), std::move(runners),
+                                           dorado::utils::default_parameters.overlap,
+                                           kBatchTimeoutMS, model_name);
+    run_smoke_test(basecaller_node);
+}
+
+DEFINE_TEST(NodeSmokeTestRead, "BasecallerNode sends each read on once") {
+    // Reads of several chunks, in batches of fewer chunks, so that most reads are called
+    // over several batches.
+    const int kChunkSize = 2000;
+    const std::size_t kBatchSize = 4;
+    set_num_reads(20);
+    set_read_mutator([this](std::unique_ptr<dorado::Read>& read) {
+        read->raw_data = torch::rand(random_between(kChunkSize, 6 * kChunkSize));
+        read->seq.clear();
+        read->qstring.clear();
+    });
+
+    const int kBatchTimeoutMS = 100;
+    char const model_name[] = "dna_r10.4.1_e8.2_400bps_fast@v4.2.0";
+    auto const model_dir = download_model(model_name);
+    auto const model_path = (model_dir.m_path / model_name).string();
+    std::vector<dorado::Runner> runners;
+    runners.push_back(std::make_shared<dorado::ModelRunner<dorado::CPUDecoder>>(
+            model_path, "cpu", kChunkSize, kBatchSize));
+
+    auto& sink = get_sink();
+    dorado::BasecallerNode basecaller_node(sink, std::move(runners),
+                                           dorado::utils::default_parameters.overlap,
+                                           kBatchTimeoutMS, model_name);
+    const auto reads = run_smoke_test(basecaller_node);
+
+    std::set<std::string> read_ids;
+    for (const auto& read : reads) {
+        read_ids.insert(read->read_id);
+    }
+    CHECK(read_ids.size() == reads.size());
+
+    // Sampling stats doesn't reset them.
+    const auto stats = basecaller_node.sample_stats();
+    CHECK(stats.at("read_latency_p50_ms") > 0);
+    CHECK(stats.at("read_latency_max_ms") >= stats.at("read_latency_p99_ms"));
+    CHECK(basecaller_node.sample_stats().at("read_latency_max_ms") ==
+          stats.at("read_latency_max_ms"));
+
+    // Nothing more is sent on once the node has finished.
+    basecaller_node.terminate();
+    CHECK(sink.get_messages().empty());
+}
+
 DEFINE_TEST(NodeSmokeTestRead, "ModBaseCallerNode") {
     auto gpu = GENERATE(true, false);
     CAPTURE(gpu);
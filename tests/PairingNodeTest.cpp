@@ -1,9 +1,14 @@
 #include "read_pipeline/PairingNode.h"
 
 #include "MessageSinkUtils.h"
+#include "utils/MemoryBudget.h"
 #include "utils/time_utils.h"
 
 #include <catch2/catch.hpp>
+#include <torch/torch.h>
+
+#include <chrono>
+#include <future>
 
 #define TEST_GROUP "[PairingNodeTest]"
 
@@ -64,3 +69,41 @@ TEST_CASE("Split read pairing", TEST_GROUP) {
             });
     CHECK(num_pairs == 1);
 }
+
+TEST_CASE("Held reads don't count against the memory budget", TEST_GROUP) {
+    // Every read is from the same pore, so the node holds them all until it's terminated.
+    // With a budget smaller than two reads, a loader charging reads as DataLoader does
+    // would wait forever on the reads being held.
+    auto& budget = dorado::utils::MemoryBudget::global();
+    const auto read_bytes = 10000 * sizeof(int16_t);
+    budget.set_limit(read_bytes + read_bytes / 2);
+
+    MessageSinkToVector<dorado::Message> sink(100);
+    dorado::PairingNode pairing_node(sink, std::nullopt, 2, 2);
+    auto loader = std::async(std::launch::async, [&] {
+        for (int i = 0; i < 20; ++i) {
+            auto read = make_read(i * 10000, 1000);
+            read->raw_data = torch::zeros({10000}, torch::kInt16);
+            read->memory_charge = budget.acquire(read_bytes);
+            pairing_node.push_message(std::move(read));
+        }
+    });
+
+    const bool loaded = loader.wait_for(std::chrono::seconds(10)) == std::future_status::ready;
+    // Lift the limit either way, so a failure doesn't hang the test or leak into others.
+    budget.set_limit(0);
+    loader.wait();
+    CHECK(loaded);
+
+    pairing_node.terminate();
+    auto messages = sink.get_messages();
+    auto num_reads =
+            std::count_if(messages.begin(), messages.end(), [](const dorado::Message& message) {
+                return std::holds_alternative<std::shared_ptr<dorado::Read>>(message);
+            });
+    CHECK(num_reads == 20);
+    // Reads count again once they're sent on.
+    CHECK(budget.current_bytes() == 20 * read_bytes);
+    messages.clear();
+    CHECK(budget.current_bytes() == 0);
+}
@@ -0,0 +1,224 @@
+#include "MessageSinkUtils.h"
+#include "read_pipeline/Pipeline.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define TEST_GROUP "[read_pipeline][Pipeline]"
+
+namespace {
+
+// Forwards every message it receives to its outputs.
+class PassthroughNode : public dorado::MessageSink {
+public:
+    PassthroughNode(MessageSink& sink, bool needs_raw_data = false)
+            : MessageSink(100), m_needs_raw_data(needs_raw_data) {
+        add_output(sink);
+        m_worker = std::thread(&PassthroughNode::worker_thread, this);
+    }
+    ~PassthroughNode() {
+        terminate();
+        m_worker.join();
+        terminate_outputs();
+    }
+    bool needs_raw_data() const override { return m_needs_raw_data; }
+
+private:
+    void worker_thread() {
+        dorado::Message message;
+        while (m_work_queue->try_pop(message)) {
+            send_message_to_sink(std::move(message));
+        }
+        terminate_outputs();
+    }
+
+    std::thread m_worker;
+    const bool m_needs_raw_data;
+};
+
+// Processes messages with process_messages_in_order, using fn.
+class ProcessingNode : public dorado::MessageSink {
+public:
+    ProcessingNode(MessageSink& sink, size_t max_concurrency, MessageProcessor fn)
+            : MessageSink(100), m_max_concurrency(max_concurrency), m_fn(std::move(fn)) {
+        add_output(sink);
+        m_worker = std::thread(&ProcessingNode::worker_thread, this);
+    }
+    ~ProcessingNode() {
+        terminate();
+        m_worker.join();
+        terminate_outputs();
+    }
+
+private:
+    void worker_thread() {
+        process_messages_in_order(m_max_concurrency, m_fn);
+        terminate_outputs();
+    }
+
+    std::thread m_worker;
+    const size_t m_max_concurrency;
+    const MessageProcessor m_fn;
+};
+
+std::shared_ptr<dorado::Read> make_read(std::string read_id) {
+    auto read = std::make_shared<dorado::Read>();
+    read->read_id = std::move(read_id);
+    return read;
+}
+
+std::vector<std::string> get_read_ids(
+        MessageSinkToVector<std::shared_ptr<dorado::Read>>& sink) {
+    std::vector<std::string> read_ids;
+    for (auto& read : sink.get_messages()) {
+        read_ids.push_back(read->read_id);
+    }
+    std::sort(read_ids.begin(), read_ids.end());
+    return read_ids;
+}
+
+}  // namespace
+
+TEST_CASE("Pipeline: Route by type", TEST_GROUP) {
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> read_sink(100);
+    MessageSinkToVector<dorado::Message> rejected_sink(100);
+    {
+        PassthroughNode node(read_sink);
+        node.add_output(rejected_sink,
+                        dorado::route_by_type<dorado::CandidatePairRejectedMessage>());
+        node.push_message(make_read("read_1"));
+        node.push_message(dorado::CandidatePairRejectedMessage{});
+        node.push_message(make_read("read_2"));
+    }
+
+    CHECK(get_read_ids(read_sink) == std::vector<std::string>{"read_1", "read_2"});
+    auto rejected = rejected_sink.get_messages();
+    REQUIRE(rejected.size() == 1);
+    CHECK(std::holds_alternative<dorado::CandidatePairRejectedMessage>(rejected[0]));
+}
+
+TEST_CASE("Pipeline: Route by predicate, batched", TEST_GROUP) {
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> sink_a(100);
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> sink_b(100);
+    {
+        PassthroughNode node(sink_a);
+        node.add_output(sink_b, [](const dorado::Message& message) {
+            return std::get<std::shared_ptr<dorado::Read>>(message)->read_id[0] == 'b';
+        });
+        std::vector<dorado::Message> messages;
+        for (auto read_id : {"a1", "b1", "a2", "b2", "b3"}) {
+            messages.push_back(make_read(read_id));
+        }
+        node.push_messages(std::move(messages));
+    }
+
+    CHECK(get_read_ids(sink_a) == std::vector<std::string>{"a1", "a2"});
+    CHECK(get_read_ids(sink_b) == std::vector<std::string>{"b1", "b2", "b3"});
+}
+
+TEST_CASE("Pipeline: Fan in waits for all inputs", TEST_GROUP) {
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+    {
+        PassthroughNode node_1(sink);
+        auto node_2 = std::make_unique<PassthroughNode>(sink);
+        node_2->push_message(make_read("read_1"));
+        // The sink must still accept messages from node_1 once node_2 has finished.
+        node_2.reset();
+        node_1.push_message(make_read("read_2"));
+    }
+
+    CHECK(get_read_ids(sink) == std::vector<std::string>{"read_1", "read_2"});
+}
+
+TEST_CASE("Pipeline: Shuts down in topological order", TEST_GROUP) {
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+    const int kNumReads = 50;
+    {
+        dorado::Pipeline pipeline;
+        auto& downstream = pipeline.add_node<PassthroughNode>(sink);
+        auto& source = pipeline.add_node<PassthroughNode>(sink);
+        // Cast so as not to select the (deleted) copy constructor.
+        auto& middle =
+                pipeline.add_node<PassthroughNode>(static_cast<dorado::MessageSink&>(downstream));
+        // Route half the reads from source through middle, which was added after it, so
+        // destroying nodes in reverse order of addition would lose messages.
+        source.add_output(middle, [](const dorado::Message& message) {
+            return std::get<std::shared_ptr<dorado::Read>>(message)->read_id.back() % 2 == 0;
+        });
+
+        for (int i = 0; i < kNumReads; ++i) {
+            source.push_message(make_read("read_" + std::to_string(i)));
+        }
+        pipeline.shutdown();
+    }
+
+    CHECK(get_read_ids(sink).size() == kNumReads);
+}
+
+TEST_CASE("Pipeline: Raw data needs seen from upstream", TEST_GROUP) {
+    MessageSinkToVector<dorado::Message> sink(100);
+    MessageSinkToVector<dorado::Message> other_sink(100);
+    PassthroughNode consumer(sink, true);
+    PassthroughNode before_consumer(static_cast<dorado::MessageSink&>(consumer));
+    PassthroughNode routed(other_sink);
+    routed.add_output(before_consumer, dorado::route_by_type<dorado::BamPtr>());
+
+    // A node's own needs don't count, only those downstream of it.
+    CHECK(!consumer.downstream_needs_raw_data());
+    CHECK(before_consumer.downstream_needs_raw_data());
+    CHECK(routed.downstream_needs_raw_data());
+    CHECK(!PassthroughNode(other_sink).downstream_needs_raw_data());
+}
+
+TEST_CASE("Pipeline: Processes messages in order without waiting for batches", TEST_GROUP) {
+    const int kNumReads = 20;
+    const size_t kMaxConcurrency = 2;
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+    std::atomic<int> num_processed{0};
+    std::atomic<bool> others_overtook_first{false};
+    std::atomic<bool> slots_in_range{true};
+    {
+        ProcessingNode node(sink, kMaxConcurrency, [&](size_t slot, dorado::Message&& message) {
+            if (slot >= kMaxConcurrency) {
+                slots_in_range = false;
+            }
+            auto read = std::get<std::shared_ptr<dorado::Read>>(std::move(message));
+            if (read->read_id == "read_0") {
+                // The other slot keeps taking new reads while this one is busy.
+                const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                while (num_processed < 3 && std::chrono::steady_clock::now() < deadline) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                others_overtook_first = num_processed >= 3;
+            }
+            ++num_processed;
+            // Each read is replaced by two.
+            auto copy = std::make_shared<dorado::Read>();
+            copy->read_id = read->read_id + "_copy";
+            return std::vector<dorado::Message>{std::move(read), std::move(copy)};
+        });
+        for (int i = 0; i < kNumReads; ++i) {
+            node.push_message(make_read("read_" + std::to_string(i)));
+        }
+    }
+
+    CHECK(others_overtook_first);
+    CHECK(slots_in_range);
+    std::vector<std::string> read_ids;
+    for (auto& read : sink.get_messages()) {
+        read_ids.push_back(read->read_id);
+    }
+    std::vector<std::string> expected_read_ids;
+    for (int i = 0; i < kNumReads; ++i) {
+        expected_read_ids.push_back("read_" + std::to_string(i));
+        expected_read_ids.push_back("read_" + std::to_string(i) + "_copy");
+    }
+    CHECK(read_ids == expected_read_ids);
+}
@@ -5,6 +5,8 @@
 
 #include <catch2/catch.hpp>
 
+#include <filesystem>
+
 #define TEST_GROUP "Pod5DataLoaderTest: "
 
 namespace {
@@ -18,7 +20,7 @@ public:
 size_t MockSink::get_read_count() {
     size_t read_count = 0;
     dorado::Message read;
-    while (m_work_queue.try_pop(read))
+    while (m_work_queue->try_pop(read))
         ++read_count;
     return read_count;
 }
@@ -127,11 +129,63 @@ TEST_CASE(TEST_GROUP "Load data sorted by channel id.") {
     loader.load_reads(data_path, true, dorado::DataLoader::ReadOrder::BY_CHANNEL);
 
     auto reads = sink.get_messages();
+    CHECK(reads.size() == 4);
     int start_channel_id = -1;
     for (auto &i : reads) {
         CHECK(i->attributes.channel_number >= start_channel_id);
         start_channel_id = i->attributes.channel_number;
     }
+    // Each file is opened once, however many channels it has reads for.
+    CHECK(loader.sample_stats().at("pod5_files_opened") == 1);
+}
+
+TEST_CASE(TEST_GROUP "Load data sorted by channel id across many files") {
+    namespace fs = std::filesystem;
+    const auto data_path = fs::temp_directory_path() / "dorado_by_channel_data_loader_test";
+    fs::remove_all(data_path);
+    fs::create_directories(data_path);
+    const int kNumFiles = 5;
+    for (int i = 0; i < kNumFiles; ++i) {
+        fs::copy_file(fs::path(get_data_dir("multi_read_pod5")) / "filtered.pod5",
+                      data_path / ("reads_" + std::to_string(i) + ".pod5"));
+    }
+
+    // Each file has a read on each of the same 4 channels, so reads from later files are
+    // needed before the rest of earlier ones.  With no room to buffer those, they're spilled.
+    auto load = [&](uint64_t max_buffered_bytes) {
+        MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+        dorado::DataLoader loader(sink, "cpu", 2, 0);
+        loader.set_max_buffered_bytes(max_buffered_bytes);
+        loader.load_reads(data_path.string(), false, dorado::DataLoader::ReadOrder::BY_CHANNEL);
+        auto stats = loader.sample_stats();
+        // Every file has reads to load, so each was opened exactly once.
+        CHECK(stats.at("pod5_files_opened") == kNumFiles);
+        return std::make_pair(sink.get_messages(), stats.at("pod5_reads_spilled"));
+    };
+    const auto [buffered_reads, num_buffered_reads_spilled] = load(uint64_t(1) << 30);
+    const auto [spilled_reads, num_reads_spilled] = load(0);
+    CHECK(num_buffered_reads_spilled == 0);
+    CHECK(num_reads_spilled > 0);
+
+    REQUIRE(buffered_reads.size() == 4 * kNumFiles);
+    REQUIRE(spilled_reads.size() == buffered_reads.size());
+    for (size_t i = 0; i < buffered_reads.size(); ++i) {
+        const auto& read = *spilled_reads[i];
+        const auto& expected = *buffered_reads[i];
+        if (i > 0) {
+            const auto& previous = *spilled_reads[i - 1];
+            CHECK(std::make_pair(previous.attributes.channel_number, previous.start_sample) <=
+                  std::make_pair(read.attributes.channel_number, read.start_sample));
+        }
+        CHECK(read.read_id == expected.read_id);
+        CHECK(read.attributes.fast5_filename == expected.attributes.fast5_filename);
+        CHECK(read.attributes.mux == expected.attributes.mux);
+        CHECK(read.start_time_ms == expected.start_time_ms);
+        CHECK(read.run_id == expected.run_id);
+        CHECK(read.scaling == expected.scaling);
+        CHECK(torch::equal(read.raw_data, expected.raw_data));
+    }
+    fs::remove_all(data_path);
 }
 
 TEST_CASE(TEST_GROUP "Test loading POD5 file with read ignore list") {
@@ -165,3 +219,107 @@ TEST_CASE(TEST_GROUP "Test loading POD5 file with read ignore list") {
         REQUIRE(mock_sink.get_read_count() == 0);
     }
 }
+
+TEST_CASE(TEST_GROUP "Prefetch depth doesn't change load order") {
+    std::string data_path(get_data_dir("multi_read_pod5"));
+
+    auto load_read_ids = [&data_path](size_t prefetch_depth) {
+        MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+        dorado::DataLoader loader(sink, "cpu", 2, 0);
+        loader.set_prefetch_depth(prefetch_depth, prefetch_depth);
+        loader.load_reads(data_path, false);
+
+        auto stats = loader.sample_stats();
+        CHECK(stats.at("loaded_read_count") == 4);
+        CHECK(stats.at("loaded_bytes") > 0);
+        CHECK(stats.at("reads_in_progress") == 0);
+
+        std::vector<std::string> read_ids;
+        for (auto& read : sink.get_messages()) {
+            read_ids.push_back(read->read_id);
+        }
+        return read_ids;
+    };
+
+    auto read_ids = load_read_ids(1);
+    CHECK(read_ids.size() == 4);
+    CHECK(load_read_ids(4) == read_ids);
+}
+
+TEST_CASE(TEST_GROUP "Mixed POD5 and FAST5 files are loaded in directory order") {
+    namespace fs = std::filesystem;
+    const auto data_path = fs::temp_directory_path() / "dorado_mixed_data_loader_test";
+    fs::remove_all(data_path);
+    fs::create_directories(data_path);
+    for (int i = 0; i < 4; ++i) {
+        fs::copy_file(fs::path(get_fast5_data_dir()) / "single_read.fast5",
+                      data_path / ("reads_" + std::to_string(i) + ".fast5"));
+        fs::copy_file(fs::path(get_pod5_data_dir()) / "single_na24385.pod5",
+                      data_path / ("reads_" + std::to_string(i) + ".pod5"));
+    }
+
+    // Each file holds one read, so reads should come out in the order the files are listed.
+    std::vector<std::string> expected_filenames;
+    for (const auto& entry : fs::directory_iterator(data_path)) {
+        expected_filenames.push_back(entry.path().filename().string());
+    }
+
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+    dorado::DataLoader loader(sink, "cpu", 2, 0);
+    loader.load_reads(data_path.string(), false);
+
+    std::vector<std::string> filenames;
+    for (auto& read : sink.get_messages()) {
+        filenames.push_back(read->attributes.fast5_filename);
+    }
+    CHECK(filenames == expected_filenames);
+    fs::remove_all(data_path);
+}
+
+TEST_CASE(TEST_GROUP "Read lists are resolved before files are read") {
+    std::string data_path(get_data_dir("multi_read_pod5"));
+
+    SECTION("listed read is loaded from its batch") {
+        auto read_list = std::unordered_set<std::string>();
+        read_list.insert("0007f755-bc82-432c-82be-76220b107ec5");  // read present in POD5
+
+        MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+        dorado::DataLoader loader(sink, "cpu", 1, 0, read_list);
+        loader.load_reads(data_path, false);
+
+        auto reads = sink.get_messages();
+        REQUIRE(reads.size() == 1);
+        CHECK(reads[0]->read_id == "0007f755-bc82-432c-82be-76220b107ec5");
+        CHECK(loader.sample_stats().at("pod5_batches_fetched") == 1);
+    }
+
+    SECTION("file without listed reads isn't opened") {
+        auto read_list = std::unordered_set<std::string>();
+        read_list.insert("00000000-0000-0000-0000-000000000000");  // read absent from POD5
+
+        for (auto traversal_order :
+             {dorado::DataLoader::UNRESTRICTED, dorado::DataLoader::BY_CHANNEL}) {
+            MockSink mock_sink;
+            dorado::DataLoader loader(mock_sink, "cpu", 1, 0, read_list);
+            loader.load_reads(data_path, false, traversal_order);
+
+            CHECK(mock_sink.get_read_count() == 0);
+            auto stats = loader.sample_stats();
+            CHECK(stats.at("pod5_files_opened") == 0);
+            CHECK(stats.at("pod5_files_skipped") == 1);
+        }
+    }
+}
+
+TEST_CASE(TEST_GROUP "Parse read ids") {
+    auto read_id = dorado::parse_read_id("0007f755-BC82-432c-82be-76220b107ec5");
+    REQUIRE(read_id);
+    CHECK((*read_id)[0] == 0x00);
+    CHECK((*read_id)[3] == 0x55);
+    CHECK((*read_id)[4] == 0xbc);
+    CHECK((*read_id)[15] == 0xc5);
+
+    CHECK_FALSE(dorado::parse_read_id("read_1"));
+    CHECK_FALSE(dorado::parse_read_id("0007f755bc82432c82be76220b107ec5"));
+    CHECK_FALSE(dorado::parse_read_id("0007f755-bc82-432c-82be-76220b107ecg"));
+}
@@ -0,0 +1,84 @@
+#include "utils/math_utils.h"
+#include "utils/quantile_utils.h"
+#include "utils/tensor_utils.h"
+
+#include <catch2/catch.hpp>
+#include <torch/torch.h>
+
+#include <vector>
+
+#define CUT_TAG "[QuantileUtils]"
+
+using dorado::utils::QuantileInterpolation;
+
+namespace {
+
+// Deliberately unsorted, and including the extremes.
+const std::vector<float> kQuantiles = {0.9f, 0.2f, 0.5f, 0.05f, 1.0f, 0.0f};
+
+std::vector<float> expected_lower(const torch::Tensor& samples) {
+    const auto q = torch::tensor(kQuantiles);
+    const auto expected = torch::quantile(samples.to(torch::kFloat), q, 0, false,
+                                          c10::string_view("lower"));
+    return {expected.data_ptr<float>(), expected.data_ptr<float>() + expected.numel()};
+}
+
+}  // namespace
+
+TEST_CASE(CUT_TAG ": int16 quantiles", CUT_TAG) {
+    torch::manual_seed(42);
+
+    // Narrow ranges are counted into a histogram, wide ones selected.
+    for (int range : {100, 4000, 30000}) {
+        for (int num_samples : {1, 15, 1000, 20000}) {
+            CAPTURE(range, num_samples);
+            const auto samples =
+                    torch::randint(-range / 2, range / 2, {num_samples}, torch::kInt16);
+            std::vector<float> computed(kQuantiles.size());
+            dorado::utils::quantiles(samples.data_ptr<int16_t>(), num_samples, kQuantiles.data(),
+                                     kQuantiles.size(), computed.data());
+            CHECK(computed == expected_lower(samples));
+        }
+    }
+}
+
+TEST_CASE(CUT_TAG ": float16 and float quantiles", CUT_TAG) {
+    torch::manual_seed(42);
+
+    for (int num_samples : {1, 15, 1000, 100000}) {
+        CAPTURE(num_samples);
+        const auto samples_f16 = torch::randn({num_samples}).to(torch::kFloat16);
+        const auto samples_f32 = samples_f16.to(torch::kFloat);
+        const auto expected = expected_lower(samples_f32);
+
+        std::vector<float> computed(kQuantiles.size());
+        dorado::utils::quantiles(samples_f16.data_ptr<c10::Half>(), num_samples,
+                                 kQuantiles.data(), kQuantiles.size(), computed.data());
+        CHECK(computed == expected);
+        dorado::utils::quantiles(samples_f32.data_ptr<float>(), num_samples, kQuantiles.data(),
+                                 kQuantiles.size(), computed.data());
+        CHECK(computed == expected);
+
+        // Linear interpolation matches the quantiles RemoraScaler previously used.
+        if (num_samples > 1) {
+            const std::vector<float> samples(samples_f32.data_ptr<float>(),
+                                             samples_f32.data_ptr<float>() + num_samples);
+            const auto expected_linear = dorado::utils::quantiles(samples, kQuantiles);
+            dorado::utils::quantiles(samples_f16.data_ptr<c10::Half>(), num_samples,
+                                     kQuantiles.data(), kQuantiles.size(), computed.data(),
+                                     QuantileInterpolation::LINEAR);
+            CHECK(computed == expected_linear);
+            dorado::utils::quantiles(samples.data(), num_samples, kQuantiles.data(),
+                                     kQuantiles.size(), computed.data(),
+                                     QuantileInterpolation::LINEAR);
+            CHECK(computed == expected_linear);
+        }
+    }
+}
+
+TEST_CASE(CUT_TAG ": no samples", CUT_TAG) {
+    std::vector<float> computed(kQuantiles.size(), 1.0f);
+    dorado::utils::quantiles(static_cast<const float*>(nullptr), 0, kQuantiles.data(),
+                             kQuantiles.size(), computed.data());
+    CHECK(computed == std::vector<float>(kQuantiles.size(), 0.0f));
+}
@@ -0,0 +1,70 @@
+#include "read_pipeline/ReadRouterNode.h"
+
+#include "MessageSinkUtils.h"
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+#include <string>
+
+#define TEST_GROUP "[read_pipeline][ReadRouterNode]"
+
+namespace {
+
+std::shared_ptr<dorado::Read> make_read(const std::string& read_id, char qscore_char) {
+    auto read = std::make_shared<dorado::Read>();
+    read->raw_data = torch::empty(100);
+    read->read_id = read_id;
+    read->seq = "ACGTACGT";
+    read->qstring = std::string(read->seq.size(), qscore_char);
+    return read;
+}
+
+}  // namespace
+
+TEST_CASE("ReadRouterNode: Route reads by qscore band", TEST_GROUP) {
+    MessageSinkToVector<dorado::Message> sink(100);
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> routed_sink(100);
+    {
+        dorado::ReadRouterNode router(sink, routed_sink,
+                                      dorado::ReadRouterNode::qscore_band(10, 15), 2);
+        router.push_message(make_read("read_q9", '*'));
+        router.push_message(make_read("read_q14", '/'));
+        router.push_message(make_read("read_q20", '5'));
+        // Messages other than reads take the default output.
+        router.push_message(dorado::CandidatePairRejectedMessage{});
+    }
+
+    auto routed = routed_sink.get_messages();
+    REQUIRE(routed.size() == 1);
+    CHECK(routed[0]->read_id == "read_q14");
+
+    auto passed = sink.get_messages();
+    REQUIRE(passed.size() == 3);
+    size_t num_reads = 0;
+    for (auto& message : passed) {
+        if (auto* read = std::get_if<std::shared_ptr<dorado::Read>>(&message)) {
+            CHECK((*read)->read_id != "read_q14");
+            ++num_reads;
+        }
+    }
+    CHECK(num_reads == 2);
+}
+
+TEST_CASE("ReadRouterNode: Custom predicates", TEST_GROUP) {
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> routed_sink(100);
+    {
+        dorado::ReadRouterNode router(sink, routed_sink, [](const dorado::Read& read) {
+            return read.read_id.back() == '1';
+        });
+        for (int i = 0; i < 4; ++i) {
+            router.push_message(make_read("read_" + std::to_string(i), '/'));
+        }
+    }
+
+    auto routed = routed_sink.get_messages();
+    REQUIRE(routed.size() == 1);
+    CHECK(routed[0]->read_id == "read_1");
+    CHECK(sink.get_messages().size() == 3);
+}
@@ -0,0 +1,64 @@
+#include "MessageSinkUtils.h"
+#include "read_pipeline/ReorderNode.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#define TEST_GROUP "[read_pipeline][ReorderNode]"
+
+namespace {
+
+std::shared_ptr<dorado::Read> make_read(uint64_t sequence_number) {
+    auto read = std::make_shared<dorado::Read>();
+    read->sequence_number = sequence_number;
+    return read;
+}
+
+std::vector<uint64_t> get_sequence_numbers(
+        MessageSinkToVector<std::shared_ptr<dorado::Read>>& sink) {
+    std::vector<uint64_t> sequence_numbers;
+    for (auto& read : sink.get_messages()) {
+        sequence_numbers.push_back(read->sequence_number);
+    }
+    return sequence_numbers;
+}
+
+}  // namespace
+
+TEST_CASE("ReorderNode: Restores load order", TEST_GROUP) {
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+    {
+        dorado::ReorderNode reorder_node(sink, 10);
+        for (uint64_t sequence_number : {3, 1, 0, 4, 2, 6, 5}) {
+            reorder_node.push_message(make_read(sequence_number));
+        }
+    }
+    CHECK(get_sequence_numbers(sink) == std::vector<uint64_t>{0, 1, 2, 3, 4, 5, 6});
+}
+
+TEST_CASE("ReorderNode: Full window skips missing reads", TEST_GROUP) {
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+    {
+        dorado::ReorderNode reorder_node(sink, 2);
+        // 0 is held up, so once 3 reads are waiting the earliest is sent on without it.
+        for (uint64_t sequence_number : {1, 2, 3, 0, 4}) {
+            reorder_node.push_message(make_read(sequence_number));
+        }
+    }
+    CHECK(get_sequence_numbers(sink) == std::vector<uint64_t>{1, 2, 3, 0, 4});
+}
+
+TEST_CASE("ReorderNode: Flushes held reads at end of input", TEST_GROUP) {
+    MessageSinkToVector<std::shared_ptr<dorado::Read>> sink(100);
+    {
+        dorado::ReorderNode reorder_node(sink, 10);
+        // 0 never arrives.
+        for (uint64_t sequence_number : {2, 1}) {
+            reorder_node.push_message(make_read(sequence_number));
+        }
+    }
+    CHECK(get_sequence_numbers(sink) == std::vector<uint64_t>{1, 2});
+}
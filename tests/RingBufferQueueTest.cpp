@@ -0,0 +1,209 @@
+#include "utils/AsyncQueue.h"
+#include "utils/RingBufferQueue.h"
+
+#include <catch2/catch.hpp>
+
+#define TEST_GROUP "RingBufferQueue "
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+TEST_CASE(TEST_GROUP ": InputsMatchOutputs") {
+    const int n = 10;
+    RingBufferQueue<int> queue(n);
+
+    for (int i = 0; i < n; ++i) {
+        const bool success = queue.try_push(std::move(i));
+        REQUIRE(success);
+    }
+    for (int i = 0; i < n; ++i) {
+        int val = -1;
+        const bool success = queue.try_pop(val);
+        REQUIRE(success);
+        REQUIRE(val == i);
+    }
+}
+
+TEST_CASE(TEST_GROUP ": WrapsAround") {
+    // Non power of 2 capacity, pushed and popped over several laps.
+    RingBufferQueue<int> queue(3);
+    for (int i = 0; i < 20; ++i) {
+        REQUIRE(queue.try_push(std::move(i)));
+        int val = -1;
+        REQUIRE(queue.try_pop(val));
+        REQUIRE(val == i);
+    }
+    const auto stats = queue.sample_stats();
+    REQUIRE(stats.at("items") == 0);
+    REQUIRE(stats.at("pushes") == 20);
+    REQUIRE(stats.at("pops") == 20);
+}
+
+TEST_CASE(TEST_GROUP ": PushFailsIfTerminating") {
+    RingBufferQueue<int> queue(1);
+    queue.terminate();
+    const bool success = queue.try_push(42);
+    REQUIRE(!success);
+}
+
+TEST_CASE(TEST_GROUP ": PopFailsIfTerminating") {
+    RingBufferQueue<int> queue(1);
+    queue.terminate();
+    int val;
+    const bool success = queue.try_pop(val);
+    REQUIRE(!success);
+}
+
+// Termination only takes effect for pops once the queue has drained.
+TEST_CASE(TEST_GROUP ": PopDrainsAfterTerminate") {
+    RingBufferQueue<int> queue(2);
+    REQUIRE(queue.try_push(1));
+    queue.terminate();
+    int val = -1;
+    REQUIRE(queue.try_pop(val));
+    REQUIRE(val == 1);
+    REQUIRE(!queue.try_pop(val));
+}
+
+// Spawned thread parks waiting for an item.
+// Main thread terminates wait.
+TEST_CASE(TEST_GROUP ": TerminateFromOtherThread") {
+    RingBufferQueue<int> queue(1);
+    std::atomic_bool thread_started{false};
+    bool try_pop_result = true;
+
+    auto popping_thread = std::thread([&]() {
+        thread_started.store(true, std::memory_order_relaxed);
+        int val = -1;
+        // catch2 isn't thread safe so we have to check this on the main thread
+        try_pop_result = queue.try_pop(val);
+    });
+
+    // Wait for thread to start, and give it time to park.
+    while (!thread_started.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    queue.terminate();
+    popping_thread.join();
+
+    REQUIRE(!try_pop_result);
+}
+
+// Spawned thread parks waiting for space, which is made by the main thread.
+TEST_CASE(TEST_GROUP ": PushBlocksWhenFull") {
+    RingBufferQueue<int> queue(1);
+    REQUIRE(queue.try_push(1));
+
+    std::atomic_bool pushed{false};
+    auto pushing_thread = std::thread([&]() {
+        queue.try_push(2);
+        pushed.store(true);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE(!pushed.load());
+
+    int val = -1;
+    REQUIRE(queue.try_pop(val));
+    REQUIRE(val == 1);
+    pushing_thread.join();
+    REQUIRE(pushed.load());
+    REQUIRE(queue.try_pop(val));
+    REQUIRE(val == 2);
+}
+
+TEST_CASE(TEST_GROUP ": BatchPopUntilDeadline") {
+    RingBufferQueue<int> queue(10);
+    REQUIRE(queue.try_push_batch({1, 2}));
+
+    std::vector<int> items;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+    REQUIRE(queue.try_pop_batch_until(items, 5, deadline));
+    REQUIRE(std::chrono::steady_clock::now() >= deadline);
+    REQUIRE(items == std::vector<int>{1, 2});
+
+    queue.terminate();
+    REQUIRE(!queue.try_pop_batch_until(items, 5, std::chrono::steady_clock::now()));
+}
+
+// Many producers and consumers hammer a small queue through both the single item
+// and batched paths.  Every item pushed must be popped exactly once.
+TEMPLATE_TEST_CASE(TEST_GROUP ": MultiProducerMultiConsumerStress",
+                   "",
+                   AsyncQueue<int64_t>,
+                   RingBufferQueue<int64_t>) {
+    auto [num_producers, num_consumers] =
+            GENERATE(table<int, int>({{1, 1}, {1, 4}, {4, 1}, {4, 4}, {8, 8}}));
+    CAPTURE(num_producers, num_consumers);
+    const int64_t items_per_producer = 20000;
+    TestType queue(16);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&queue, p, items_per_producer] {
+            const int64_t first = p * items_per_producer;
+            for (int64_t i = 0; i < items_per_producer;) {
+                if (i % 3 == 0) {
+                    std::vector<int64_t> batch;
+                    for (int b = 0; b < 5 && i < items_per_producer; ++b, ++i) {
+                        batch.push_back(first + i);
+                    }
+                    queue.try_push_batch(std::move(batch));
+                } else {
+                    int64_t item = first + i++;
+                    queue.try_push(std::move(item));
+                }
+            }
+        });
+    }
+
+    std::vector<std::vector<int64_t>> popped(num_consumers);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < num_consumers; ++c) {
+        consumers.emplace_back([&queue, &popped, c] {
+            auto& consumed = popped[c];
+            int64_t item;
+            while (true) {
+                if (consumed.size() % 2 == 0) {
+                    if (!queue.try_pop(item)) {
+                        break;
+                    }
+                    consumed.push_back(item);
+                } else if (!queue.try_pop_batch(consumed, 7)) {
+                    break;
+                }
+            }
+        });
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    queue.terminate();
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+
+    const int64_t num_items = num_producers * items_per_producer;
+    std::vector<int> seen(num_items, 0);
+    for (const auto& consumed : popped) {
+        for (auto item : consumed) {
+            REQUIRE(item >= 0);
+            REQUIRE(item < num_items);
+            ++seen[item];
+        }
+    }
+    REQUIRE(std::all_of(seen.begin(), seen.end(), [](int count) { return count == 1; }));
+
+    const auto stats = queue.sample_stats();
+    REQUIRE(stats.at("pushes") == num_items);
+    REQUIRE(stats.at("pops") == num_items);
+    REQUIRE(stats.at("items") == 0);
+}
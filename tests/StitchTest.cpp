@@ -43,25 +43,22 @@ TEST_CASE("Test stitch_chunks", TEST_GROUP) {
     constexpr size_t OVERLAP = 3;
 
     auto read = std::make_shared<dorado::Read>();
-    read->num_chunks = 0;
+    read->chunk_arena = std::make_unique<dorado::ChunkArena>();
+    auto& chunks = read->chunk_arena->chunks;
 
     size_t offset = 0;
     size_t chunk_in_read_idx = 0;
     size_t signal_chunk_step = CHUNK_SIZE - OVERLAP;
-    auto chunk = std::make_shared<dorado::Chunk>(read, offset, chunk_in_read_idx++, CHUNK_SIZE);
-    chunk->qstring = QSTR[read->num_chunks];
-    chunk->seq = SEQS[read->num_chunks];
-    chunk->moves = MOVES[read->num_chunks];
-    read->called_chunks.push_back(chunk);
-    read->num_chunks++;
+    chunks.emplace_back(read.get(), offset, chunk_in_read_idx++, CHUNK_SIZE);
     while (offset + CHUNK_SIZE < RAW_SIGNAL_SIZE) {
         offset = std::min(offset + signal_chunk_step, RAW_SIGNAL_SIZE - CHUNK_SIZE);
-        chunk = std::make_shared<dorado::Chunk>(read, offset, chunk_in_read_idx++, CHUNK_SIZE);
-        chunk->qstring = QSTR[read->num_chunks];
-        chunk->seq = SEQS[read->num_chunks];
-        chunk->moves = MOVES[read->num_chunks];
-        read->called_chunks.push_back(chunk);
-        read->num_chunks++;
+        chunks.emplace_back(read.get(), offset, chunk_in_read_idx++, CHUNK_SIZE);
+    }
+    read->num_chunks = chunks.size();
+
+    read->chunk_arena->init_calls(CHUNK_SIZE);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        read->chunk_arena->set_calls(i, SEQS[i], QSTR[i], MOVES[i]);
     }
 
     REQUIRE_NOTHROW(dorado::utils::stitch_chunks(read));
@@ -76,3 +73,15 @@ TEST_CASE("Test stitch_chunks", TEST_GROUP) {
     REQUIRE(read->qstring == expected_qstring);
     REQUIRE(read->moves == expected_moves);
 }
+
+TEST_CASE("Test ChunkArena rejects oversized calls", TEST_GROUP) {
+    dorado::ChunkArena arena;
+    arena.chunks.emplace_back(nullptr, 0, 0, 10);
+    arena.init_calls(4);
+    REQUIRE_NOTHROW(arena.set_calls(0, "ACGT", "!&.-", {1, 1, 1, 1}));
+    CHECK(arena.seq(0) == "ACGT");
+    CHECK(arena.qstring(0) == "!&.-");
+    CHECK(arena.num_moves(0) == 4);
+    CHECK(arena.calls_size() == 12);
+    CHECK_THROWS(arena.set_calls(0, "ACGTA", "!&.-!", {1, 1, 1, 1, 1}));
+}
@@ -136,3 +136,72 @@ TEST_CASE(CUT_TAG ": copy_tensor_elems", CUT_TAG) {
         }
     }
 }
+
+TEST_CASE(CUT_TAG ": normalise_i16_to_f16", CUT_TAG) {
+    torch::manual_seed(42);
+    srand(42);
+
+    for (int i = 0; i < 10; ++i) {
+        const int num_elems = rand() % 1000;
+        const float shift = 100.0f + rand() % 500;
+        const float scale = 1.0f + rand() % 200;
+        const auto elems_i16 = torch::randint(-1000, 4000, {num_elems}, torch::kInt16);
+        // The path ScalerNode previously took.
+        const auto elems_torch_f16 =
+                ((elems_i16.to(torch::kFloat) - shift) / scale).to(torch::kHalf);
+        auto elems_normalised_f16 = torch::zeros({num_elems}, torch::kHalf);
+        dorado::utils::normalise_i16_to_f16(elems_normalised_f16.data_ptr<c10::Half>(),
+                                            elems_i16.data_ptr<int16_t>(), num_elems, shift,
+                                            scale);
+        const float kRelTolerance = 0.0f;
+        const float kAbsTolerance = 0.0f;
+        CHECK(torch::allclose(elems_torch_f16, elems_normalised_f16, kRelTolerance,
+                              kAbsTolerance));
+    }
+}
+
+TEST_CASE(CUT_TAG ": copy_signal_rows", CUT_TAG) {
+    using torch::indexing::Ellipsis;
+    using torch::indexing::Slice;
+    torch::manual_seed(42);
+    srand(42);
+
+    const int kChunkSize = 100;
+    const int kBatchSize = 4;
+    for (auto dest_dtype : {torch::kFloat16, torch::kFloat32}) {
+        for (int num_rows : {1, 13}) {
+            for (int i = 0; i < 10; ++i) {
+                const int raw_len = 1 + rand() % 300;
+                const auto raw_data = torch::rand({num_rows, raw_len}).to(torch::kFloat16);
+                const int offset = rand() % raw_len;
+                const int chunk_idx = rand() % kBatchSize;
+                const auto slice = raw_data.index({Ellipsis, Slice(offset, offset + kChunkSize)});
+                const int len = slice.size(1);
+                CAPTURE(dest_dtype, num_rows, raw_len, offset);
+
+                // Repeat padding, as BasecallerNode previously did with torch ops.
+                auto [n, overhang] = std::div(kChunkSize, len);
+                auto expected = torch::zeros({kBatchSize, num_rows, kChunkSize}, dest_dtype);
+                expected.index_put_({chunk_idx, Ellipsis},
+                                    torch::concat({slice.repeat({1, n}),
+                                                   slice.index({Ellipsis, Slice(0, overhang)})},
+                                                  1));
+                auto staged = torch::zeros({kBatchSize, num_rows, kChunkSize}, dest_dtype);
+                dorado::utils::copy_signal_rows(staged, chunk_idx * staged.stride(0), kChunkSize,
+                                                raw_data.data_ptr<c10::Half>() + offset, num_rows,
+                                                raw_len, len, true);
+                CHECK(torch::equal(expected, staged));
+
+                // Zero padding overwrites whatever was in the chunk before.
+                expected = torch::ones({kBatchSize, num_rows, kChunkSize}, dest_dtype);
+                expected.index_put_({chunk_idx}, 0);
+                expected.index_put_({chunk_idx, Ellipsis, Slice(0, len)}, slice);
+                staged = torch::ones({kBatchSize, num_rows, kChunkSize}, dest_dtype);
+                dorado::utils::copy_signal_rows(staged, chunk_idx * staged.stride(0), kChunkSize,
+                                                raw_data.data_ptr<c10::Half>() + offset, num_rows,
+                                                raw_len, len, false);
+                CHECK(torch::equal(expected, staged));
+            }
+        }
+    }
+}
@@ -69,3 +69,28 @@ TEST_CASE("Test trim signal", TEST_GROUP) {
         CHECK(pos == expected_pos);
     }
 }
+
+TEST_CASE("Test trim half precision signal", TEST_GROUP) {
+    constexpr int signal_len = 2000;
+
+    std::mt19937 gen{42};
+    std::normal_distribution<float> rng{0, 1};
+
+    for (int peak_end : {0, 55, 300}) {
+        CAPTURE(peak_end);
+        std::vector<float> signal(signal_len);
+        std::generate(signal.begin(), signal.end(), [&]() { return rng(gen); });
+        for (int i = 1; i < peak_end; ++i) {
+            signal[i] += 5;
+        }
+        auto signal_f16 = torch::from_blob(signal.data(), {signal_len}).to(torch::kFloat16);
+
+        for (int max_samples : {5, 400, signal_len}) {
+            CAPTURE(max_samples);
+            const auto prefix = signal_f16.index({Slice(torch::indexing::None, max_samples)});
+            const int expected_pos = dorado::utils::trim(prefix);
+            CHECK(dorado::utils::trim(signal_f16.data_ptr<c10::Half>(), max_samples) ==
+                  expected_pos);
+        }
+    }
+}
@@ -0,0 +1,110 @@
+#include "utils/WorkStealingExecutor.h"
+
+#include <catch2/catch.hpp>
+
+#define TEST_GROUP "WorkStealingExecutor "
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using dorado::utils::WorkStealingExecutor;
+
+TEST_CASE(TEST_GROUP ": SubmittedTasksRun") {
+    const int kNumTasks = 1000;
+    std::atomic<int> num_run{0};
+    {
+        WorkStealingExecutor executor(4);
+        for (int i = 0; i < kNumTasks; ++i) {
+            executor.submit([&num_run] { ++num_run; });
+        }
+        // Destruction runs anything still queued.
+    }
+    CHECK(num_run == kNumTasks);
+}
+
+TEST_CASE(TEST_GROUP ": ParallelForCoversAllItems") {
+    const size_t kNumItems = 10000;
+    const size_t kMaxConcurrency = 8;
+    WorkStealingExecutor executor(4);
+
+    std::vector<std::atomic<int>> item_counts(kNumItems);
+    std::vector<std::atomic<int>> slot_users(kMaxConcurrency);
+    // Catch assertions aren't thread safe, so failures are recorded and checked after.
+    std::atomic<bool> slot_out_of_range{false};
+    std::atomic<bool> slot_shared{false};
+    executor.parallel_for(kNumItems, kMaxConcurrency, [&](size_t slot, size_t item) {
+        if (slot >= kMaxConcurrency) {
+            slot_out_of_range = true;
+            return;
+        }
+        if (slot_users[slot]++ != 0) {
+            slot_shared = true;
+        }
+        ++item_counts[item];
+        --slot_users[slot];
+    });
+
+    CHECK(!slot_out_of_range);
+    CHECK(!slot_shared);
+    for (auto& count : item_counts) {
+        CHECK(count == 1);
+    }
+}
+
+TEST_CASE(TEST_GROUP ": ParallelForRespectsMaxConcurrency") {
+    const size_t kMaxConcurrency = 3;
+    WorkStealingExecutor executor(8);
+
+    std::atomic<size_t> num_running{0};
+    std::atomic<size_t> max_running{0};
+    executor.parallel_for(100, kMaxConcurrency, [&](size_t, size_t) {
+        const size_t running = ++num_running;
+        size_t max = max_running.load();
+        while (running > max && !max_running.compare_exchange_weak(max, running)) {
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        --num_running;
+    });
+
+    CHECK(max_running <= kMaxConcurrency);
+}
+
+TEST_CASE(TEST_GROUP ": ParallelForRethrows") {
+    WorkStealingExecutor executor(4);
+
+    std::atomic<size_t> num_run{0};
+    CHECK_THROWS_AS(executor.parallel_for(100, 4,
+                                          [&](size_t, size_t item) {
+                                              ++num_run;
+                                              if (item == 50) {
+                                                  throw std::runtime_error("item failed");
+                                              }
+                                          }),
+                    std::runtime_error);
+    // Other items still run.
+    CHECK(num_run == 100);
+}
+
+TEST_CASE(TEST_GROUP ": NestedParallelFor") {
+    // Every worker blocks in an outer parallel_for, so the inner ones only complete
+    // because callers take part.
+    WorkStealingExecutor executor(2);
+
+    std::vector<std::promise<int>> results(4);
+    for (auto& result : results) {
+        executor.submit([&executor, &result] {
+            std::atomic<int> sum{0};
+            executor.parallel_for(4, 4, [&](size_t, size_t) {
+                executor.parallel_for(10, 4, [&](size_t, size_t item) { sum += int(item); });
+            });
+            result.set_value(sum);
+        });
+    }
+    for (auto& result : results) {
+        CHECK(result.get_future().get() == 4 * 45);
+    }
+}